@@ -10,36 +10,221 @@
 #include <Adafruit_MAX31865.h>
 #include "thingProperties.h"
 #include "Brewhob.h"
+#include <FlashStore.h>
+#include <SAMD21Flash.h>
 
 Brewhob* brewhob;
 unsigned long last2s_ms;
 unsigned long last1s_ms;
 unsigned long last10s_ms;
-
+unsigned long lastFill_ms;
+unsigned long lastCloud_ms;
+unsigned long lastLog_ms;
+
+//Values set from the cloud dashboard, applied by the control step
+struct Settings{
+  int  shotSize;
+  int  brewSP;
+  int  steamSP;
+  int  prewet;
+  int  dwell;
+  int  delayPumpStart;
+  bool power;
+  bool brewBoilerOn;
+  bool steamBoilerOn;
+  ShotProfile profile; //no segments: prewet, dwell and delayPumpStart
+  int  autotune;      //boiler to autotune, 0 for none
+  bool tuned;         //gains hold a saved tuning, else config.h Kp/Ki/Kd
+  PIDGains gains[2];  //brew, steam
+};
+const Settings defaultSettings = {SHOT_SIZE, SETPOINT1, SETPOINT2, 0, 0, 0, true, true, true,
+                                  {}, 0, false, {}}; //no profile, autotune or saved tuning
+Settings settings = defaultSettings;
+ShotProfile cloudProfile; //last valid _Profile
+PIDGains cloudTuning[2];  //last valid _Tuning
+bool cloudTuned = false;
+
+//Dashboard values kept in flash, so a reboot without network comes back
+//with the last settings instead of the config.h defaults
+struct SavedSettings{
+  int  shotSize;
+  int  brewSP;
+  int  steamSP;
+  int  prewet;
+  int  dwell;
+  int  delayPumpStart;
+  bool brewBoilerOn;
+  bool steamBoilerOn;
+  bool tuned;
+  PIDGains gains[2];
+  void Reset(){ //defaults after an upload, FlashStore calls it
+    shotSize = SHOT_SIZE;
+    brewSP = SETPOINT1;
+    steamSP = SETPOINT2;
+    prewet = dwell = delayPumpStart = 0;
+    brewBoilerOn = steamBoilerOn = true;
+    tuned = false;
+    memset(gains, 0, sizeof(gains));
+  }
+};
+SAMD21_FLASH_AREA(settingsArea, SETTINGS_FLASH_ROWS);
+SAMD21Flash settingsFlash(settingsArea, sizeof(settingsArea));
+FlashStore<SavedSettings> savedSettings(settingsFlash);
+
+void restoreSettings();
+void saveSettings(const Settings& s);
+void sensorStep();
+void controlStep();
+void cloudStep();
+void logStep();
 
 /************* INTERRUPTS ***********/
 
+//ISRs only touch volatile counters; the resulting state change is applied
+//by brewhob->serviceState() in loop()
 void SW1_ISR(){ //brew switch ISR
-  brewhob->readSwitch(1);
-  brewhob->setState();
+  brewhob->switchISR(1);
 }
 void SW2_ISR(){
-    brewhob->readSwitch(2);
-    brewhob->setState();
+  brewhob->switchISR(2);
 }
 
 void FLOW_ISR(){
-  //Only measure flow after full infusion has started
-  if(brewhob->getState() == "BREW" &&
-    millis() - brewhob->shotTimerStart_ >= ( brewhob->prewet_ + brewhob->dwell_ + brewhob->delayPumpStart_ ) * 1000 ){
-    brewhob->incrementFM();
-    brewhob->setState();
-  }
+  brewhob->flowPulseISR();
 }
 
 /************* END INTERRUPTS ***********/
 
 
+/************* TASKS ***********/
+// With RTOS_ENABLED each step below runs in its own fixed priority task:
+//   control (highest): state machine, heaters, pump and solenoid phases
+//   sensor:            RTDs and fill probe
+//   cloud:             ArduinoCloud sync, sends Settings to control
+//   log (lowest):      owns Serial, drains everything the others print
+// Without it, loop() runs the steps in turn, as before.
+
+#if RTOS_ENABLED
+
+#define CONTROL_PERIOD_MS 10
+#define SENSOR_PERIOD_MS  5
+#define CLOUD_PERIOD_MS   100
+#define LOG_STREAM_BYTES  512
+
+QueueHandle_t         settingsQueue; //cloud -> control, holds the latest Settings
+SemaphoreHandle_t     dataMutex;     //guards log_ and lastShotSpecs_
+StreamBufferHandle_t  logStream;     //anything -> log task -> Serial
+
+volatile unsigned long controlJitterMax_us = 0; //worst wake-up error of the control task
+volatile unsigned long controlStepMax_us   = 0; //worst execution time of one control step
+
+//in the order they are created; logStep() reports their unused stack
+TaskHandle_t tasks[4];
+const char* const taskNames[4] = {"control", "sensor", "cloud", "log"};
+
+//Print that feeds the log task instead of writing to Serial directly.
+//Never blocks: output is dropped if the log task falls behind. A Stream
+//only so ArduinoIoTCloud's debug output can be sent through it too.
+class LogStreamPrint : public Stream{
+  public:
+    int available(){ return 0; }
+    int read(){ return -1; }
+    int peek(){ return -1; }
+    size_t write(uint8_t c){ return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size){
+      vTaskSuspendAll(); //the stream buffer allows one writer at a time
+      size_t sent = xStreamBufferSend(logStream, buffer, size, 0);
+      xTaskResumeAll();
+      return sent;
+    }
+};
+LogStreamPrint logPrint;
+
+void lockData(){ xSemaphoreTake(dataMutex, portMAX_DELAY); }
+void unlockData(){ xSemaphoreGive(dataMutex); }
+void postSettings(const Settings& s){ xQueueOverwrite(settingsQueue, &s); }
+void receiveSettings(){ xQueueReceive(settingsQueue, &settings, 0); }
+
+static void controlTask(void *pvParameters){
+  TickType_t wake = xTaskGetTickCount();
+  unsigned long expected = micros();
+  while(1){
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(CONTROL_PERIOD_MS));
+    expected += CONTROL_PERIOD_MS * 1000UL;
+
+    unsigned long start = micros();
+    long error = start - expected;
+    if(error < 0) error = -error;
+    if((unsigned long)error > controlJitterMax_us) controlJitterMax_us = error;
+
+    controlStep();
+
+    unsigned long took = micros() - start;
+    if(took > controlStepMax_us) controlStepMax_us = took;
+  }
+}
+
+static void sensorTask(void *pvParameters){
+  TickType_t wake = xTaskGetTickCount();
+  while(1){
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(SENSOR_PERIOD_MS));
+    sensorStep();
+  }
+}
+
+static void cloudTask(void *pvParameters){
+  while(1){
+    cloudStep();
+    vTaskDelay(pdMS_TO_TICKS(CLOUD_PERIOD_MS));
+  }
+}
+
+static void logTask(void *pvParameters){
+  uint8_t buffer[64];
+  while(1){
+    size_t n = xStreamBufferReceive(logStream, buffer, sizeof(buffer), pdMS_TO_TICKS(100));
+    if(n) Serial.write(buffer, n);
+    logStep();
+  }
+}
+
+//stacks are in words; together they take about 6 KB of the 14 KB heap
+void startTasks(){
+  settingsQueue = xQueueCreate(1, sizeof(Settings));
+  dataMutex     = xSemaphoreCreateMutex();
+  logStream     = xStreamBufferCreate(LOG_STREAM_BYTES, 1);
+
+  bool started = settingsQueue && dataMutex && logStream
+    && xTaskCreate(controlTask, taskNames[0], 256,  NULL, tskIDLE_PRIORITY + 4, &tasks[0]) == pdPASS
+    && xTaskCreate(sensorTask,  taskNames[1], 192,  NULL, tskIDLE_PRIORITY + 3, &tasks[1]) == pdPASS
+    && xTaskCreate(cloudTask,   taskNames[2], 768,  NULL, tskIDLE_PRIORITY + 2, &tasks[2]) == pdPASS
+    && xTaskCreate(logTask,     taskNames[3], 256,  NULL, tskIDLE_PRIORITY + 1, &tasks[3]) == pdPASS;
+  if(!started){
+    //without the control task nothing would run the boilers; leave them off
+    //and never start the scheduler, loop() is empty with RTOS_ENABLED
+    brewhob->setHeater(1, 0);
+    brewhob->setHeater(2, 0);
+    Serial.println("RTOS tasks could not be created, heaters off");
+    return;
+  }
+
+  brewhob->setLog(&logPrint);
+  Debug.setDebugOutputStream(&logPrint); //ArduinoIoTCloud prints from the cloud task
+  vTaskStartScheduler(); //does not return
+}
+
+#else
+
+void lockData(){}
+void unlockData(){}
+void postSettings(const Settings& s){ settings = s; }
+void receiveSettings(){}
+
+#endif
+
+/************* END TASKS ***********/
+
+
 void setup() {
   // Initialize serial and wait for port to open:
   Serial.begin(9600);
@@ -47,6 +232,7 @@ void setup() {
   delay(1500); 
 
   brewhob = new Brewhob();
+  restoreSettings(); //the cloud overrides them once it syncs
 
   if(WIFI_ENABLED){
     // Defined in thingProperties.h
@@ -62,124 +248,238 @@ void setup() {
   }
 
   brewhob->enableRTD();
+  brewhob->enableHeaters();
 
   attachInterrupt(digitalPinToInterrupt(SW1_PIN), SW1_ISR, RISING); //Brew Switch ISR
   attachInterrupt(digitalPinToInterrupt(SW2_PIN), SW2_ISR, RISING); //Brew Switch ISR
   attachInterrupt(digitalPinToInterrupt(FLOW_PIN), FLOW_ISR,CHANGE); //flowmeter ISR
+
+#if RTOS_ENABLED
+  startTasks();
+#endif
 }
 
 void loop() {
-  if(millis() - last1s_ms >=1000){ //every second
-    last1s_ms = millis();
-    if(brewhob->getState() != "OFF" && STEAM_BOILER_EN) 
-      brewhob->readFill();
+  //with RTOS_ENABLED this is the idle hook, the tasks do the work
+#if !RTOS_ENABLED
+  sensorStep();
+  cloudStep();
+  controlStep();
+  logStep();
+#endif
+}
 
-    brewhob->readRTD(1);
-    brewhob->readRTD(2); 
-
-    if(WIFI_ENABLED){
-      brewhob->setPower(_Schedule.isActive()); //turn off/on based on iot schedule
-      //Send new data to cloud
-      _BrewBoilerTemp   = (int)brewhob->getRTD(1);
-      _SteamBoilerTemp  = (int)brewhob->getRTD(2); 
-      _ShotTimer        = brewhob->getShotTimer();
-      _FlowMeter        = brewhob->getFlowCount();
-      _State            = brewhob->getState();
-      _Log              = brewhob->log_;
-      _FlowRate         = brewhob->getFlowRate();
-      _LastShot         = brewhob->lastShotSpecs_;
-
-      ArduinoCloud.update();
-
-      //update local data from remotely saved data
-      brewhob->setShotSize(_ShotSize);
-      brewhob->setTemp(1,_BrewBoilerSP);
-      brewhob->setTemp(2,_SteamBoilerSP);
-      brewhob->prewet_ = _Prewet;
-      brewhob->dwell_  = _Dwell;
-      brewhob->delayPumpStart_ = _DelayPumpStart;
-    
-    }
-    brewhob->setState();
-    brewhob->printAll(); 
-  }
 
-  if(millis() - last2s_ms >=2000){ //every 2 seconds
-    last2s_ms = millis();
+/************* STEPS ***********/
 
-    if(brewhob->getState() != "OFF"){
-      //turn on brew heater if pwm is nonzero, update pid value
-      digitalWrite(
-        HEAT1_PIN,brewhob->readPID(1)!=0 
-        && BREW_BOILER_EN 
-        && _BrewBoilerOn);
+//RTDs and fill probe
+void sensorStep(){
+  brewhob->serviceRTD(); //never blocks, samples both RTDs every RTD_PERIOD_MS
+  brewhob->serviceFlow(); //flow rate fit over the last FLOW_WINDOW pulses
 
-      brewhob->readPID(2);
-    }
-    digitalWrite(HEAT2_PIN,LOW);
-    //digitalWrite(HEAT2_PIN,brewhob.readPID(2)!=0 && STEAM_BOILER_EN);
+  if(millis() - lastFill_ms >=1000){ //every second
+    lastFill_ms = millis();
+    if(brewhob->getStateId() != Brewhob::OFF && STEAM_BOILER_EN) 
+      brewhob->readFill();
   }
+}
 
-  if(millis() - last10s_ms >=10000){ //every 10 seconds
-    last10s_ms = millis();
-    brewhob->printHeader();
+//state machine, heaters, pump and solenoid phases
+void controlStep(){
+  receiveSettings();
+  brewhob->setShotSize(settings.shotSize);
+  brewhob->setTemp(1,settings.brewSP);
+  brewhob->setTemp(2,settings.steamSP);
+  brewhob->prewet_ = settings.prewet;
+  brewhob->dwell_  = settings.dwell;
+  brewhob->delayPumpStart_ = settings.delayPumpStart;
+  brewhob->setProfile(settings.profile);
+
+  lockData();
+  static PIDGains applied[2];
+  if(settings.tuned && memcmp(applied, settings.gains, sizeof(applied))){
+    memcpy(applied, settings.gains, sizeof(applied));
+    brewhob->setGains(1, applied[0]);
+    brewhob->setGains(2, applied[1]);
+  }
+  static int autotune = 0; //act on changes only, the cloud clears the request when done
+  if(settings.autotune != autotune){
+    autotune = settings.autotune;
+    brewhob->stopAutotune();
+    if(autotune) brewhob->startAutotune(autotune);
   }
-  //turn off brew boiler if the end of the PWM pulse has been reached
-  if(millis() - last2s_ms>=brewhob->getPID(1)) digitalWrite(HEAT1_PIN,LOW);
-
-  //turn on the steam boiler if the brew boiler is off, and its time to turn it on, and the heaters are enabled
-  //if(millis() - last2s_ms>=brewhob.getPID(2)) digitalWrite(HEAT2_PIN,LOW);
-  
-  if( (millis() - last2s_ms >= brewhob->getPID(1) || !_BrewBoilerOn)
-    && millis() >= last2s_ms + 2000 - brewhob->getPID(2) 
-    && brewhob->getState() != "OFF"
-    && STEAM_BOILER_EN
-    && _SteamBoilerOn
-    ) digitalWrite(HEAT2_PIN,HIGH);
 
+  brewhob->serviceState(); //apply state changes requested by the ISRs
+  if(millis() - last1s_ms >=1000){ //every second
+    last1s_ms = millis();
+    brewhob->setPower(settings.power);
+    brewhob->setState();
+  }
+  brewhob->serviceRecorder(); //10 Hz shot recording while brewing
+  unlockData();
 
-  /* PREWETTING -> DWELL: Pump and valve on -> pump on and valve off */
+  if(millis() - last2s_ms >=HEATER_WINDOW_MS){ //every heater window
+    last2s_ms = millis();
 
-  if( brewhob->getState() == "BREW"
-    && millis() - brewhob->shotTimerStart_ >= ( brewhob->prewet_ * 1000 ) 
-    && millis() - brewhob->shotTimerStart_ < ( brewhob->prewet_ + brewhob->dwell_ ) * 1000 )
-  {
-    //Enter Dwell, disable brew solenoid
-    brewhob->setSolenoid(2,0);
-    brewhob->dwellOn_ = true;
+    //update pid values, the heater timer ISR applies them from its next window
+    int brewOn = 0, steamOn = 0;
+    lockData();
+    if(brewhob->getStateId() != Brewhob::OFF){
+      brewOn  = brewhob->readPID(1);
+      steamOn = brewhob->readPID(2);
+    }
+    unlockData();
+    brewhob->setHeater(1, BREW_BOILER_EN  && settings.brewBoilerOn  ? brewOn  : 0);
+    brewhob->setHeater(2, STEAM_BOILER_EN && settings.steamBoilerOn ? steamOn : 0);
   }
-  else{
-    brewhob->dwellOn_ = false;
+
+  //pump and valve phases (prewet, dwell, bloom or a ShotProfile from the
+  //cloud) are stepped by the timer ISR, see ProfileExecutor
+}
+
+//cloud dashboard sync
+void cloudStep(){
+  if(!WIFI_ENABLED || millis() - lastCloud_ms < 1000) return; //every second
+  lastCloud_ms = millis();
+
+  //Send new data to cloud
+  _BrewBoilerTemp   = (int)brewhob->getRTD(1);
+  _SteamBoilerTemp  = (int)brewhob->getRTD(2); 
+  _ShotTimer        = brewhob->getShotTimer();
+  _FlowMeter        = brewhob->getFlowCount();
+  _State            = brewhob->getState();
+  _FlowRate         = brewhob->getFlowRate();
+  lockData();
+  _Log              = brewhob->log_.c_str(); //reuses _Log's buffer once it is large enough
+  _LastShot         = brewhob->lastShotSpecs_;
+  static uint8_t tuningId = 0;
+  if(brewhob->getTuningId() != tuningId){ //an autotune finished, save its gains in the cloud
+    tuningId = brewhob->getTuningId();
+    cloudTuning[0] = brewhob->getGains(1);
+    cloudTuning[1] = brewhob->getGains(2);
+    cloudTuned = true;
+    TelemetryFrame text;
+    Brewhob::formatTuning(cloudTuning, text);
+    _Tuning   = text.c_str();
+    _Autotune = 0;
   }
+  unlockData();
+
+  ArduinoCloud.update();
+
+  //update local data from remotely saved data
+  Settings s;
+  s.shotSize       = _ShotSize;
+  s.brewSP         = _BrewBoilerSP;
+  s.steamSP        = _SteamBoilerSP;
+  s.prewet         = _Prewet;
+  s.dwell          = _Dwell;
+  s.delayPumpStart = _DelayPumpStart;
+  s.power          = _Schedule.isActive(); //turn off/on based on iot schedule
+  s.brewBoilerOn   = _BrewBoilerOn;
+  s.steamBoilerOn  = _SteamBoilerOn;
+  s.profile        = cloudProfile;
+  s.autotune       = _Autotune;
+  s.tuned          = cloudTuned;
+  memcpy(s.gains, cloudTuning, sizeof(s.gains));
+  postSettings(s);
+  saveSettings(s);
+}
 
-  if( brewhob->getState() == "BREW"
-    && millis() - brewhob->shotTimerStart_ >= ( brewhob->prewet_ + brewhob->dwell_ ) * 1000 )
-  {
-    //Exit dwell, enable brew valve
-    brewhob->setSolenoid(2,1);
+//last saved dashboard values into settings and the cloud properties
+void restoreSettings(){
+  if(!savedSettings.Load()) savedSettings.Reset(); //nothing saved since the upload
+  const SavedSettings& saved = savedSettings.Data;
+  _ShotSize       = settings.shotSize       = saved.shotSize;
+  _BrewBoilerSP   = settings.brewSP         = saved.brewSP;
+  _SteamBoilerSP  = settings.steamSP        = saved.steamSP;
+  _Prewet         = settings.prewet         = saved.prewet;
+  _Dwell          = settings.dwell          = saved.dwell;
+  _DelayPumpStart = settings.delayPumpStart = saved.delayPumpStart;
+  _BrewBoilerOn   = settings.brewBoilerOn   = saved.brewBoilerOn;
+  _SteamBoilerOn  = settings.steamBoilerOn  = saved.steamBoilerOn;
+  cloudTuned = settings.tuned = saved.tuned;
+  memcpy(cloudTuning, saved.gains, sizeof(cloudTuning));
+  memcpy(settings.gains, saved.gains, sizeof(settings.gains));
+  if(cloudTuned){
+    TelemetryFrame text;
+    Brewhob::formatTuning(cloudTuning, text);
+    _Tuning = text.c_str();
   }
+}
 
-  /* PREWETTING -> PUMP DELAY: Pump and Valve on -> Pump off and valve on */
+//appends the values that changed to the flash log, then compacts a little;
+//the CPU stalls for a few ms per flash page or row, never on a quiet second.
+//Nothing is written during a shot, the stall would delay the profile ticks;
+//Data keeps the values and the first call after the shot saves them
+void saveSettings(const Settings& s){
+  SavedSettings& saved = savedSettings.Data;
+  saved.shotSize       = s.shotSize;
+  saved.brewSP         = s.brewSP;
+  saved.steamSP        = s.steamSP;
+  saved.prewet         = s.prewet;
+  saved.dwell          = s.dwell;
+  saved.delayPumpStart = s.delayPumpStart;
+  saved.brewBoilerOn   = s.brewBoilerOn;
+  saved.steamBoilerOn  = s.steamBoilerOn;
+  saved.tuned          = s.tuned;
+  memcpy(saved.gains, s.gains, sizeof(saved.gains));
+  if(brewhob->getStateId() == Brewhob::BREW) return;
+  savedSettings.Save();
+  savedSettings.Service();
+}
 
-  if( brewhob->getState() == "BREW"
-    && millis() - brewhob->shotTimerStart_ >= ( brewhob->prewet_ * 1000 ) 
-    && millis() - brewhob->shotTimerStart_ < ( brewhob->prewet_ + brewhob->delayPumpStart_ ) * 1000 )
-  {
-    //Enter Pump Delay, disable pump
-    brewhob->setPump(0);
-    brewhob->pumpDisabled_ = true;
+//serial log
+void logStep(){
+  if(millis() - lastLog_ms >=1000){ //every second
+    lastLog_ms = millis();
+    lockData();
+    brewhob->printAll(); 
+    unlockData();
   }
-  else{
-    brewhob->pumpDisabled_ = false;
+
+  if(millis() - last10s_ms >=10000){ //every 10 seconds
+    last10s_ms = millis();
+    brewhob->printHeader();
+#if RTOS_ENABLED
+    Serial.print("control jitter max ");
+    Serial.print(controlJitterMax_us);
+    Serial.print("us, step max ");
+    Serial.print(controlStepMax_us);
+    Serial.println("us");
+    Serial.print("stack words free");
+    for(uint8_t i = 0; i < 4; i++){
+      Serial.print(" ");
+      Serial.print(taskNames[i]);
+      Serial.print(" ");
+      Serial.print(uxTaskGetStackHighWaterMark(tasks[i]));
+    }
+    Serial.println();
+#endif
+    lockData();
+    if(brewhob->getAutotune()){
+      Serial.print("autotune boiler ");
+      Serial.print(brewhob->getAutotune());
+      Serial.print(", cycle ");
+      Serial.println(brewhob->getAutotuner().cycles());
+    }
+    unlockData();
   }
 
-  if( brewhob->getState() == "BREW"
-    && millis() - brewhob->shotTimerStart_ >= (brewhob->prewet_ + brewhob->delayPumpStart_ ) * 1000 )
-  {
-    brewhob->setPump(255);
+  //send each new shot profile once, as hex lines
+  static uint32_t lastShotId = 0;
+  lockData();
+  const ShotRecorder& shots = brewhob->getShotRecorder();
+  if(shots.shotId() != lastShotId && !shots.recording()){
+    lastShotId = shots.shotId();
+    Serial.println("Shot profile");
+    shots.dump(0, &Serial);
   }
+  unlockData();
 }
 
+/************* END STEPS ***********/
+
 
 void onBrewBoilerOnChange(){}
 void onSteamBoilerOnChange(){}
@@ -190,17 +490,18 @@ void onScheduleChange(){}
 void onBrewBoilerSPChange(){}
 void onSteamBoilerSPChange(){}
 void onPrewetChange()  {}
-void onDwellChange()  {
-  //Dwell and Pump Delay cannot both be enabled
-  if(_Dwell){
-    brewhob->delayPumpStart_ = 0;
-    _DelayPumpStart = 0;
-  }
+void onDwellChange()  {}
+void onDelayPumpStartChange() {}
+void onProfileChange() {
+  //hex blob, see ShotProfile::toHex(); empty selects prewet/dwell/pump delay
+  if(_Profile.length() == 0) cloudProfile.count = 0;
+  else cloudProfile.fromHex(_Profile.c_str());
 }
-void onDelayPumpStartChange() {
-  //Dwell and Pump Delay cannot both be enabled
-  if(_DelayPumpStart){
-    brewhob->dwell_ = 0;
-    _Dwell = 0;
-  }
+void onAutotuneChange() {}
+void onTuningChange() {
+  //"kp,ki,kd,kp,ki,kd" for the brew and steam boilers, see Brewhob::formatTuning()
+  PIDGains gains[2];
+  if(!Brewhob::parseTuning(_Tuning.c_str(), gains)) return;
+  memcpy(cloudTuning, gains, sizeof(cloudTuning));
+  cloudTuned = true;
 }
\ No newline at end of file
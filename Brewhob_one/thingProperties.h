@@ -16,10 +16,15 @@ void onSteamBoilerSPChange();
 void onScheduleChange();
 void onBrewBoilerOnChange();
 void onSteamBoilerOnChange();
+void onProfileChange();
+void onAutotuneChange();
+void onTuningChange();
 
 String _LastShot;
 String _Log;
 String _State;
+String _Profile;
+String _Tuning;
 CloudCounter _FlowMeter;
 CloudCounter _ShotSize;
 float _PowerConsumption_kWh;
@@ -35,6 +40,7 @@ bool _BrewBoilerOn;
 bool _SteamBoilerOn;
 CloudTime _ShotTimer;
 int _FlowRate;
+int _Autotune;
 
 
 void initProperties(){
@@ -57,6 +63,9 @@ void initProperties(){
   ArduinoCloud.addProperty(_SteamBoilerOn,        READWRITE,  1 * SECONDS, onSteamBoilerOnChange);
   ArduinoCloud.addProperty(_ShotTimer,            READ,       1 * SECONDS, NULL);
   ArduinoCloud.addProperty(_FlowRate,             READ,       1 * SECONDS, NULL);
+  ArduinoCloud.addProperty(_Profile,              READWRITE,  ON_CHANGE, onProfileChange);
+  ArduinoCloud.addProperty(_Autotune,             READWRITE,  1 * SECONDS, onAutotuneChange);
+  ArduinoCloud.addProperty(_Tuning,               READWRITE,  ON_CHANGE, onTuningChange);
 
 }
 
@@ -96,6 +96,8 @@ Adafruit_BusIO_Register::Adafruit_BusIO_Register(
  * uncheckable)
  */
 bool Adafruit_BusIO_Register::write(uint8_t *buffer, uint8_t len) {
+  // raw bytes bypass the shadow copy, so it no longer holds
+  _cacheValid = false;
 
   uint8_t addrbuffer[2] = {(uint8_t)(_address & 0xFF),
                            (uint8_t)(_address >> 8)};
@@ -147,18 +149,33 @@ bool Adafruit_BusIO_Register::write(uint32_t value, uint8_t numbytes) {
     return false;
   }
 
+  // the device already holds it, and no self-clearing bit is being set
+  if (_cacheValid && value == _cached && numbytes == _width) {
+    return true;
+  }
+
   // store a copy
   _cached = value;
 
+  uint32_t shift = value;
   for (int i = 0; i < numbytes; i++) {
     if (_byteorder == LSBFIRST) {
-      _buffer[i] = value & 0xFF;
+      _buffer[i] = shift & 0xFF;
     } else {
-      _buffer[numbytes - i - 1] = value & 0xFF;
+      _buffer[numbytes - i - 1] = shift & 0xFF;
     }
-    value >>= 8;
+    shift >>= 8;
+  }
+  if (!write(_buffer, numbytes)) {
+    // the device may hold the old value, or part of the new one
+    _cacheValid = false;
+    return false;
+  }
+  if (_cacheEnabled && numbytes == _width) {
+    _cached = value & ~_volatile;
+    _cacheValid = true;
   }
-  return write(_buffer, numbytes);
+  return true;
 }
 
 /*!
@@ -167,6 +184,9 @@ bool Adafruit_BusIO_Register::write(uint32_t value, uint8_t numbytes) {
  *    @return Returns 0xFFFFFFFF on failure, value otherwise
  */
 uint32_t Adafruit_BusIO_Register::read(void) {
+  if (_cacheValid) {
+    return _cached;
+  }
   if (!read(_buffer, _width)) {
     return -1;
   }
@@ -182,6 +202,10 @@ uint32_t Adafruit_BusIO_Register::read(void) {
     }
   }
 
+  if (_cacheEnabled) {
+    _cached = value & ~_volatile;
+    _cacheValid = true;
+  }
   return value;
 }
 
@@ -334,17 +358,91 @@ bool Adafruit_BusIO_RegisterBits::write(uint32_t data) {
   return _register->write(val, _register->width());
 }
 
+/*!
+ *    @brief  Start an empty batch of updates to a register
+ *    @param  reg The Adafruit_BusIO_Register the updates go to
+ */
+Adafruit_BusIO_RegisterBatch::Adafruit_BusIO_RegisterBatch(
+    Adafruit_BusIO_Register *reg) {
+  _register = reg;
+  _mask = 0;
+  _value = 0;
+}
+
+/*!
+ *    @brief  Add a field update to the batch. A later update of the same
+ * bits replaces an earlier one
+ *    @param  bits The bit-slice to update, which must belong to the register
+ * of the batch
+ *    @param  value The new value of the slice
+ */
+void Adafruit_BusIO_RegisterBatch::write(Adafruit_BusIO_RegisterBits *bits,
+                                         uint32_t value) {
+  uint32_t mask = (1 << (bits->_bits)) - 1;
+  write(mask << bits->_shift, (value & mask) << bits->_shift);
+}
+
+/*!
+ *    @brief  Add an update of arbitrary bits to the batch
+ *    @param  mask The bits to replace
+ *    @param  value Their new values, in place
+ */
+void Adafruit_BusIO_RegisterBatch::write(uint32_t mask, uint32_t value) {
+  _mask |= mask;
+  _value = (_value & ~mask) | (value & mask);
+}
+
+/*!
+ *    @brief  Apply every update with one read and one write, or a write
+ * alone when the register cache is valid. The batch is empty afterwards
+ *    @return True on successful write (only really useful for I2C as SPI is
+ * uncheckable)
+ */
+bool Adafruit_BusIO_RegisterBatch::commit(void) {
+  if (!_mask) {
+    return true;
+  }
+  uint32_t val = _register->read();
+  val = (val & ~_mask) | _value;
+  _mask = 0;
+  _value = 0;
+  return _register->write(val, _register->width());
+}
+
 /*!
  *    @brief  The width of the register data, helpful for doing calculations
  *    @returns The data width used when initializing the register
  */
 uint8_t Adafruit_BusIO_Register::width(void) { return _width; }
 
+/*!
+ *    @brief  Keep a shadow copy of a register that only changes when we
+ * write it. read() then answers from the copy, and write() skips values the
+ * device already holds. The copy is filled by the next read() or write()
+ *    @param  volatile_bits Bits the device clears by itself, such as a
+ * start-conversion bit. They are never cached, so writing one always
+ * reaches the bus and it reads back as 0
+ */
+void Adafruit_BusIO_Register::enableCache(uint32_t volatile_bits) {
+  _volatile = volatile_bits;
+  _cacheEnabled = true;
+  _cacheValid = false;
+}
+
+/*!
+ *    @brief  Forget the shadow copy, e.g. after the device was reset. The
+ * next read() goes to the bus
+ */
+void Adafruit_BusIO_Register::invalidateCache(void) { _cacheValid = false; }
+
 /*!
  *    @brief  Set the default width of data
  *    @param width the default width of data read from register
  */
-void Adafruit_BusIO_Register::setWidth(uint8_t width) { _width = width; }
+void Adafruit_BusIO_Register::setWidth(uint8_t width) {
+  _width = width;
+  _cacheValid = false;
+}
 
 /*!
  *    @brief  Set register address
@@ -352,6 +450,7 @@ void Adafruit_BusIO_Register::setWidth(uint8_t width) { _width = width; }
  */
 void Adafruit_BusIO_Register::setAddress(uint16_t address) {
   _address = address;
+  _cacheValid = false;
 }
 
 /*!
@@ -71,6 +71,9 @@ public:
   void setAddress(uint16_t address);
   void setAddressWidth(uint16_t address_width);
 
+  void enableCache(uint32_t volatile_bits = 0);
+  void invalidateCache(void);
+
   void print(Stream *s = &Serial);
   void println(Stream *s = &Serial);
 
@@ -83,6 +86,9 @@ private:
   uint8_t _buffer[4]; // we won't support anything larger than uint32 for
                       // non-buffered read
   uint32_t _cached = 0;
+  uint32_t _volatile = 0;      // bits that clear themselves, never cached
+  bool _cacheEnabled = false;  // read() answers from _cached when valid
+  bool _cacheValid = false;
 };
 
 /*!
@@ -97,9 +103,26 @@ public:
   uint32_t read(void);
 
 private:
+  friend class Adafruit_BusIO_RegisterBatch;
   Adafruit_BusIO_Register *_register;
   uint8_t _bits, _shift;
 };
 
+/*!
+ * @brief Several field updates of one register merged into a single
+ * read-modify-write. Nothing reaches the bus until commit()
+ */
+class Adafruit_BusIO_RegisterBatch {
+public:
+  Adafruit_BusIO_RegisterBatch(Adafruit_BusIO_Register *reg);
+  void write(Adafruit_BusIO_RegisterBits *bits, uint32_t value);
+  void write(uint32_t mask, uint32_t value);
+  bool commit(void);
+
+private:
+  Adafruit_BusIO_Register *_register;
+  uint32_t _mask, _value;
+};
+
 #endif // SPI exists
 #endif // BusIO_Register_h
@@ -0,0 +1,148 @@
+#include "Adafruit_SPIDMA_SAMD21.h"
+
+#ifdef BUSIO_SPI_DMA_SAMD21
+
+static __attribute__((aligned(16))) DmacDescriptor
+    _descriptors[BUSIO_DMA_CHANNELS];
+static __attribute__((aligned(16))) DmacDescriptor
+    _writeback[BUSIO_DMA_CHANNELS];
+static DmacDescriptor *_table = _descriptors; // the one BASEADDR points at
+static Adafruit_SPIDMA_SAMD21 *_active = NULL;
+
+/*!
+ *    @brief  Create a transport for one SERCOM in SPI mode
+ *    @param  sercom The SERCOM of the SPI bus, e.g. SERCOM1 on MKR boards
+ *    @param  txTrigger DMAC trigger of its transmit, e.g.
+ * SERCOM1_DMAC_ID_TX
+ *    @param  rxTrigger DMAC trigger of its receive, e.g. SERCOM1_DMAC_ID_RX
+ *    @param  txChannel DMAC channel that sends, below BUSIO_DMA_CHANNELS
+ *    @param  rxChannel DMAC channel that receives, below BUSIO_DMA_CHANNELS
+ */
+Adafruit_SPIDMA_SAMD21::Adafruit_SPIDMA_SAMD21(Sercom *sercom,
+                                               uint8_t txTrigger,
+                                               uint8_t rxTrigger,
+                                               uint8_t txChannel,
+                                               uint8_t rxChannel)
+    : _sercom(sercom), _txTrigger(txTrigger), _rxTrigger(rxTrigger),
+      _txChannel(txChannel), _rxChannel(rxChannel), _fill(0xFF), _drain(0) {}
+
+/*!
+ *    @brief  Set up both channels. Enables the DMAC with the descriptors of
+ * this library, unless another library has enabled it already, in which
+ * case its descriptor table is used. Other channels are left alone
+ *    @return False if a channel is out of range
+ */
+bool Adafruit_SPIDMA_SAMD21::begin(void) {
+  if (_txChannel >= DMAC_CH_NUM || _rxChannel >= DMAC_CH_NUM ||
+      _txChannel == _rxChannel) {
+    return false;
+  }
+
+  PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+  PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+
+  if (DMAC->CTRL.bit.DMAENABLE) {
+    _table = (DmacDescriptor *)DMAC->BASEADDR.reg;
+  } else {
+    if (_txChannel >= BUSIO_DMA_CHANNELS || _rxChannel >= BUSIO_DMA_CHANNELS) {
+      return false;
+    }
+    _table = _descriptors;
+    DMAC->BASEADDR.reg = (uint32_t)_descriptors;
+    DMAC->WRBADDR.reg = (uint32_t)_writeback;
+    DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xf);
+  }
+
+  setupChannel(_txChannel, _txTrigger);
+  setupChannel(_rxChannel, _rxTrigger);
+  DMAC->CHID.reg = DMAC_CHID_ID(_rxChannel);
+  DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+
+  _active = this;
+  NVIC_EnableIRQ(DMAC_IRQn);
+  return true;
+}
+
+void Adafruit_SPIDMA_SAMD21::setupChannel(uint8_t channel, uint8_t trigger) {
+  DMAC->CHID.reg = DMAC_CHID_ID(channel);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST)
+    ;
+  DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(trigger) |
+                      DMAC_CHCTRLB_TRIGACT_BEAT;
+}
+
+void Adafruit_SPIDMA_SAMD21::enableChannel(uint8_t channel) {
+  DMAC->CHID.reg = DMAC_CHID_ID(channel);
+  DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+}
+
+/*!
+ *    @brief  Start both channels. Returns at once, the DMAC interrupt
+ * completes the transfer
+ *    @param  tx Bytes to send, or NULL to send fill
+ *    @param  rx Where the received bytes go, or NULL to drop them
+ *    @param  len Number of bytes, 1 to 65535
+ *    @param  fill The byte sent when tx is NULL
+ */
+void Adafruit_SPIDMA_SAMD21::start(const uint8_t *tx, uint8_t *rx, size_t len,
+                                   uint8_t fill) {
+  volatile void *data = &_sercom->SPI.DATA.reg;
+  _fill = fill;
+
+  // Anything left in the receiver would shift every byte by one
+  while (_sercom->SPI.INTFLAG.bit.RXC) {
+    (void)_sercom->SPI.DATA.reg;
+  }
+  _sercom->SPI.STATUS.bit.BUFOVF = 1;
+
+  // Addresses of incrementing buffers point past the last byte
+  DmacDescriptor &rxd = _table[_rxChannel];
+  rxd.BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+                   (rx ? DMAC_BTCTRL_DSTINC : 0);
+  rxd.BTCNT.reg = len;
+  rxd.SRCADDR.reg = (uint32_t)data;
+  rxd.DSTADDR.reg = rx ? (uint32_t)(rx + len) : (uint32_t)&_drain;
+  rxd.DESCADDR.reg = 0;
+
+  DmacDescriptor &txd = _table[_txChannel];
+  txd.BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+                   (tx ? DMAC_BTCTRL_SRCINC : 0);
+  txd.BTCNT.reg = len;
+  txd.SRCADDR.reg = tx ? (uint32_t)(tx + len) : (uint32_t)&_fill;
+  txd.DSTADDR.reg = (uint32_t)data;
+  txd.DESCADDR.reg = 0;
+
+  // Receive first so no byte is missed
+  enableChannel(_rxChannel);
+  enableChannel(_txChannel);
+}
+
+/*!
+ *    @brief  Acknowledge the DMAC interrupt and complete the transfer when
+ * the receive channel is done. Interrupts of other channels are left
+ * pending
+ *    @return False if the pending interrupt is not one of this transport,
+ * so a shared handler can pass it on
+ */
+bool Adafruit_SPIDMA_SAMD21::handleInterrupt(void) {
+  uint8_t channel = DMAC->INTPEND.bit.ID;
+  if (!_active ||
+      (channel != _active->_rxChannel && channel != _active->_txChannel)) {
+    return false;
+  }
+  uint8_t saved = DMAC->CHID.reg; // an interrupted start() may be using it
+  DMAC->CHID.reg = DMAC_CHID_ID(channel);
+  uint8_t flags = DMAC->CHINTFLAG.reg;
+  DMAC->CHINTFLAG.reg = flags;
+  DMAC->CHID.reg = saved;
+
+  if (channel == _active->_rxChannel && (flags & DMAC_CHINTFLAG_TCMPL) &&
+      _active->_queue) {
+    _active->_queue->complete();
+  }
+  return true;
+}
+
+#endif // BUSIO_SPI_DMA_SAMD21
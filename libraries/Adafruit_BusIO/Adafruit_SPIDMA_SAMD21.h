@@ -0,0 +1,63 @@
+#ifndef Adafruit_SPIDMA_SAMD21_h
+#define Adafruit_SPIDMA_SAMD21_h
+
+#include "Adafruit_SPIQueue.h"
+
+#if defined(ARDUINO_ARCH_SAMD) && !defined(__SAMD51__)
+#define BUSIO_SPI_DMA_SAMD21
+
+#include <Arduino.h>
+
+// Descriptors are kept for channels 0 to BUSIO_DMA_CHANNELS - 1, when no
+// other library has set up the DMAC first
+#ifndef BUSIO_DMA_CHANNELS
+#define BUSIO_DMA_CHANNELS 2
+#endif
+
+/*!
+ * @brief SPI transport on the SAMD21 DMAC. One channel feeds the SERCOM
+ * data register, a second drains it, and the transfer completes in the
+ * DMAC interrupt when the last received byte is in. The SERCOM has to be
+ * in SPI mode already; the SPIClass beginTransaction() done by
+ * Adafruit_SPIDevice::select() sees to that.
+ *
+ * begin() only resets its own two channels. If another library, such as
+ * Adafruit_ZeroDMA, has enabled the DMAC already, its descriptor table is
+ * shared: call begin() after that library's setup and pick channels it
+ * does not use. The library defines no DMAC_Handler. Put
+ * BUSIO_DMAC_HANDLER once in the sketch, or call handleInterrupt() from
+ * the handler another library owns.
+ */
+class Adafruit_SPIDMA_SAMD21 : public Adafruit_SPITransport {
+public:
+  Adafruit_SPIDMA_SAMD21(Sercom *sercom, uint8_t txTrigger, uint8_t rxTrigger,
+                         uint8_t txChannel = 0, uint8_t rxChannel = 1);
+
+  bool begin(void);
+  void start(const uint8_t *tx, uint8_t *rx, size_t len, uint8_t fill);
+  size_t maxLength(void) { return 0xFFFF; }
+
+  static bool handleInterrupt(void);
+
+private:
+  void setupChannel(uint8_t channel, uint8_t trigger);
+  void enableChannel(uint8_t channel);
+
+  Sercom *_sercom;
+  uint8_t _txTrigger, _rxTrigger;
+  uint8_t _txChannel, _rxChannel;
+  uint8_t _fill;  // sent when there is no tx buffer
+  uint8_t _drain; // received bytes nobody wants
+};
+
+/*!
+ * @brief Defines DMAC_Handler for the transport, in a sketch where no other
+ * library owns it
+ */
+#define BUSIO_DMAC_HANDLER                                                     \
+  extern "C" void DMAC_Handler(void) {                                         \
+    Adafruit_SPIDMA_SAMD21::handleInterrupt();                                 \
+  }
+
+#endif // ARDUINO_ARCH_SAMD
+#endif // Adafruit_SPIDMA_SAMD21_h
@@ -268,12 +268,19 @@ uint8_t Adafruit_SPIDevice::transfer(uint8_t send) {
 
 /*!
  *    @brief  Manually begin a transaction (calls beginTransaction if hardware
- * SPI)
+ * SPI). Waits for the asynchronous queue, if any, to empty
+ *    @return False, and no transaction begun, if the queue could not be
+ * waited for because this runs from one of its completion callbacks
  */
-void Adafruit_SPIDevice::beginTransaction(void) {
+bool Adafruit_SPIDevice::beginTransaction(void) {
+  // Let queued transfers on the bus finish first
+  if (_queue && !_queue->flush()) {
+    return false;
+  }
   if (_spi) {
     _spi->beginTransaction(*_spiSetting);
   }
+  return true;
 }
 
 /*!
@@ -292,14 +299,15 @@ void Adafruit_SPIDevice::endTransaction(void) {
  *    @param  prefix_buffer Pointer to optional array of data to write before
  * buffer.
  *    @param  prefix_len Number of bytes from prefix buffer to write
- *    @return Always returns true because there's no way to test success of SPI
- * writes
+ *    @return False, with nothing sent, if transfers are queued and this runs
+ * from a completion callback, which cannot wait for them. Otherwise true,
+ * as there's no way to test success of SPI writes
  */
 bool Adafruit_SPIDevice::write(const uint8_t *buffer, size_t len,
                                const uint8_t *prefix_buffer,
                                size_t prefix_len) {
-  if (_spi) {
-    _spi->beginTransaction(*_spiSetting);
+  if (!beginTransaction()) {
+    return false;
   }
 
   setChipSelect(LOW);
@@ -357,13 +365,14 @@ bool Adafruit_SPIDevice::write(const uint8_t *buffer, size_t len,
  *    @param  len Number of bytes from buffer to read.
  *    @param  sendvalue The 8-bits of data to write when doing the data read,
  * defaults to 0xFF
- *    @return Always returns true because there's no way to test success of SPI
- * writes
+ *    @return False, with nothing sent, if transfers are queued and this runs
+ * from a completion callback, which cannot wait for them. Otherwise true,
+ * as there's no way to test success of SPI writes
  */
 bool Adafruit_SPIDevice::read(uint8_t *buffer, size_t len, uint8_t sendvalue) {
   memset(buffer, sendvalue, len); // clear out existing buffer
-  if (_spi) {
-    _spi->beginTransaction(*_spiSetting);
+  if (!beginTransaction()) {
+    return false;
   }
 
   setChipSelect(LOW);
@@ -400,14 +409,15 @@ bool Adafruit_SPIDevice::read(uint8_t *buffer, size_t len, uint8_t sendvalue) {
  *    @param  read_len Number of bytes from buffer to read.
  *    @param  sendvalue The 8-bits of data to write when doing the data read,
  * defaults to 0xFF
- *    @return Always returns true because there's no way to test success of SPI
- * writes
+ *    @return False, with nothing sent, if transfers are queued and this runs
+ * from a completion callback, which cannot wait for them. Otherwise true,
+ * as there's no way to test success of SPI writes
  */
 bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer,
                                          size_t write_len, uint8_t *read_buffer,
                                          size_t read_len, uint8_t sendvalue) {
-  if (_spi) {
-    _spi->beginTransaction(*_spiSetting);
+  if (!beginTransaction()) {
+    return false;
   }
 
   setChipSelect(LOW);
@@ -472,12 +482,13 @@ bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer,
  * This /does/ transmit-receive at the same time!
  *    @param  buffer Pointer to buffer of data to write/read to/from
  *    @param  len Number of bytes from buffer to write/read.
- *    @return Always returns true because there's no way to test success of SPI
- * writes
+ *    @return False, with nothing sent, if transfers are queued and this runs
+ * from a completion callback, which cannot wait for them. Otherwise true,
+ * as there's no way to test success of SPI writes
  */
 bool Adafruit_SPIDevice::write_and_read(uint8_t *buffer, size_t len) {
-  if (_spi) {
-    _spi->beginTransaction(*_spiSetting);
+  if (!beginTransaction()) {
+    return false;
   }
 
   setChipSelect(LOW);
@@ -491,6 +502,125 @@ bool Adafruit_SPIDevice::write_and_read(uint8_t *buffer, size_t len) {
   return true;
 }
 
+/*!
+ *    @brief  Send asynchronous transfers through a queue, e.g. in front of
+ * the SAMD21 DMAC. Every device on the bus should use the same queue, as
+ * the blocking calls only wait for the queue of their own device
+ *    @param  queue The queue, or NULL to make the async calls blocking
+ */
+void Adafruit_SPIDevice::setQueue(Adafruit_SPIQueue *queue) {
+  if (_queue) {
+    _queue->flush();
+  }
+  _queue = queue;
+}
+
+/*!
+ *    @brief  Write a buffer or two without waiting. Without a queue, with
+ * software SPI or a buffer longer than the queue takes, this is write()
+ * followed by the completion
+ *    @param  buffer Pointer to buffer of data to write, valid until done
+ *    @param  len Number of bytes from buffer to write
+ *    @param  prefix_buffer Pointer to optional array of data to write before
+ * buffer, valid until done
+ *    @param  prefix_len Number of bytes from prefix buffer to write
+ *    @param  callback Called when done, from the transport interrupt
+ *    @param  context Passed to callback
+ *    @param  done Set false now and true when done, or NULL
+ *    @return False if the queue is full and this runs from a completion
+ * callback, which cannot wait. Otherwise true, as there's no way to test
+ * success of SPI writes
+ */
+bool Adafruit_SPIDevice::writeAsync(const uint8_t *buffer, size_t len,
+                                    const uint8_t *prefix_buffer,
+                                    size_t prefix_len,
+                                    BusIO_SPICallback callback, void *context,
+                                    volatile bool *done) {
+  if (_queue && _spi && len <= _queue->maxLength() &&
+      prefix_len <= _queue->maxLength()) {
+    while (!_queue->submit(this, prefix_buffer, prefix_len, buffer, NULL, len,
+                           0xFF, callback, context, done)) {
+      if (!_queue->flush()) { // full, and a callback cannot wait
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (!write(buffer, len, prefix_buffer, prefix_len)) {
+    return false;
+  }
+  if (done) {
+    *done = true;
+  }
+  if (callback) {
+    callback(context);
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Send and receive a buffer in place without waiting, like
+ * write_and_read(). Falls back to it as writeAsync() does
+ *    @param  buffer The buffer to send and receive into, valid until done
+ *    @param  len The number of bytes to transfer
+ *    @param  callback Called when done, from the transport interrupt
+ *    @param  context Passed to callback
+ *    @param  done Set false now and true when done, or NULL
+ *    @return False if the queue is full and this runs from a completion
+ * callback, which cannot wait. Otherwise true, as there's no way to test
+ * success of SPI writes
+ */
+bool Adafruit_SPIDevice::transferAsync(uint8_t *buffer, size_t len,
+                                       BusIO_SPICallback callback,
+                                       void *context, volatile bool *done) {
+  if (_queue && _spi && len <= _queue->maxLength()) {
+    while (!_queue->submit(this, NULL, 0, buffer, buffer, len, 0xFF, callback,
+                           context, done)) {
+      if (!_queue->flush()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (!write_and_read(buffer, len)) {
+    return false;
+  }
+  if (done) {
+    *done = true;
+  }
+  if (callback) {
+    callback(context);
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Take the bus and assert chip select for a queued transfer.
+ * Runs from the transport interrupt for every job but the first. On the
+ * SAMD core beginTransaction() and endTransaction() do not wait, but
+ * with SPI.usingInterrupt() of a non-EIC interrupt they would leave
+ * interrupts off when the handler returns, so do not use that on a bus
+ * with a queue
+ */
+void Adafruit_SPIDevice::select(void) {
+  if (_spi) {
+    _spi->beginTransaction(*_spiSetting);
+  }
+  setChipSelect(LOW);
+}
+
+/*!
+ *    @brief  Release chip select and the bus after a queued transfer
+ */
+void Adafruit_SPIDevice::deselect(void) {
+  setChipSelect(HIGH);
+  if (_spi) {
+    _spi->endTransaction();
+  }
+}
+
 void Adafruit_SPIDevice::setChipSelect(int value) {
   if (_cs == -1)
     return;
@@ -8,6 +8,8 @@
 
 #include <SPI.h>
 
+#include "Adafruit_SPIQueue.h"
+
 // some modern SPI definitions don't have BitOrder enum
 #if (defined(__AVR__) && !defined(ARDUINO_ARCH_MEGAAVR)) ||                    \
     defined(ESP8266) || defined(TEENSYDUINO) || defined(SPARK) ||              \
@@ -63,7 +65,7 @@ typedef uint32_t BusIO_PortMask;
 #endif
 
 /**! The class which defines how we will talk to this device over SPI **/
-class Adafruit_SPIDevice {
+class Adafruit_SPIDevice : public Adafruit_SPIEndpoint {
 public:
   Adafruit_SPIDevice(int8_t cspin, uint32_t freq = 1000000,
                      BusIOBitOrder dataOrder = SPI_BITORDER_MSBFIRST,
@@ -86,12 +88,24 @@ public:
 
   uint8_t transfer(uint8_t send);
   void transfer(uint8_t *buffer, size_t len);
-  void beginTransaction(void);
+  bool beginTransaction(void);
   void endTransaction(void);
 
+  void setQueue(Adafruit_SPIQueue *queue);
+  bool writeAsync(const uint8_t *buffer, size_t len,
+                  const uint8_t *prefix_buffer = NULL, size_t prefix_len = 0,
+                  BusIO_SPICallback callback = NULL, void *context = NULL,
+                  volatile bool *done = NULL);
+  bool transferAsync(uint8_t *buffer, size_t len,
+                     BusIO_SPICallback callback = NULL, void *context = NULL,
+                     volatile bool *done = NULL);
+  void select(void);
+  void deselect(void);
+
 private:
   SPIClass *_spi;
   SPISettings *_spiSetting;
+  Adafruit_SPIQueue *_queue = NULL;
   uint32_t _freq;
   BusIOBitOrder _dataOrder;
   uint8_t _dataMode;
@@ -0,0 +1,134 @@
+#include "Adafruit_SPIQueue.h"
+
+/*!
+ *    @brief  Create an empty queue in front of a transport
+ *    @param  transport The transport that moves the bytes
+ */
+Adafruit_SPIQueue::Adafruit_SPIQueue(Adafruit_SPITransport *transport)
+    : _transport(transport), _head(0), _count(0), _prefixDone(false),
+      _inCallback(false) {
+  transport->_queue = this;
+}
+
+/*!
+ *    @brief  Queue a transfer, starting it at once if the bus is free
+ *    @param  device The device to select around the transfer
+ *    @param  prefix Bytes sent first, e.g. a register address, or NULL
+ *    @param  prefix_len Number of prefix bytes
+ *    @param  tx Bytes to send after the prefix, or NULL to send fill
+ *    @param  rx Where the bytes received during tx go, or NULL
+ *    @param  len Number of bytes after the prefix
+ *    @param  fill The byte sent when tx is NULL
+ *    @param  callback Called from the transport interrupt when done
+ *    @param  context Passed to callback
+ *    @param  done Set false now and true when done, or NULL
+ *    @return False if the queue is full or a length is out of range
+ */
+bool Adafruit_SPIQueue::submit(Adafruit_SPIEndpoint *device,
+                               const uint8_t *prefix, size_t prefix_len,
+                               const uint8_t *tx, uint8_t *rx, size_t len,
+                               uint8_t fill, BusIO_SPICallback callback,
+                               void *context, volatile bool *done) {
+  if ((len == 0 && prefix_len == 0) || len > maxLength() ||
+      prefix_len > maxLength()) {
+    return false;
+  }
+
+  BUSIO_CRITICAL_BEGIN();
+  if (_count == BUSIO_SPI_QUEUE_DEPTH) {
+    BUSIO_CRITICAL_END();
+    return false;
+  }
+  Job &job = _jobs[(_head + _count) % BUSIO_SPI_QUEUE_DEPTH];
+  job.device = device;
+  job.prefix = prefix;
+  job.prefix_len = prefix_len;
+  job.tx = tx;
+  job.rx = rx;
+  job.len = len;
+  job.fill = fill;
+  job.callback = callback;
+  job.context = context;
+  job.done = done;
+  if (done) {
+    *done = false;
+  }
+  bool first = ++_count == 1;
+  BUSIO_CRITICAL_END();
+
+  // The bus was free, so no completion can race with this
+  if (first) {
+    startJob();
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Called by the transport when the bytes of start() have been
+ * clocked. Moves on to the next segment or job. It must not be preempted
+ * by submit(): call it from the transport interrupt, or from the thread
+ * that submits
+ */
+void Adafruit_SPIQueue::complete(void) {
+  Job &job = _jobs[_head];
+  if (!_prefixDone) {
+    _prefixDone = true;
+    if (job.len) {
+      startSegment();
+      return;
+    }
+  }
+  job.device->deselect();
+
+  BusIO_SPICallback callback = job.callback;
+  void *context = job.context;
+  volatile bool *done = job.done;
+  _head = (_head + 1) % BUSIO_SPI_QUEUE_DEPTH;
+  _count--;
+
+  // Start the next job before the callback, which may submit another
+  if (_count) {
+    startJob();
+  }
+  if (done) {
+    *done = true;
+  }
+  if (callback) {
+    _inCallback = true;
+    callback(context);
+    _inCallback = false;
+  }
+}
+
+/*!
+ *    @brief  Wait until every queued job has completed. Call it from the
+ * main context only: in an interrupt the transport interrupt that moves
+ * the queue on cannot run, and the wait would never end
+ *    @return False, without waiting, when called from a completion
+ * callback
+ */
+bool Adafruit_SPIQueue::flush(void) {
+  if (_inCallback) {
+    return false;
+  }
+  while (_count) {
+    _transport->poll();
+  }
+  return true;
+}
+
+void Adafruit_SPIQueue::startJob(void) {
+  Job &job = _jobs[_head];
+  job.device->select();
+  _prefixDone = job.prefix_len == 0;
+  startSegment();
+}
+
+void Adafruit_SPIQueue::startSegment(void) {
+  Job &job = _jobs[_head];
+  if (!_prefixDone) {
+    _transport->start(job.prefix, NULL, job.prefix_len, job.fill);
+  } else {
+    _transport->start(job.tx, job.rx, job.len, job.fill);
+  }
+}
@@ -0,0 +1,126 @@
+#ifndef Adafruit_SPIQueue_h
+#define Adafruit_SPIQueue_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Jobs that can wait behind the one on the bus
+#ifndef BUSIO_SPI_QUEUE_DEPTH
+#define BUSIO_SPI_QUEUE_DEPTH 4
+#endif
+
+// submit() runs in the main context and complete() in an interrupt; the
+// queue indices are only touched with interrupts off. Host builds run
+// both from one thread and need no lock.
+#ifndef BUSIO_CRITICAL_BEGIN
+#ifdef ARDUINO
+#include <Arduino.h>
+#define BUSIO_CRITICAL_BEGIN() noInterrupts()
+#define BUSIO_CRITICAL_END() interrupts()
+#else
+#define BUSIO_CRITICAL_BEGIN()
+#define BUSIO_CRITICAL_END()
+#endif
+#endif
+
+/*!
+ * @brief Called when an asynchronous transfer has finished, from the
+ * interrupt of the transport
+ */
+typedef void (*BusIO_SPICallback)(void *context);
+
+/*!
+ * @brief A device on the bus: what has to happen around its transfers.
+ * Every job after the first is selected, and every job deselected, from
+ * the transport interrupt, so neither may block
+ */
+class Adafruit_SPIEndpoint {
+public:
+  virtual ~Adafruit_SPIEndpoint() {}
+  /*! @brief Take the bus with the device settings and assert chip select */
+  virtual void select(void) = 0;
+  /*! @brief Release chip select and the bus */
+  virtual void deselect(void) = 0;
+};
+
+class Adafruit_SPIQueue;
+
+/*!
+ * @brief Moves bytes on the bus without the CPU, e.g. the SAMD21 DMAC.
+ * start() returns at once; the transport calls _queue->complete() once
+ * the last byte has been clocked, never from inside start()
+ */
+class Adafruit_SPITransport {
+public:
+  virtual ~Adafruit_SPITransport() {}
+  /*!
+   * @brief Begin a transfer of len bytes
+   * @param tx Bytes to send, or NULL to send fill
+   * @param rx Where the received bytes go, or NULL to drop them
+   * @param len Number of bytes, at least 1 and at most maxLength()
+   * @param fill The byte sent when tx is NULL
+   */
+  virtual void start(const uint8_t *tx, uint8_t *rx, size_t len,
+                     uint8_t fill) = 0;
+  /*! @brief Largest transfer start() takes */
+  virtual size_t maxLength(void) = 0;
+  /*! @brief Make progress while the CPU waits, for transports without an
+   * interrupt */
+  virtual void poll(void) {}
+
+protected:
+  friend class Adafruit_SPIQueue;
+  Adafruit_SPIQueue *_queue = NULL; ///< Set by the queue in front of it
+};
+
+/*!
+ * @brief Asynchronous transfers waiting for one transport, in order.
+ * Each job selects its device, sends an optional prefix then the buffer,
+ * and deselects the device before the next job starts. Buffers are not
+ * copied and must stay valid until the job completes.
+ */
+class Adafruit_SPIQueue {
+public:
+  Adafruit_SPIQueue(Adafruit_SPITransport *transport);
+
+  bool submit(Adafruit_SPIEndpoint *device, const uint8_t *prefix,
+              size_t prefix_len, const uint8_t *tx, uint8_t *rx, size_t len,
+              uint8_t fill = 0xFF, BusIO_SPICallback callback = NULL,
+              void *context = NULL, volatile bool *done = NULL);
+
+  void complete(void);
+  bool flush(void);
+
+  /*! @brief No job on the bus or waiting */
+  bool idle(void) { return _count == 0; }
+  /*! @brief Jobs on the bus or waiting */
+  uint8_t pending(void) { return _count; }
+  /*! @brief Largest buffer a job can take */
+  size_t maxLength(void) { return _transport->maxLength(); }
+
+private:
+  struct Job {
+    Adafruit_SPIEndpoint *device;
+    const uint8_t *prefix;
+    size_t prefix_len;
+    const uint8_t *tx;
+    uint8_t *rx;
+    size_t len;
+    uint8_t fill;
+    BusIO_SPICallback callback;
+    void *context;
+    volatile bool *done;
+  };
+
+  void startJob(void);
+  void startSegment(void);
+
+  Adafruit_SPITransport *_transport;
+  Job _jobs[BUSIO_SPI_QUEUE_DEPTH];
+  volatile uint8_t _head;  // job on the bus
+  volatile uint8_t _count; // including the one on the bus
+  volatile bool _prefixDone;
+  volatile bool _inCallback; // complete() is running a job's callback
+};
+
+#endif // Adafruit_SPIQueue_h
@@ -0,0 +1,21 @@
+/*
+  Host stand-in for Adafruit_I2CDevice: the register tests only use SPI
+*/
+#ifndef Adafruit_I2CDevice_h
+#define Adafruit_I2CDevice_h
+
+#include <Arduino.h>
+
+class Adafruit_I2CDevice {
+public:
+  bool write(const uint8_t *, size_t, bool = true, const uint8_t * = NULL,
+             size_t = 0) {
+    return false;
+  }
+  bool write_then_read(const uint8_t *, size_t, uint8_t *, size_t,
+                       bool = false) {
+    return false;
+  }
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*
+  Host stand-in for Adafruit_SPIDevice: a bank of 8-bit registers
+  addressed with bit 7 high to write, as on the MAX31865. Every call is
+  one chip select cycle and counts as one transaction. Bits set in
+  selfClearing[] read back as 0, like a start-conversion bit. While fail
+  is set, writes change nothing and return false.
+*/
+#ifndef Adafruit_SPIDevice_h
+#define Adafruit_SPIDevice_h
+
+#include <Arduino.h>
+#include <string.h>
+
+class Adafruit_SPIDevice {
+public:
+  Adafruit_SPIDevice() {
+    memset(regs, 0, sizeof(regs));
+    memset(selfClearing, 0, sizeof(selfClearing));
+  }
+
+  bool write(const uint8_t *buffer, size_t len,
+             const uint8_t *prefix_buffer = NULL, size_t prefix_len = 0) {
+    transactions++;
+    writes++;
+    if (fail)
+      return false;
+    uint8_t addr = prefix_len ? prefix_buffer[0] : buffer[0];
+    if (!prefix_len) {
+      buffer++;
+      len--;
+    }
+    if (!(addr & 0x80))
+      return true;
+    addr &= 0x7F;
+    for (size_t i = 0; i < len && addr + i < sizeof(regs); i++) {
+      regs[addr + i] = buffer[i] & ~selfClearing[addr + i];
+      written[addr + i] = buffer[i];
+    }
+    return true;
+  }
+
+  bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                       uint8_t *read_buffer, size_t read_len,
+                       uint8_t sendvalue = 0xFF) {
+    transactions++;
+    uint8_t addr = write_buffer[0] & 0x7F;
+    for (size_t i = 0; i < read_len; i++)
+      read_buffer[i] = addr + i < sizeof(regs) ? regs[addr + i] : 0;
+    return true;
+  }
+
+  uint8_t regs[16];
+  uint8_t selfClearing[16];
+  uint8_t written[16]; // last byte written, self-clearing bits included
+  int transactions = 0;
+  int writes = 0;
+  bool fail = false;
+};
+
+#endif
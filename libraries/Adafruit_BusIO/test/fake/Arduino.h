@@ -0,0 +1,23 @@
+/*
+  Just enough of the Arduino core for Adafruit_BusIO_Register on the host
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+#define HEX 16
+
+class Stream {
+public:
+  void print(const char *s) { fputs(s, stdout); }
+  void print(uint32_t v, int base) { printf(base == HEX ? "%X" : "%u", v); }
+  void println(void) { putchar('\n'); }
+};
+extern Stream Serial;
+
+#endif
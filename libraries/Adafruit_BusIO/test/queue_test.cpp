@@ -0,0 +1,236 @@
+/*
+  Host tests of Adafruit_SPIQueue, the hardware independent half of the
+  asynchronous SPI transfers. A fake transport stands in for the DMAC: it
+  holds each start() until poll() or step() completes it, and answers
+  every byte with its complement. Fake devices check that chip selects
+  never overlap.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "Adafruit_SPIQueue.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                 \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+static int selected = 0; // devices with chip select asserted
+static char trace[256];  // one letter per select, lower case per deselect
+
+class FakeDevice : public Adafruit_SPIEndpoint {
+public:
+  FakeDevice(char name) : name(name) {}
+  void select(void) {
+    selected++;
+    CHECK(selected == 1);
+    strncat(trace, &name, 1);
+  }
+  void deselect(void) {
+    selected--;
+    char c = name + 'a' - 'A';
+    strncat(trace, &c, 1);
+  }
+  char name;
+};
+
+class FakeTransport : public Adafruit_SPITransport {
+public:
+  void start(const uint8_t *tx, uint8_t *rx, size_t len, uint8_t fill) {
+    CHECK(!busy);
+    CHECK(selected == 1);
+    busy = true;
+    starts++;
+    bytes += len;
+    _tx = tx;
+    _rx = rx;
+    _len = len;
+    _fill = fill;
+  }
+  size_t maxLength(void) { return 64; }
+  void poll(void) { step(); }
+
+  // The interrupt: move the bytes and complete
+  bool step(void) {
+    if (!busy)
+      return false;
+    for (size_t i = 0; i < _len; i++) {
+      uint8_t out = _tx ? _tx[i] : _fill;
+      if (_rx)
+        _rx[i] = ~out;
+    }
+    busy = false;
+    _queue->complete();
+    return true;
+  }
+
+  bool busy = false;
+  int starts = 0;
+  size_t bytes = 0;
+
+private:
+  const uint8_t *_tx;
+  uint8_t *_rx;
+  size_t _len;
+  uint8_t _fill;
+};
+
+static void reset() {
+  selected = 0;
+  trace[0] = 0;
+}
+
+static int calls = 0;
+static void count(void *context) { calls += *(int *)context; }
+
+static void testPrefixAndBuffer() {
+  printf("prefix and buffer\n");
+  reset();
+  FakeTransport bus;
+  Adafruit_SPIQueue queue(&bus);
+  FakeDevice dev('A');
+
+  uint8_t addr = 0x80, data[3] = {1, 2, 3};
+  volatile bool done = true;
+  int one = 1;
+  calls = 0;
+  CHECK(queue.submit(&dev, &addr, 1, data, NULL, 3, 0xFF, count, &one, &done));
+  CHECK(!done && selected == 1 && bus.starts == 1 && queue.pending() == 1);
+
+  CHECK(bus.step()); // prefix
+  CHECK(!done && selected == 1 && bus.starts == 2);
+  CHECK(bus.step()); // buffer
+  CHECK(done && calls == 1 && selected == 0 && queue.idle());
+  CHECK(bus.bytes == 4 && !strcmp(trace, "Aa"));
+  CHECK(!bus.step());
+}
+
+static void testInPlaceTransfer() {
+  printf("in place transfer\n");
+  reset();
+  FakeTransport bus;
+  Adafruit_SPIQueue queue(&bus);
+  FakeDevice dev('A');
+
+  uint8_t buf[4] = {0x00, 0x0F, 0xF0, 0xFF};
+  CHECK(queue.submit(&dev, NULL, 0, buf, buf, 4));
+  queue.flush();
+  CHECK(buf[0] == 0xFF && buf[1] == 0xF0 && buf[2] == 0x0F && buf[3] == 0x00);
+
+  // Read only: fill goes out
+  uint8_t in[2] = {0, 0};
+  CHECK(queue.submit(&dev, NULL, 0, NULL, in, 2, 0x5A));
+  queue.flush();
+  CHECK(in[0] == 0xA5 && in[1] == 0xA5);
+}
+
+static void testOrderAndChipSelect() {
+  printf("order and chip select\n");
+  reset();
+  FakeTransport bus;
+  Adafruit_SPIQueue queue(&bus);
+  FakeDevice a('A'), b('B'), c('C');
+  uint8_t data[8] = {0};
+
+  CHECK(queue.submit(&a, data, 1, data, NULL, 8));
+  CHECK(queue.submit(&b, NULL, 0, data, NULL, 8));
+  CHECK(queue.submit(&c, data, 2, NULL, NULL, 0));
+  CHECK(queue.pending() == 3 && bus.starts == 1);
+  queue.flush();
+  CHECK(!strcmp(trace, "AaBbCc"));
+  CHECK(bus.starts == 4 && bus.bytes == 19);
+}
+
+static void testFull() {
+  printf("full queue\n");
+  reset();
+  FakeTransport bus;
+  Adafruit_SPIQueue queue(&bus);
+  FakeDevice dev('A');
+  uint8_t data[64] = {0};
+
+  for (int i = 0; i < BUSIO_SPI_QUEUE_DEPTH; i++)
+    CHECK(queue.submit(&dev, NULL, 0, data, NULL, 16));
+  CHECK(!queue.submit(&dev, NULL, 0, data, NULL, 16));
+  CHECK(bus.step());
+  CHECK(queue.submit(&dev, NULL, 0, data, NULL, 16));
+  queue.flush();
+  CHECK(bus.starts == BUSIO_SPI_QUEUE_DEPTH + 1 && queue.idle());
+
+  // Lengths the transport cannot take, or nothing to do
+  CHECK(!queue.submit(&dev, NULL, 0, data, NULL, 65));
+  CHECK(!queue.submit(&dev, NULL, 0, data, NULL, 0));
+  CHECK(queue.idle() && selected == 0);
+}
+
+// A callback that queues the next frame, as a display driver would
+struct Display {
+  Adafruit_SPIQueue *queue;
+  FakeDevice *device;
+  uint8_t frame[64];
+  int frames;
+};
+static void nextFrame(void *context) {
+  Display *d = (Display *)context;
+  if (++d->frames < 5)
+    CHECK(d->queue->submit(d->device, NULL, 0, d->frame, NULL, 64, 0xFF,
+                           nextFrame, d));
+}
+
+static void testChainedFromCallback() {
+  printf("chained from callback\n");
+  reset();
+  FakeTransport bus;
+  Adafruit_SPIQueue queue(&bus);
+  FakeDevice dev('E'), other('R');
+  Display display = {&queue, &dev, {0}, 0};
+
+  uint8_t reg[2] = {0};
+  CHECK(queue.submit(&dev, NULL, 0, display.frame, NULL, 64, 0xFF, nextFrame,
+                     &display));
+  // Something else on the bus between frames
+  CHECK(queue.submit(&other, NULL, 0, reg, reg, 2));
+  while (bus.step())
+    ;
+  CHECK(display.frames == 5 && queue.idle() && selected == 0);
+  CHECK(!strcmp(trace, "EeRrEeEeEeEe"));
+}
+
+// A callback cannot wait for the queue, the interrupt it runs in is what
+// moves the queue on
+static bool flushed = true;
+static void flushFromCallback(void *context) {
+  flushed = ((Adafruit_SPIQueue *)context)->flush();
+}
+
+static void testFlushFromCallback() {
+  printf("flush from callback\n");
+  reset();
+  FakeTransport bus;
+  Adafruit_SPIQueue queue(&bus);
+  FakeDevice dev('F');
+  uint8_t data[2] = {0};
+
+  CHECK(queue.submit(&dev, NULL, 0, data, NULL, 2, 0xFF, flushFromCallback,
+                     &queue));
+  CHECK(queue.submit(&dev, NULL, 0, data, NULL, 2));
+  CHECK(bus.step());
+  CHECK(!flushed && queue.pending() == 1);
+  CHECK(queue.flush() && queue.idle() && selected == 0);
+}
+
+int main() {
+  testPrefixAndBuffer();
+  testInPlaceTransfer();
+  testOrderAndChipSelect();
+  testFull();
+  testChainedFromCallback();
+  testFlushFromCallback();
+
+  printf(failures ? "%d FAILED\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+/*
+  Host tests of the Adafruit_BusIO_Register shadow cache and of
+  Adafruit_BusIO_RegisterBatch. The fake SPI device in fake/ counts chip
+  select cycles, so each test states how many transactions a sequence of
+  field updates costs with and without the cache.
+*/
+#include <stdio.h>
+#include "Adafruit_BusIO_Register.h"
+
+Stream Serial;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                 \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+// A MAX31865 style config register: bias, auto, 1-shot (self clearing),
+// 3-wire, fault clear (self clearing) and the 50 Hz filter
+#define CONFIG 0x00
+#define SELF_CLEARING 0x22
+
+struct Config {
+  Adafruit_SPIDevice dev;
+  Adafruit_BusIO_Register reg;
+  Adafruit_BusIO_RegisterBits bias, mode, oneshot, wires, fault, filter;
+
+  Config()
+      : reg(&dev, CONFIG, ADDRBIT8_HIGH_TOWRITE), bias(&reg, 1, 7),
+        mode(&reg, 1, 6), oneshot(&reg, 1, 5), wires(&reg, 1, 4),
+        fault(&reg, 1, 1), filter(&reg, 1, 0) {
+    dev.selfClearing[CONFIG] = SELF_CLEARING;
+  }
+
+  // The setup of one sample, field by field
+  void sample(void) {
+    fault.write(1);
+    bias.write(1);
+    oneshot.write(1);
+    bias.write(0);
+  }
+};
+
+static void testUncached(void) {
+  printf("uncached\n");
+  Config c;
+  c.sample();
+  CHECK(c.dev.transactions == 8);
+  CHECK(c.dev.regs[CONFIG] == 0x00);
+}
+
+static void testCached(void) {
+  printf("cached\n");
+  Config c;
+  c.reg.enableCache(SELF_CLEARING);
+  c.dev.regs[CONFIG] = 0x11;
+  c.sample();
+  // one read to fill the copy, then writes only
+  CHECK(c.dev.transactions == 5);
+  CHECK(c.dev.writes == 4);
+  CHECK(c.dev.regs[CONFIG] == 0x11);
+
+  // self-clearing bits read back as 0 and always reach the bus
+  CHECK(c.reg.read() == 0x11);
+  CHECK(c.oneshot.read() == 0);
+  int before = c.dev.transactions;
+  c.oneshot.write(1);
+  c.oneshot.write(1);
+  CHECK(c.dev.transactions == before + 2);
+  CHECK(c.dev.written[CONFIG] == 0x31);
+
+  // rewriting what the device holds costs nothing
+  before = c.dev.transactions;
+  c.wires.write(1);
+  c.reg.write(0x11);
+  CHECK(c.dev.transactions == before);
+
+  // after a reset of the device, the copy must be dropped
+  c.dev.regs[CONFIG] = 0;
+  c.reg.invalidateCache();
+  CHECK(c.wires.read() == 0);
+  CHECK(c.dev.transactions == before + 1);
+}
+
+static void testFailedWrite(void) {
+  printf("failed write\n");
+  Config c;
+  c.reg.enableCache(SELF_CLEARING);
+  CHECK(c.reg.write(0x80));
+  c.dev.fail = true;
+  CHECK(!c.reg.write(0x40));
+  CHECK(c.dev.regs[CONFIG] == 0x80);
+
+  // the retry must reach the device, not match the value that never got there
+  c.dev.fail = false;
+  int before = c.dev.writes;
+  CHECK(c.reg.write(0x40));
+  CHECK(c.dev.writes == before + 1);
+  CHECK(c.dev.regs[CONFIG] == 0x40);
+
+  // a field update after a failure reads the register again
+  c.dev.fail = true;
+  CHECK(!c.reg.write(0x41));
+  c.dev.fail = false;
+  before = c.dev.transactions;
+  c.bias.write(1);
+  CHECK(c.dev.transactions == before + 2);
+  CHECK(c.dev.regs[CONFIG] == 0xC0);
+}
+
+static void testBatch(void) {
+  printf("batch\n");
+  Config c;
+  c.dev.regs[CONFIG] = 0x01;
+  Adafruit_BusIO_RegisterBatch batch(&c.reg);
+  batch.write(&c.fault, 1);
+  batch.write(&c.bias, 1);
+  batch.write(&c.wires, 1);
+  batch.write(&c.bias, 0); // the later update wins
+  CHECK(c.dev.transactions == 0);
+  CHECK(batch.commit());
+  CHECK(c.dev.transactions == 2);
+  CHECK(c.dev.written[CONFIG] == 0x13);
+  CHECK(c.dev.regs[CONFIG] == 0x11);
+
+  // an empty batch stays off the bus
+  CHECK(batch.commit());
+  CHECK(c.dev.transactions == 2);
+
+  // with the cache a batch is a single write
+  c.reg.enableCache(SELF_CLEARING);
+  c.reg.read();
+  int before = c.dev.transactions;
+  batch.write(&c.fault, 1);
+  batch.write(&c.bias, 1);
+  batch.write(0x0C, 0x00);
+  CHECK(batch.commit());
+  CHECK(c.dev.transactions == before + 1);
+  CHECK(c.dev.written[CONFIG] == 0x93);
+  CHECK(c.reg.read() == 0x91);
+}
+
+int main() {
+  testUncached();
+  testCached();
+  testFailedWrite();
+  testBatch();
+  if (failures) {
+    printf("%d failed\n", failures);
+    return 1;
+  }
+  printf("all passed\n");
+  return 0;
+}
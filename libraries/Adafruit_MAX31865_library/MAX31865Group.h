@@ -0,0 +1,54 @@
+/***************************************************
+  Concurrent conversions on several MAX31865 sharing one SPI bus
+
+  One-shot: the bias of every chip is turned on together, one wait for
+  it to settle, every chip triggered, one conversion time, then every
+  result read. Sampling N sensors takes one conversion time instead of N.
+
+  Continuous: every chip runs in auto-convert mode with the bias on and
+  a result is read whenever its DRDY pin goes low, or after each
+  conversion period when no DRDY pin is wired.
+
+  BSD license, all text above must be included in any redistribution
+ ****************************************************/
+
+#ifndef MAX31865_GROUP_H
+#define MAX31865_GROUP_H
+
+#include "Adafruit_MAX31865.h"
+
+#define MAX31865_GROUP_MAX 8
+// Auto-convert period with the 50 Hz filter, the slower of the two
+#define MAX31865_AUTO_PERIOD_MS 21
+
+/*! Drives several Adafruit_MAX31865 as one */
+class MAX31865Group {
+public:
+  MAX31865Group(Adafruit_MAX31865 *const sensors[], uint8_t count,
+                const int8_t drdyPins[] = NULL);
+
+  void begin(void);
+
+  void startConversion(void);
+  bool poll(void);
+  uint16_t getRTD(uint8_t sensor);
+  void readRTD(uint16_t codes[]);
+
+  void autoConvert(bool b);
+  bool continuous(void) { return _auto; }
+  uint8_t size(void) { return _count; }
+
+private:
+  bool ready(uint8_t sensor);
+
+  Adafruit_MAX31865 *const *_sensors;
+  uint8_t _count;
+  const int8_t *_drdy;
+
+  bool _auto = false;
+  uint8_t _fresh = 0; // continuous: sensors read since the last full set
+  uint32_t _periodStart = 0;
+  uint8_t _period = MAX31865_AUTO_PERIOD_MS; // longer for the first set
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+  MAX31865Table against Callendar-Van Dusen. For each table it walks
+  every code from -200 to 850 C, solves the equation for that code in
+  double by bisection and fails if the table is further away than the
+  bound. It reports the error over the whole range and from 0 to 250 C,
+  where an espresso machine works, next to the error of the float
+  calculateTemperature() math.
+*/
+#include <math.h>
+#include <stdio.h>
+#include "Adafruit_MAX31865_Table.h"
+
+static double ratio(double t) {
+  return 1 + RTD_CVD_A * t + RTD_CVD_B * t * t +
+         (t < 0 ? RTD_CVD_C * (t - 100) * t * t * t : 0);
+}
+
+// Reference temperature in C for a code, independent of the table
+static double reference(uint16_t code, double rNominal, double rRef) {
+  double r = code * rRef / 32768 / rNominal;
+  double lo = -250, hi = 900;
+  for (int i = 0; i < 100; i++) {
+    double mid = (lo + hi) / 2;
+    (ratio(mid) < r ? lo : hi) = mid;
+  }
+  return (lo + hi) / 2;
+}
+
+// Adafruit_MAX31865::calculateTemperature(), in float as on the target
+static float adafruit(uint16_t code, float rNominal, float rRef) {
+  float Rt = code / 32768.0f * rRef;
+  float temp = (sqrtf(float(RTD_CVD_A * RTD_CVD_A - 4 * RTD_CVD_B) +
+                      float(4 * RTD_CVD_B) / rNominal * Rt) - float(RTD_CVD_A)) /
+               float(2 * RTD_CVD_B);
+  if (temp >= 0)
+    return temp;
+  Rt = Rt / rNominal * 100;
+  float rpoly = Rt;
+  temp = -242.02 + 2.2228 * rpoly;
+  rpoly *= Rt;
+  temp += 2.5859e-3 * rpoly;
+  rpoly *= Rt;
+  temp -= 4.8260e-6 * rpoly;
+  rpoly *= Rt;
+  temp -= 2.8183e-8 * rpoly;
+  rpoly *= Rt;
+  temp += 1.5243e-10 * rpoly;
+  return temp;
+}
+
+template <class Table>
+static bool check(const char *name, double rNominal, double rRef, bool fahrenheit, double bound) {
+  double worst = 0, worstHot = 0, worstFloat = 0;
+  for (uint16_t code = 0; code < 32768; code++) {
+    double c = reference(code, rNominal, rRef);
+    if (c < -200 || c > 850)
+      continue;
+    double want = (fahrenheit ? c * 9 / 5 + 32 : c) * 100;
+    double err = fabs(Table::temperature(code) - want);
+    if (err > worst)
+      worst = err;
+    if (c >= 0 && c <= 250 && err > worstHot)
+      worstHot = err;
+    double f = adafruit(code, rNominal, rRef);
+    err = fabs((fahrenheit ? f * 9 / 5 + 32 : f) * 100 - want);
+    if (err > worstFloat)
+      worstFloat = err;
+  }
+  printf("%-14s %6.2f   %6.2f   %6.2f\n", name, worst, worstHot, worstFloat);
+  return worst <= bound;
+}
+
+int main() {
+  // Bounds are in hundredths of a degree, for the whole range
+  printf("Table, Shift   -200..850  0..250  float  (0.01 deg)\n");
+  bool ok = check<MAX31865Table<1000, 4300> >("PT1000 C", 1000, 4300, false, 2);
+  ok = check<MAX31865Table<1000, 4300, true> >("PT1000 F", 1000, 4300, true, 3) && ok;
+  ok = check<MAX31865Table<100, 430> >("PT100 C", 100, 430, false, 2) && ok;
+  ok = check<MAX31865Table<100, 430, true, 7> >("PT100 F, 7", 100, 430, true, 2) && ok;
+  ok = check<MAX31865Table<1000, 4300, true, 10> >("PT1000 F, 10", 1000, 4300, true, 20) && ok;
+  return ok ? 0 : 1;
+}
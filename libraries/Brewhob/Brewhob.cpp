@@ -6,32 +6,41 @@
 #include <Arduino.h>
 #include <Brewhob.h>
 #include <Adafruit_MAX31865.h>
+#include <Adafruit_MAX31865_Table.h>
+
+//Raw RTD code to 0.01 F, built by the compiler: no sqrt or float math per sample
+typedef MAX31865Table<uint32_t(RNOMINAL), uint32_t(RREF), true> RTDTable;
+static const int8_t rtdDrdyPins[2] = {RTD1_DRDY_PIN, RTD2_DRDY_PIN};
 
 Brewhob::Brewhob()
   : sw1State_(0), //Buttons are active low, but we are storing "pressed" == 1
     sw2State_(0),
     sw3State_(0),
+    sol1State_(0),
+    sol2State_(0),
+    sol3State_(0),
+    pumpState_(0), //0-255 (0 OR 255 for AC pump)
     sw1Time_(0),
     sw2Time_(0),
     sw3Time_(0),
     temp1_(SETPOINT1),
     temp2_(SETPOINT2),
-    state_(State::STANDBY),
-    pumpState_(0), //0-255 (0 OR 255 for AC pump)
+    pidTemp_{SETPOINT1 * PID_INPUT_SCALE, SETPOINT2 * PID_INPUT_SCALE},
+    pidSetpoint_{SETPOINT1 * PID_INPUT_SCALE, SETPOINT2 * PID_INPUT_SCALE},
     manualMode_(0),
-    pumpDisabled_(0),
     power_(1),
     tea_(0),
-    sol1State_(0),
-    sol2State_(0),
-    sol3State_(0),
-    flowCount_(0),
-    flowRate_(0),
-    lastPulseTime_(0),
-    shotTimer_(0),
+    state_(State::STANDBY),
+    stateUpdatePending_(0),
+    rtdConverting_(false),
+    out_(&Serial),
+    rtdCycleStart_(0),
+    fillRaw_(0),
+    fillProbeState_(1), //initialize probe to "touching water" so as to avoid prematurely entering fill state upon startup
     fillDelayCounter_(0),
-    shotSize_(SHOT_SIZE),
-    fillProbeState_(1) //initialize probe to "touching water" so as to avoid prematurely entering fill state upon startup
+    shotTimer_(0),
+    flowCount_(0),
+    shotSize_(SHOT_SIZE)
 {
   //Initialize Pins
   pinMode(FLOW_PIN,   INPUT);
@@ -43,74 +52,79 @@ Brewhob::Brewhob()
   pinMode(SOL1_PIN,   OUTPUT);
   pinMode(SOL2_PIN,   OUTPUT);
   pinMode(SOL3_PIN,   OUTPUT);
-  pinMode(HEAT1_PIN,  OUTPUT);
-  pinMode(HEAT2_PIN,  OUTPUT);
   digitalWrite(POT_POW_PIN,HIGH);
 
   analogReadResolution(12);
 
   rtd1_ = new Adafruit_MAX31865(RTD1_PIN);
   rtd2_ = new Adafruit_MAX31865(RTD2_PIN);
+  rtds_[0] = rtd1_;
+  rtds_[1] = rtd2_;
+  rtdGroup_ = new MAX31865Group(rtds_, 2, rtdDrdyPins);
+
+  gains_[0] = gains_[1] = PIDGains{Kp, Ki, Kd};
+  PID1_ = new ScheduledPID(PID_HZ, gains_[0], SCHEDULE_TRANSITION_S * PID_HZ);
+  PID2_ = new ScheduledPID(PID_HZ, gains_[1], SCHEDULE_TRANSITION_S * PID_HZ);
+
+  PID1_->pid().setOutputRange(0,HEATER_WINDOW_MS);
+  PID2_->pid().setOutputRange(0,HEATER_WINDOW_MS);
+  PID1_->pid().setDerivative(FastPID::DERIV_ON_MEASUREMENT, PID_DERIV_FILTER_S);
+  PID2_->pid().setDerivative(FastPID::DERIV_ON_MEASUREMENT, PID_DERIV_FILTER_S);
+  PID1_->pid().setAntiWindup(PID_WINDUP);
+  PID2_->pid().setAntiWindup(PID_WINDUP);
+  if(PID_INPUT_SCALE){
+    PID1_->pid().setIntegerMode(true, PID_INPUT_SCALE);
+    PID2_->pid().setIntegerMode(true, PID_INPUT_SCALE);
+  }
+  schedule(1);
+  schedule(2);
 
-  PID1_ = new FastPID(Kp, Ki, Kd, 0.5);
-  PID2_ = new FastPID(Kp, Ki, Kd, 0.5);
-
-  PID1_->setOutputRange(0,2000);
-  PID2_->setOutputRange(0,2000);
+  heaters_ = new HeaterScheduler(HEAT1_PIN, HEAT2_PIN, HEATER_WINDOW_MS);
+  flow_ = new FlowEstimator(CC_PER_PULSE, FLOW_WINDOW, FLOW_OUTLIER_RATIO, FLOW_TIMEOUT_MS);
+  recorder_ = new ShotRecorder();
+  executor_ = new ProfileExecutor();
+  profile_.count = 0;
 
   Serial.begin(9600);
 }
 
 
 void Brewhob::printHeader(){
-  Serial.println("State\t Sw Sol RTD Setpoint FM\tTmr\tFillV Pre Dwell");
+  out_->println("State\t Sw Sol RTD Setpoint FM\tTmr\tFillV Pre Dwell");
 }
 void Brewhob::printAll(){
+  TelemetrySample s = getTelemetry();
+  log_.format(s, stateName(state_));
 
-  //print states
-  switch(state_)
-  {
-    case State::STANDBY : 
-      log_ = "STANDBY  ";
-      break;
-    case State::BREW : 
-      log_ = "BREW     ";
-      break;
-    case State::FILL : 
-      log_ = "FILL     ";
-      break;
-    case State::FILLDELAY :
-      log_ = "FILLDELAY";
-      break;
-    case State::OFF :
-      log_ = "OFF      ";
-      break;
+  if(TELEMETRY_BINARY){
+    uint8_t frame[TELEMETRY_FRAME_BYTES];
+    out_->write(frame, TelemetryFrame::encode(s, frame));
   }
-
-  log_ = log_ 
-    + sw1State_ 
-    + sw2State_
-    + sw3State_ + " "
-    + sol1State_ 
-    + sol2State_
-    + sol3State_ + " "
-    + (int)round(getRTD(1)) +  " "
-    + (int)round(getRTD(2)) +  " "
-    + setpoint1_+ " "
-    + setpoint2_+ " "
-    + flowCount_ + " "
-    + shotTimer_ + " "
-    + analogRead(FILL_IN_PIN) + " "
-    + prewet_ + " "
-    + dwell_;
-
-  Serial.println(log_);
+  else out_->println(log_.c_str());
+}
+TelemetrySample Brewhob::getTelemetry(){
+  TelemetrySample s;
+  s.ms            = millis();
+  s.state         = state_;
+  s.switches      = (sw1State_ ? 1 : 0) | (sw2State_ ? 2 : 0) | (sw3State_ ? 4 : 0);
+  s.solenoids     = (sol1State_ ? 1 : 0) | (sol2State_ ? 2 : 0) | (sol3State_ ? 4 : 0);
+  s.rtd1_x10      = round(getRTD(1) * 10);
+  s.rtd2_x10      = round(getRTD(2) * 10);
+  s.setpoint1_x10 = round(setpoint1_ * 10);
+  s.setpoint2_x10 = round(setpoint2_ * 10);
+  s.flowCount     = flowCount_;
+  s.shotTimer     = shotTimer_;
+  s.fill          = fillRaw_; //last readFill(), no conversion here
+  s.prewet        = constrain(prewet_, 0, 0xFFFF); //settings are int, the dashboard has no upper bound
+  s.dwell         = constrain(dwell_, 0, 0xFFFF);
+  return s;
 }
 
 //returns true if sensor is touching water
 int Brewhob::readFill(){
 
   int val = analogRead(FILL_IN_PIN);
+  fillRaw_ = val;
   if(val>2000) fillTally_++; //not touching water,but may want to wait to confirm this isnt noise
   else fillTally_ = 0;
 
@@ -178,8 +192,7 @@ int Brewhob::setState(){
       else if((BREW_CNTRL_ANALOG && potVal_ > 755 && flowCount_ < shotSize_) 
       || (!BREW_CNTRL_ANALOG && sw1State_ && flowCount_ < shotSize_)){ //ensure that the lever has been lowered since the last shot
         state_= State::BREW;
-        shotTimerStart_ = millis();
-        resetFM();
+        startShot();
       }
 
       else if(fillProbeState_ == 0 && STEAM_BOILER_EN){
@@ -196,6 +209,7 @@ int Brewhob::setState(){
         flowCount_ >= shotSize_){
 
         state_ = State::STANDBY;
+        executor_->stop();
 
         if(shotTimer_ > 20){
           //lastShotSpecs Here
@@ -211,8 +225,7 @@ int Brewhob::setState(){
       if(BREW_CNTRL_ANALOG && potVal_ > 755 && flowCount_ < shotSize_)
       {
         state_= State::BREW;
-        shotTimerStart_ = millis();
-        resetFM();
+        startShot();
       }
 
       else if(fillProbeState_) // now touching water, transition to fill-delay state
@@ -225,19 +238,20 @@ int Brewhob::setState(){
       if(sw1State_ && flowCount_ < shotSize_)
       {
         state_= State::BREW;
-        shotTimerStart_ = millis();
-        resetFM();
+        startShot();
       }
       else if(millis() - fillDelayCounter_ > 1000*FILL_DELAY)
       {
         state_= State::STANDBY;
       }
       break;  
+    case State::TEA : //never entered, SW2 runs hot water from the other states
+      break;
   }
 
 
   //set devices according to current state
-  Serial.println(getState());
+  out_->println(stateName(state_));
   switch(state_){
     case State::STANDBY : 
       setSolenoid(1,0);
@@ -252,25 +266,23 @@ int Brewhob::setState(){
       break;
 
     case State::BREW :
-      //Set the initial pump pressure only if the pump was previously off
-      if(pumpState_ == 0 & !BREW_CNTRL_ANALOG){
-        if(manualMode_) setPump(50);
-        else            setPump(180); 
-      }
-
-      //close fill and tea valve
-      setSolenoid(1,0);
-      setSolenoid(3,0);
-
+      //pump and valves follow the shot profile, from the timer ISR
+      if(!executor_->running()){
+        //close fill and tea valve
+        setSolenoid(1,0);
+        setSolenoid(3,0);
 
-      //Open Brew Solenoid Valve
-      if(BREW_VALVE_EN && !dwellOn_)
-        setSolenoid(2,1);
+        //Open Brew Solenoid Valve
+        if(BREW_VALVE_EN)
+          setSolenoid(2,1);
+      }
 
       if(BREW_CNTRL_ANALOG)
         setPump(map(potVal_,755,900,50,180));
 
-      if(sw2State_){
+      //the profile owns the pump and valves, tea water would count as shot
+      //volume and be cut off at the next segment; it waits for the profile
+      if(sw2State_ && !executor_->running()){
         setSolenoid(3,1);
         setPump(180);
       }
@@ -296,6 +308,10 @@ int Brewhob::setState(){
         setPump(180);
       }
 
+      break;
+    case State::OFF :
+    case State::TEA :
+      //outputs stay as they were
       break;
   }  
   return 0;
@@ -321,78 +337,133 @@ int Brewhob::setSolenoid(int solNum, int val){
 
 //if pwm is nonzero and AC_PUMP, set duty cycle to 100%
 int Brewhob::setPump(int pwm){//0-255
-  if(pumpDisabled_)          pwm = 0;
-  else if (AC_PUMP && pwm>0) pwm =255;
+  if (AC_PUMP && pwm>0) pwm =255;
   analogWrite(PUMP_PIN,pwm);
   pumpState_ = pwm;
   return 0;
 }
-int Brewhob::setManualMode(bool val){manualMode_ = val;}
-int Brewhob::setPower(bool val){power_ = val;}
+int Brewhob::setManualMode(bool val){manualMode_ = val; return 0;}
+int Brewhob::setPower(bool val){power_ = val; return 0;}
 void Brewhob::resetFM(){
   flowCount_=0;
-  lastPulseTime_ = 0;
+  flow_->reset();
 }
 void Brewhob::incrementFM(){
   flowCount_+=1;
 
-  //Always keep flowrate at 0 when not brewing
-  if(state_ != State::BREW){
-    lastPulseTime_ = 0;
-    flowRate_ = 0;
-  }
-  else{
-    //Not the first pulse measured
-    if( lastPulseTime_ != 0){
-      //Pulses per second
-      flowRate_ = 1000 / (millis() - lastPulseTime_) ;
-    }
-    lastPulseTime_ = millis();
-  }
-  
+  //Only the timestamp is taken here, the fit runs from serviceFlow()
+  if(state_ == State::BREW) flow_->pushPulse(micros());
+}
+void Brewhob::flowPulseISR(){
+  if(state_ != State::BREW) return;
+  pulseTotal_++; //volume triggers of the profile
+  //Only measure flow in the profile segments that make up the shot
+  if(executor_->running() && !executor_->extracting()) return;
+  incrementFM();
+  stateUpdatePending_ = true;
+}
+void Brewhob::switchISR(int swNum){
+  readSwitch(swNum);
+  stateUpdatePending_ = true;
+}
+void Brewhob::serviceState(){
+  if(!stateUpdatePending_) return;
+  stateUpdatePending_ = false;
+  setState();
+}
+//0.01 F from the RTD filters to PID input counts, rounded, no float
+static int16_t pidCounts(int32_t hundredths){
+  int32_t v = hundredths * PID_INPUT_SCALE;
+  return (v + (v < 0 ? -50 : 50)) / 100;
 }
 float Brewhob::readRTD(int sensorNum){
 
   if(sensorNum == 1){
     rtd1_->clearFault();
-    ADCFilter1.Filter((rtd1_->temperature(RNOMINAL, RREF))*9/5+32);
-    temp1_ = ADCFilter1.Current();
+    ADCFilter1.Filter(RTDTable::temperature(rtd1_->readRTD()));
+    temp1_ = ADCFilter1.Current() * 0.01f;
+    pidTemp_[0] = pidCounts(ADCFilter1.Current());
     return temp1_;
   }
   if(sensorNum == 2){
     rtd2_->clearFault();
-    ADCFilter2.Filter((rtd2_->temperature(RNOMINAL, RREF))*9/5+32);
-    temp2_ = ADCFilter2.Current();
+    ADCFilter2.Filter(RTDTable::temperature(rtd2_->readRTD()));
+    temp2_ = ADCFilter2.Current() * 0.01f;
+    pidTemp_[1] = pidCounts(ADCFilter2.Current());
     return temp2_;
   }
+  return -1;
+}
+//Sample both RTDs once per RTD_PERIOD_MS without blocking. Both sensors
+//settle and convert together, one conversion time for the pair, while the
+//rest of loop() runs. In continuous mode the latest pair is taken instead.
+void Brewhob::serviceRTD(){
+  if(rtdGroup_->continuous()){
+    if(!rtdGroup_->poll() || millis() - rtdCycleStart_ < RTD_PERIOD_MS) return;
+    rtdCycleStart_ = millis();
+  }
+  else if(!rtdConverting_){
+    if(millis() - rtdCycleStart_ < RTD_PERIOD_MS) return;
+    rtdCycleStart_ = millis();
+    rtdConverting_ = true;
+    rtdGroup_->startConversion();
+    return;
+  }
+  else if(!rtdGroup_->poll()) return;
+  rtdConverting_ = false;
+
+  ADCFilter1.Filter(RTDTable::temperature(rtdGroup_->getRTD(0)));
+  temp1_ = ADCFilter1.Current() * 0.01f;
+  pidTemp_[0] = pidCounts(ADCFilter1.Current());
+  ADCFilter2.Filter(RTDTable::temperature(rtdGroup_->getRTD(1)));
+  temp2_ = ADCFilter2.Current() * 0.01f;
+  pidTemp_[1] = pidCounts(ADCFilter2.Current());
 }
 float Brewhob::getRTD(int sensorNum){
   if(sensorNum == 1){
-    return ADCFilter1.Current();
+    return ADCFilter1.Current() * 0.01f;
   }
   if(sensorNum == 2){
-    return ADCFilter2.Current();
+    return ADCFilter2.Current() * 0.01f;
   }
   else
     return -1;
 }
 String Brewhob::getState(){
-  switch(state_){
-    case State::STANDBY : 
-      return "STANDBY";
-    case State::BREW : 
-      return "BREW";
-    case State::FILL : 
-      return "FILL";
-    case State::FILLDELAY :
-      return "FILLDELAY";
-    case State::OFF :
-      return "OFF";
-  }
+  return String(stateName(state_));
 }
 float Brewhob::getShotTimer(){return shotTimer_;}
 float Brewhob::getFlowCount(){return flowCount_;}
-int Brewhob::getFlowRate() {return flowRate_;}
+int Brewhob::getFlowRate() {
+  //Pulses per second
+  return getFlowRateCCs() / CC_PER_PULSE + 0.5;
+}
+float Brewhob::getFlowRateCCs() {
+  //Always keep flowrate at 0 when not brewing
+  return state_ == State::BREW ? flow_->flowRate() : 0;
+}
+void Brewhob::serviceFlow(){ flow_->update(); }
+void Brewhob::serviceRecorder(){
+  if(state_ != State::BREW){
+    //same rule as recordShotSpecs(): short pulls are not shots
+    if(recorder_->recording()) recorder_->endShot(shotTimer_ > 20);
+    return;
+  }
+
+  unsigned long elapsed = millis() - shotTimerStart_;
+  if(!recorder_->recording())
+    recorder_->startShot(shotTimerStart_, SHOT_RECORD_PERIOD_MS, round(getRTD(1) * 10));
+  if(elapsed < (unsigned long)recorder_->samples() * SHOT_RECORD_PERIOD_MS) return;
+
+  ShotSample s;
+  s.brewTemp_x10 = round(getRTD(1) * 10);
+  s.flowCount    = flowCount_;
+  s.pump         = pumpState_;
+  s.solenoids    = (sol1State_ ? 1 : 0) | (sol2State_ ? 2 : 0) | (sol3State_ ? 4 : 0);
+  s.phase        = executor_->running() ? executor_->segment() : (uint8_t)SHOT_EXTRACT;
+  recorder_->record(s);
+}
+const ShotRecorder& Brewhob::getShotRecorder(){ return *recorder_; }
 int Brewhob::getPump(){return pumpState_;}
 int Brewhob::setShotSize(int shotSize){
   shotSize_ = shotSize;
@@ -403,15 +474,101 @@ int Brewhob::getPID(int sensorNum){
   return sensorNum==1?PID1Val_:PID2Val_;
 }
 int Brewhob::readPID(int sensorNum){
+  if(sensorNum==tuneSensor_){
+    int out = tuner_.step(sensorNum==1?setpoint1_:setpoint2_, sensorNum==1?temp1_:temp2_);
+    (sensorNum==1?PID1Val_:PID2Val_) = out;
+    if(tuner_.state() == FastPIDAutotune::DONE){
+      setGains(sensorNum, tuner_.gains(AUTOTUNE_RULE));
+      tuningId_++;
+    }
+    if(tuner_.state() != FastPIDAutotune::RUNNING) tuneSensor_ = 0;
+    return out;
+  }
+  //integer inputs keep float out of the PID step, see ScheduledPID
   if(sensorNum==1){
-    PID1Val_ = PID1_->step(setpoint1_, temp1_);
+    PID1Val_ = PID_INPUT_SCALE ? PID1_->stepInt(state_, pidSetpoint_[0], pidTemp_[0])
+                               : PID1_->step(state_, setpoint1_, temp1_);
+    if(feedForward_) return constrain(PID1Val_ + getFeedForward(), 0, HEATER_WINDOW_MS);
     return PID1Val_;
   }
   else{
-    PID2Val_ = PID2_->step(setpoint2_, temp2_);
+    PID2Val_ = PID_INPUT_SCALE ? PID2_->stepInt(state_, pidSetpoint_[1], pidTemp_[1])
+                               : PID2_->step(state_, setpoint2_, temp2_);
     return PID2Val_;
   }
 }
+int Brewhob::getFeedForward(){
+  //only while the pump pushes water through the open brew valve: none
+  //during dwell or bloom, when the flowmeter is still winding down
+  if(state_ != State::BREW || !pumpState_ || !sol2State_) return 0;
+
+  float watts = flow_->flowRate() * WATER_J_PER_CC_F * (setpoint1_ - INLET_TEMP_F);
+  return constrain(watts / (BREW_BOILER_WATTAGE_KW * 1000) * HEATER_WINDOW_MS, 0, HEATER_WINDOW_MS);
+}
+void Brewhob::setFeedForward(bool enabled){ feedForward_ = enabled; }
+bool Brewhob::startAutotune(int sensorNum){
+  if(tuneSensor_ || (sensorNum != 1 && sensorNum != 2)) return false;
+  if(!tuner_.begin(PID_HZ, 0, HEATER_WINDOW_MS, AUTOTUNE_STEP_MS, AUTOTUNE_HYSTERESIS,
+                   AUTOTUNE_CYCLES, AUTOTUNE_TIMEOUT_S * PID_HZ)) return false;
+  tuneSensor_ = sensorNum;
+  return true;
+}
+void Brewhob::stopAutotune(){
+  tuner_.cancel();
+  tuneSensor_ = 0;
+}
+int Brewhob::getAutotune(){ return tuneSensor_; }
+const FastPIDAutotune& Brewhob::getAutotuner(){ return tuner_; }
+PIDGains Brewhob::getGains(int sensorNum){ return gains_[sensorNum==1?0:1]; }
+void Brewhob::setGains(int sensorNum, const PIDGains& gains){
+  //ScheduledPID blends to the new set, the output does not jump
+  gains_[sensorNum==1?0:1] = gains;
+  schedule(sensorNum);
+}
+static PIDGains scaled(const PIDGains& g, float kp, float ki, float kd){
+  return PIDGains{g.kp * kp, g.ki * ki, g.kd * kd};
+}
+void Brewhob::schedule(int sensorNum){
+  const PIDGains& g = gains_[sensorNum==1?0:1];
+  ScheduledPID* pid = sensorNum==1?PID1_:PID2_;
+
+  GainSet hold = {g, g, 0, 0};
+  if(scheduling_){
+    hold.far = scaled(g, SCHEDULE_RECOVERY_KP, SCHEDULE_RECOVERY_KI, SCHEDULE_RECOVERY_KD);
+    hold.nearError = SCHEDULE_NEAR_F;
+    hold.farError = SCHEDULE_FAR_F;
+  }
+  for(int phase = 0; phase < SCHEDULE_PHASES; phase++) pid->setGains(phase, hold);
+
+  if(scheduling_ && sensorNum == 1)
+    pid->setGains(State::BREW, scaled(g, SCHEDULE_SHOT_KP, SCHEDULE_SHOT_KI, SCHEDULE_SHOT_KD));
+}
+uint8_t Brewhob::getTuningId(){ return tuningId_; }
+void Brewhob::setScheduling(bool enabled){
+  scheduling_ = enabled;
+  schedule(1);
+  schedule(2);
+}
+void Brewhob::formatTuning(const PIDGains gains[2], TelemetryFrame& text){
+  text.clear();
+  for(int i = 0; i < 2; i++){
+    if(i) text.str(",");
+    text.fixed(round(gains[i].kp * 1000), 3).str(",");
+    text.fixed(round(gains[i].ki * 1000), 3).str(",");
+    text.fixed(round(gains[i].kd * 1000), 3);
+  }
+}
+bool Brewhob::parseTuning(const char* text, PIDGains gains[2]){
+  float v[6];
+  for(int i = 0; i < 6; i++){
+    char* end;
+    v[i] = strtod(text, &end);
+    if(end == text || v[i] < 0 || *end != (i < 5 ? ',' : 0)) return false;
+    text = end + (i < 5);
+  }
+  for(int i = 0; i < 2; i++) gains[i] = PIDGains{v[3*i], v[3*i+1], v[3*i+2]};
+  return true;
+}
 void Brewhob::readPot(){
   int val = analogRead(POT_PIN);
   ADCFilterPot.Filter(val);
@@ -426,19 +583,54 @@ void Brewhob::setTime(int time)
 */
 void Brewhob::print2digits(int number) {
   if (number < 10) {
-    Serial.print("0");
+    out_->print("0");
   }
-  Serial.print(number);
+  out_->print(number);
 }
+void Brewhob::setLog(Print* out){ out_ = out; }
 void Brewhob::setTea(bool in){ tea_ = in; }
 bool Brewhob::getTea(){ return tea_; }
 void Brewhob::enableRTD(){
   rtd1_->begin(MAX31865_2WIRE);
   rtd2_->begin(MAX31865_2WIRE);
+  rtdGroup_->begin();
+  if(RTD_CONTINUOUS) rtdGroup_->autoConvert(true);
+}
+//the profile executor shares the heater timer
+static Brewhob* tickTarget = NULL;
+static void profileTickISR(){ tickTarget->profileTick(); }
+
+bool Brewhob::enableHeaters(){
+  tickTarget = this;
+  heaters_->attachTick(profileTickISR);
+  if(heaters_->begin()) return true;
+  out_->println("Heater timer failed, heaters stay off"); //no ticks, so no pulses and no profile
+  return false;
+}
+void Brewhob::startShot(){
+  if(tuneSensor_ == 1) stopAutotune(); //the shot draws heat, the cycle would be meaningless
+  shotTimerStart_ = millis();
+  resetFM();
+  if(!BREW_CNTRL_ANALOG)
+    executor_->start(profile_.count ? profile_ : ShotProfile::infusion(prewet_, dwell_, delayPumpStart_), pulseTotal_);
+}
+void Brewhob::profileTick(){
+  if(!executor_->tick(pulseTotal_)) return;
+  const ProfileSegment& s = executor_->current();
+  setSolenoid(1, s.valves & 0x01 ? 1 : 0);
+  if(BREW_VALVE_EN) setSolenoid(2, s.valves & 0x02 ? 1 : 0);
+  setSolenoid(3, s.valves & 0x04 ? 1 : 0);
+  setPump(s.pump);
+}
+void Brewhob::setProfile(const ShotProfile& profile){ profile_ = profile; }
+uint8_t Brewhob::getProfileSegment(){ return executor_->segment(); }
+void Brewhob::setHeater(int heaterNum, int onMs){
+  heaters_->setDuty(heaterNum, onMs < 0 ? 0 : onMs);
 }
 void Brewhob::setTemp(int sensorNum, float val){
   if(sensorNum==1) setpoint1_ = val;
   if(sensorNum==2) setpoint2_ = val;
+  if(sensorNum==1 || sensorNum==2) pidSetpoint_[sensorNum - 1] = round(val * PID_INPUT_SCALE);
 }
 void Brewhob::recordShotSpecs(){
   lastShotSpecs_ = "";
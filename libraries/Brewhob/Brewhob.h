@@ -7,14 +7,28 @@
 
 #include <Arduino.h>
 #include <Adafruit_MAX31865.h>
+#include <MAX31865Group.h>
 #include <Filter.h>
 #include <FreeRTOS_SAMD21.h> //samd21
 #include <FastPID.h>
+#include <FastPIDAutotune.h>
+#include <ScheduledPID.h>
 #include "config.h"
+#include "HeaterScheduler.h"
+#include "FlowEstimator.h"
+#include "ShotRecorder.h"
+#include "TelemetryFrame.h"
+#include "ShotProfile.h"
 #include <RTCZero.h>
 #include <RTCCounter.h>
 
 
+//Printable names of Brewhob::State, in declaration order.
+//Plain string literals in flash: safe to use from interrupts, no heap.
+constexpr const char* const BREWHOB_STATE_NAMES[] = {
+  "STANDBY", "BREW", "FILL", "FILLDELAY", "OFF", "TEA"
+};
+
 //"get" functions return the current stored values. 
 //"read" functions read sensors, then store and return the new value
 //"set" functions set device states and store values. return 0 if successful.
@@ -26,7 +40,17 @@ class Brewhob
 
     enum State {STANDBY,BREW,FILL,FILLDELAY,OFF,TEA};
 
-    void printAll();
+    static constexpr const char* stateName(State state){ return BREWHOB_STATE_NAMES[state]; }
+    State getStateId() const { return state_; }
+
+    //interrupt entry points: only update volatile counters and flag the
+    //main loop, which applies the transition from serviceState()
+    void flowPulseISR();
+    void switchISR(int swNum);
+    void serviceState(); //call every loop
+
+    void printAll(); //text line, or binary frame with TELEMETRY_BINARY
+    TelemetrySample getTelemetry();
     void printHeader();
 
     void enableRTD();
@@ -43,37 +67,61 @@ class Brewhob
     void resetFM();
     void incrementFM();
     float readRTD(int sensorNum);
+    void serviceRTD(); //non-blocking, call every loop
+    void serviceFlow(); //drains flowmeter timestamps, call every loop
+    void serviceRecorder(); //samples the shot profile while brewing, call every loop
     void enableRTD(int sensorNum);
-    String getState();
+    bool enableHeaters(); //also starts the shot profile executor, false if the timer could not be configured
+    void setHeater(int heaterNum, int onMs); //on-time per HEATER_WINDOW_MS
+    String getState(); //allocates, use getStateId() where possible
     String getLastShot();
+    const ShotRecorder& getShotRecorder();
     float getRTD(int sensorNum);
     float getShotTimer();
     float getFlowCount();
-    int getFlowRate();
+    int getFlowRate(); //pulses/s
+    float getFlowRateCCs(); //cc/s
     int getPump();
     int setShotSize(int shotSize);
     int getShotSize();
     int getPID(int sensorNum);
-    int readPID(int sensorNum);
+    int getFeedForward(); //brew heater on-time added for the current flow, ms per window
+    void setFeedForward(bool enabled);
+    void setProfile(const ShotProfile& profile); //from the next shot, no segments: use prewet/dwell/delayPumpStart
+    uint8_t getProfileSegment();
+    void profileTick(); //called from the 1 ms timer ISR
+    int readPID(int sensorNum); //relay output while that boiler is autotuning
+    bool startAutotune(int sensorNum); //AUTOTUNE_RULE gains replace the PID's when it finishes
+    void stopAutotune();
+    int getAutotune(); //boiler being tuned, 0 if none
+    const FastPIDAutotune& getAutotuner();
+    PIDGains getGains(int sensorNum);
+    void setGains(int sensorNum, const PIDGains& gains);
+    void setScheduling(bool enabled); //SCHEDULE_* gain schedule, or one gain set throughout
+    uint8_t getTuningId(); //changes each time an autotune finishes
+    static void formatTuning(const PIDGains gains[2], TelemetryFrame& text);
+    static bool parseTuning(const char* text, PIDGains gains[2]);
     void readPot();
     //void setTime(int time);
     void print2digits(int number); 
+    void setLog(Print* out); //where print functions write to, Serial by default
     void setTea(bool in);
     bool getTea();
     void setTemp(int sensorNum, float val);
     void recordShotSpecs();
+    void startShot();
 
-    String                  log_;
+    TelemetryFrame          log_; //last printAll() line
     String                  lastShotSpecs_;
     int                     dwell_;
     int                     prewet_;
-    bool                    dwellOn_;
     volatile unsigned long  shotTimerStart_;
     int                     delayPumpStart_;
-    bool                    pumpDisabled_;
 
 
   private:
+    void schedule(int sensorNum); //gain schedule of one boiler from gains_
+
     volatile int            sw1State_;
     volatile int            sw2State_;
     volatile int            sw3State_;
@@ -88,23 +136,45 @@ class Brewhob
     float                   temp2_;
     float                   setpoint1_;
     float                   setpoint2_;
+    int16_t                 pidTemp_[2];     //temp1_/temp2_ and the setpoints in
+    int16_t                 pidSetpoint_[2]; //1/PID_INPUT_SCALE F, for stepInt()
     bool                    manualMode_;
     bool                    power_;
     bool                    tea_;
     volatile State          state_; //standby,brew,fill,filldelay,off
+    volatile bool           stateUpdatePending_; //set by ISRs, cleared by serviceState()
 
 
     Adafruit_MAX31865*      rtd1_;
     Adafruit_MAX31865*      rtd2_;
-
-    FastPID*                PID1_; 
-    FastPID*                PID2_; 
+    Adafruit_MAX31865*      rtds_[2];
+    MAX31865Group*          rtdGroup_; //both RTDs convert at the same time
+    bool                    rtdConverting_; //one-shot conversion of the group under way
+    Print*                  out_;
+    unsigned long           rtdCycleStart_;
+
+    HeaterScheduler*        heaters_;
+    FlowEstimator*          flow_;
+    ShotRecorder*           recorder_;
+    ProfileExecutor*        executor_;
+    ShotProfile             profile_;
+    volatile uint16_t       pulseTotal_ = 0; //flowmeter pulses, free running
+
+    ScheduledPID*           PID1_; //gains follow state_ and the error
+    ScheduledPID*           PID2_; 
     int64_t                 PID1Val_ = 0;
+    bool                    feedForward_ = FEEDFORWARD_EN;
     int64_t                 PID2Val_ = 0;
+    PIDGains                gains_[2];
+    FastPIDAutotune         tuner_;
+    int                     tuneSensor_ = 0; //boiler being tuned
+    uint8_t                 tuningId_ = 0;
+    bool                    scheduling_ = SCHEDULE_EN;
 
     float                   PowerConsumption_kWh = 0;
 
 
+    uint16_t                fillRaw_; //last fill probe reading
     int                     fillProbeState_; //touching water = 1=
     unsigned long           fillDelayCounter_;
     uint16_t                fillTally_ = 0;
@@ -114,13 +184,16 @@ class Brewhob
     volatile int            shotTimer_;
     //flowmeter data
     volatile int            flowCount_;
-    volatile int            flowRate_;
-    volatile unsigned long  lastPulseTime_;
     volatile int            shotSize_;
-    ExponentialFilter<float> ADCFilter1 = ExponentialFilter<float>(10, 72);
-    ExponentialFilter<float> ADCFilter2 = ExponentialFilter<float>(10, 72);
-    ExponentialFilter<float> ADCFilterPot = ExponentialFilter<float>(10, 0);
+    //RTDs in 0.01 F: median against glitches, then a Kalman estimate. All integer.
+    typedef FilterChain<MedianFilter<int32_t, RTD_MEDIAN_WINDOW>, KalmanFilter<int32_t> > RTDFilter;
+    RTDFilter ADCFilter1 = RTDFilter(MedianFilter<int32_t, RTD_MEDIAN_WINDOW>(7200),
+      KalmanFilter<int32_t>(RTD_PROCESS_NOISE, RTD_MEASUREMENT_NOISE, 7200));
+    RTDFilter ADCFilter2 = RTDFilter(MedianFilter<int32_t, RTD_MEDIAN_WINDOW>(7200),
+      KalmanFilter<int32_t>(RTD_PROCESS_NOISE, RTD_MEASUREMENT_NOISE, 7200));
+    typedef FilterChain<MedianFilter<int16_t, 3>, ExponentialFilter<int32_t> > PotFilter;
+    PotFilter ADCFilterPot = PotFilter(MedianFilter<int16_t, 3>(0), ExponentialFilter<int32_t>(10, 0));
     //RTCZero rtc;
 };
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -0,0 +1,119 @@
+/*
+  FlowEstimator.cpp - Flow rate from flowmeter pulse timestamps.
+*/
+
+#include <Arduino.h>
+#include "FlowEstimator.h"
+
+FlowEstimator::FlowEstimator(float ccPerPulse, uint8_t window, float outlierRatio,
+                             uint32_t timeoutMs)
+  : resetPending_(false),
+    resetUs_(0),
+    count_(0),
+    windowSize_(0),
+    ccPerPulse_(ccPerPulse),
+    outlierRatio_(outlierRatio),
+    timeoutMs_(timeoutMs),
+    rate_(0)
+{
+  setWindow(window);
+}
+
+void FlowEstimator::pushPulse(uint32_t us){
+  ring_.Push(us);
+}
+
+void FlowEstimator::update(){
+  bool changed = false;
+  uint32_t pulses[FLOW_RING_SIZE];
+  bool resetting = resetPending_;
+  uint32_t since = 0;
+  if(resetting){
+    resetPending_ = false; //before reading the time, a newer reset() then wins
+    since = resetUs_;
+    count_ = 0;
+    rate_ = 0;
+  }
+  uint16_t n = ring_.Pop(pulses, FLOW_RING_SIZE);
+
+  for(uint16_t k = 0; k < n; k++){
+    uint32_t t = pulses[k];
+    if(resetting && (int32_t)(t - since) < 0) continue; //pushed before reset()
+
+    if(count_ >= 2){
+      uint32_t interval = t - window_[count_ - 1];
+      uint32_t median = medianInterval();
+      if(interval * outlierRatio_ < median) continue; //bounce
+      if(interval > median * outlierRatio_) count_ = 0; //flow restarted
+    }
+
+    if(count_ == windowSize_){
+      memmove(window_, window_ + 1, (windowSize_ - 1) * sizeof(window_[0]));
+      count_--;
+    }
+    window_[count_++] = t;
+    changed = true;
+  }
+
+  if(changed) rate_ = fit();
+  if(count_ && micros() - window_[count_ - 1] > timeoutMs_ * 1000){
+    count_ = 0;
+    rate_ = 0;
+  }
+}
+
+//With RTOS_ENABLED the control task resets while the sensor task is in
+//update(), so the window is only ever touched from update()
+void FlowEstimator::reset(){
+  resetUs_ = micros();
+  resetPending_ = true;
+  rate_ = 0;
+}
+
+float FlowEstimator::flowRate(){ return rate_; }
+
+void FlowEstimator::setWindow(uint8_t pulses){
+  if(pulses < 2) pulses = 2;
+  if(pulses > FLOW_WINDOW_MAX) pulses = FLOW_WINDOW_MAX;
+  windowSize_ = pulses;
+  if(count_ > windowSize_){
+    memmove(window_, window_ + count_ - windowSize_, windowSize_ * sizeof(window_[0]));
+    count_ = windowSize_;
+  }
+}
+
+void FlowEstimator::setOutlierRatio(float ratio){ outlierRatio_ = ratio > 1 ? ratio : 1; }
+
+//slope of pulse number against time, in pulses/s, scaled to cc/s. Times
+//stay in us from the first pulse, summed as integers, and are scaled to
+//seconds once; single precision only, the M0+ has no FPU
+float FlowEstimator::fit(){
+  if(count_ < 2) return 0;
+
+  uint64_t sumT = 0;
+  for(uint8_t i = 0; i < count_; i++) sumT += window_[i] - window_[0];
+  float meanT = (float)sumT / count_, meanN = (count_ - 1) * 0.5f;
+
+  float sxy = 0, sxx = 0;
+  for(uint8_t i = 0; i < count_; i++){
+    float dt = (float)(window_[i] - window_[0]) - meanT;
+    sxy += dt * (i - meanN);
+    sxx += dt * dt;
+  }
+  return sxx > 0 ? sxy / sxx * 1e6f * ccPerPulse_ : 0;
+}
+
+uint32_t FlowEstimator::medianInterval(){
+  uint32_t intervals[FLOW_WINDOW_MAX];
+  if(count_ < 2) return 0;
+  uint8_t n = count_ - 1;
+  if(n > FLOW_WINDOW_MAX - 1) n = FLOW_WINDOW_MAX - 1;
+  for(uint8_t i = 0; i < n; i++){
+    //insertion sort, n is small
+    uint32_t v = window_[i + 1] - window_[i];
+    uint8_t j = i;
+    for(; j > 0 && intervals[j - 1] > v; j--) intervals[j] = intervals[j - 1];
+    intervals[j] = v;
+  }
+  return intervals[n / 2];
+}
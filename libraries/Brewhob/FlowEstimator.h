@@ -0,0 +1,57 @@
+/*
+  FlowEstimator.h - Flow rate from flowmeter pulse timestamps.
+*/
+#ifndef FlowEstimator_h
+#define FlowEstimator_h
+
+#include <Arduino.h>
+#include <SpscRing.h>
+
+#define FLOW_RING_SIZE   16 //timestamps in flight between ISR and main loop, power of two
+#define FLOW_WINDOW_MAX  32 //largest fit window, in pulses
+
+//The flowmeter ISR pushes micros() timestamps into a lock-free single
+//producer/single consumer SpscRing. update(), from the main loop, drains it
+//into a window of the last N pulses and fits volume against time by least
+//squares, which gives cc/s with far less noise than one pulse interval.
+//
+//Outliers are judged against the median interval of the window: a pulse
+//much closer than that is treated as a bounce and skipped, a gap much
+//longer means flow stopped and restarted, so the window starts over.
+class FlowEstimator
+{
+  public:
+    FlowEstimator(float ccPerPulse, uint8_t window = 8, float outlierRatio = 3,
+                  uint32_t timeoutMs = 1000);
+    ~FlowEstimator() {};
+
+    void pushPulse(uint32_t us); //ISR side, never blocks
+    void update();               //main loop side
+    void reset();                //any task, update() forgets the window
+    float flowRate();            //cc/s, 0 once no pulse arrived for timeoutMs
+
+    void setWindow(uint8_t pulses);
+    void setOutlierRatio(float ratio);
+    uint16_t dropped() { return ring_.Overflows(); } //pulses lost to a full ring
+
+  private:
+    float fit();
+    uint32_t medianInterval();
+
+    SpscRing<uint32_t, FLOW_RING_SIZE> ring_;
+
+    //reset() only asks, update() owns the window and the ring's read side
+    volatile bool           resetPending_;
+    volatile uint32_t       resetUs_;
+
+    //fit window, main loop only
+    uint32_t                window_[FLOW_WINDOW_MAX];
+    uint8_t                 count_;
+    uint8_t                 windowSize_;
+    float                   ccPerPulse_;
+    float                   outlierRatio_;
+    uint32_t                timeoutMs_;
+    float                   rate_;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*
+  HeaterScheduler.cpp - Time-proportioning heater outputs driven by a hardware timer.
+*/
+
+#include <Arduino.h>
+#include "HeaterScheduler.h"
+
+//Defines the TC3 interrupt handler, so it may only be included once.
+#include <SAMDTimerInterrupt.h>
+
+#define HEATER_TICK_US 1000
+
+static SAMDTimer heaterTimer(TIMER_TC3);
+
+HeaterScheduler* HeaterScheduler::instance_ = NULL;
+
+HeaterScheduler::HeaterScheduler(int brewPin, int steamPin, uint16_t windowMs)
+  : brewPin_(brewPin),
+    steamPin_(steamPin),
+    windowMs_(windowMs),
+    brewDuty_(0),
+    steamDuty_(0),
+    brewOn_(0),
+    steamOn_(0),
+    tick_(0),
+    tickCallback_(NULL)
+{
+  pinMode(brewPin_,  OUTPUT);
+  pinMode(steamPin_, OUTPUT);
+  digitalWrite(brewPin_,  LOW);
+  digitalWrite(steamPin_, LOW);
+}
+
+bool HeaterScheduler::begin(){
+  instance_ = this;
+  return heaterTimer.attachInterruptInterval(HEATER_TICK_US, timerISR);
+}
+
+void HeaterScheduler::setDuty(int heaterNum, uint16_t onMs){
+  if(onMs > windowMs_) onMs = windowMs_;
+  if(heaterNum == 1) brewDuty_ = onMs;
+  if(heaterNum == 2) steamDuty_ = onMs;
+}
+
+uint16_t HeaterScheduler::getDuty(int heaterNum){
+  return heaterNum == 1 ? brewDuty_ : steamDuty_;
+}
+
+void HeaterScheduler::attachTick(void (*callback)()){ tickCallback_ = callback; }
+
+void HeaterScheduler::timerISR(){
+  if(!instance_) return;
+  instance_->tick();
+  if(instance_->tickCallback_) instance_->tickCallback_();
+}
+
+void HeaterScheduler::tick(){
+  //latch new duties only at a window boundary so an update from loop()
+  //never shortens or stretches a pulse that is already running
+  if(tick_ == 0){
+    brewOn_  = brewDuty_;
+    steamOn_ = steamDuty_;
+  }
+
+  bool brew  = tick_ < brewOn_;
+  bool steam = !brew && tick_ >= windowMs_ - steamOn_;
+
+  digitalWrite(brewPin_,  brew);
+  digitalWrite(steamPin_, steam);
+
+  if(++tick_ >= windowMs_) tick_ = 0;
+}
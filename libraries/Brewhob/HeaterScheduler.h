@@ -0,0 +1,44 @@
+/*
+  HeaterScheduler.h - Time-proportioning heater outputs driven by a hardware timer.
+*/
+#ifndef HeaterScheduler_h
+#define HeaterScheduler_h
+
+#include <Arduino.h>
+
+//Owns both heater outputs. Every window of windowMs milliseconds the brew
+//heater is on for its duty at the start of the window and the steam heater
+//for its duty at the end; where the two would overlap the brew heater wins,
+//so the elements are never on together. Outputs are switched from a 1 ms
+//timer interrupt, independent of how long loop() takes. While the CPU is
+//stalled by a flash write, 2.5-6 ms per page or row, ticks are late by as
+//much and heater pulses stretch by that; the sketch writes no flash during
+//a shot.
+class HeaterScheduler
+{
+  public:
+    HeaterScheduler(int brewPin, int steamPin, uint16_t windowMs);
+    ~HeaterScheduler() {};
+
+    bool begin(); //starts the timer, returns false if it could not be configured
+    void setDuty(int heaterNum, uint16_t onMs); //takes effect at the next window
+    uint16_t getDuty(int heaterNum);
+    void tick(); //advance one millisecond, called from the timer ISR
+    void attachTick(void (*callback)()); //also run callback from the 1 ms timer ISR
+
+  private:
+    static void timerISR();
+    static HeaterScheduler* instance_;
+
+    int                     brewPin_;
+    int                     steamPin_;
+    uint16_t                windowMs_;
+    volatile uint16_t       brewDuty_; //requested on-time, ms
+    volatile uint16_t       steamDuty_;
+    uint16_t                brewOn_; //on-time latched for the current window
+    uint16_t                steamOn_;
+    uint16_t                tick_;   //ms into the current window
+    void                    (*tickCallback_)();
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+  ShotProfile.cpp - Pump and valve profiles for a shot, and their executor.
+*/
+
+#include <Arduino.h>
+#include "ShotProfile.h"
+#include "utility/CRC.h"
+
+#define BREW_VALVE 0x02 //solenoid 2
+
+static uint16_t segmentMs(int seconds){
+  if(seconds <= 0) return 0;
+  if(seconds >= PROFILE_MAX_SECONDS) return PROFILE_MAX_SECONDS * 1000;
+  return seconds * 1000;
+}
+
+ShotProfile ShotProfile::infusion(int prewet, int dwell, int delayPumpStart){
+  ShotProfile p;
+  p.count = 4;
+  p.segments[SHOT_PREWET]  = {PROFILE_TIME, segmentMs(prewet), 255, BREW_VALVE};
+  p.segments[SHOT_DWELL]   = {PROFILE_TIME, segmentMs(dwell), 255, 0};
+  p.segments[SHOT_BLOOM]   = {PROFILE_TIME, segmentMs(delayPumpStart), 0, BREW_VALVE};
+  p.segments[SHOT_EXTRACT] = {PROFILE_TIME | PROFILE_COUNTS, 0, 255, BREW_VALVE};
+  return p;
+}
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+static int hexValue(char c){
+  if(c >= '0' && c <= '9') return c - '0';
+  if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+uint8_t ShotProfile::toHex(char* hex) const {
+  uint8_t bytes[1 + 5 * PROFILE_MAX_SEGMENTS + 2];
+  uint8_t n = 0;
+  bytes[n++] = count;
+  for(uint8_t i = 0; i < count; i++){
+    const ProfileSegment& s = segments[i];
+    bytes[n++] = s.trigger;
+    bytes[n++] = s.amount & 0xFF;
+    bytes[n++] = s.amount >> 8;
+    bytes[n++] = s.pump;
+    bytes[n++] = s.valves;
+  }
+  uint16_t crc = 0;
+  for(uint8_t i = 0; i < n; i++) crc = _crc16_update(crc, bytes[i]);
+  bytes[n++] = crc & 0xFF;
+  bytes[n++] = crc >> 8;
+
+  for(uint8_t i = 0; i < n; i++){
+    hex[2 * i] = hexDigits[bytes[i] >> 4];
+    hex[2 * i + 1] = hexDigits[bytes[i] & 0x0F];
+  }
+  hex[2 * n] = 0;
+  return 2 * n;
+}
+
+bool ShotProfile::fromHex(const char* hex){
+  uint8_t bytes[1 + 5 * PROFILE_MAX_SEGMENTS + 2];
+  uint8_t n = 0;
+  for(; hex[0] && hex[1]; hex += 2){
+    int hi = hexValue(hex[0]), lo = hexValue(hex[1]);
+    if(hi < 0 || lo < 0 || n >= sizeof(bytes)) return false;
+    bytes[n++] = hi << 4 | lo;
+  }
+  if(hex[0] || n < 3 || bytes[0] > PROFILE_MAX_SEGMENTS || n != 1 + 5 * bytes[0] + 2) return false;
+
+  uint16_t crc = 0;
+  for(uint8_t i = 0; i < n - 2; i++) crc = _crc16_update(crc, bytes[i]);
+  if(bytes[n - 2] != (crc & 0xFF) || bytes[n - 1] != (crc >> 8)) return false;
+
+  bool counts = false;
+  for(uint8_t i = 0; i < bytes[0]; i++) counts |= (bytes[1 + 5 * i] & PROFILE_COUNTS) != 0;
+  if(!counts) return false;
+
+  count = bytes[0];
+  for(uint8_t i = 0; i < count; i++){
+    const uint8_t* b = bytes + 1 + 5 * i;
+    segments[i].trigger = b[0];
+    segments[i].amount  = b[1] | b[2] << 8;
+    segments[i].pump    = b[3];
+    segments[i].valves  = b[4];
+  }
+  return true;
+}
+
+ProfileExecutor::ProfileExecutor()
+  : running_(false),
+    segment_(0),
+    entered_(false),
+    elapsed_(0),
+    startPulses_(0)
+{
+  profile_.count = 0;
+}
+
+void ProfileExecutor::start(const ShotProfile& profile, uint16_t pulses){
+  //the timer ISR reads the same members, none of them volatile; with
+  //interrupts off it sees the old profile or the whole new one
+  noInterrupts();
+  running_ = false;
+  if(profile.count){
+    profile_ = profile;
+    segment_ = 0;
+    elapsed_ = 0;
+    startPulses_ = pulses;
+    entered_ = false;
+    skipEmpty();
+    running_ = true;
+  }
+  interrupts();
+}
+
+void ProfileExecutor::stop(){ running_ = false; }
+
+bool ProfileExecutor::finished(uint16_t pulses) const {
+  const ProfileSegment& s = current();
+  if((s.trigger & ~PROFILE_COUNTS) == PROFILE_VOLUME) return (uint16_t)(pulses - startPulses_) >= s.amount;
+  return elapsed_ >= s.amount;
+}
+
+//zero length segments are passed over, except the last which always holds
+void ProfileExecutor::skipEmpty(){
+  while(segment_ + 1 < profile_.count && profile_.segments[segment_].amount == 0) segment_++;
+}
+
+bool ProfileExecutor::tick(uint16_t pulses){
+  if(!running_) return false;
+  if(!entered_){
+    entered_ = true;
+    return true;
+  }
+
+  elapsed_++;
+  if(segment_ + 1 >= profile_.count || !finished(pulses)) return false;
+
+  segment_++;
+  elapsed_ = 0;
+  startPulses_ = pulses;
+  skipEmpty();
+  return true;
+}
@@ -0,0 +1,84 @@
+/*
+  ShotProfile.h - Pump and valve profiles for a shot, and their executor.
+*/
+#ifndef ShotProfile_h
+#define ShotProfile_h
+
+#include <Arduino.h>
+
+#define PROFILE_MAX_SEGMENTS 8
+
+//ProfileSegment::trigger, low bits: what ends the segment
+#define PROFILE_TIME    0x00 //amount is ms
+#define PROFILE_VOLUME  0x01 //amount is flowmeter pulses
+//flag: pulses during this segment count toward the shot size
+#define PROFILE_COUNTS  0x80
+
+#define PROFILE_MAX_SECONDS 65 //longest time segment, amount is 16 bit ms
+
+struct ProfileSegment
+{
+  uint8_t  trigger; //PROFILE_TIME or PROFILE_VOLUME, optionally | PROFILE_COUNTS
+  uint16_t amount;  //0 skips the segment
+  uint8_t  pump;    //0-255
+  uint8_t  valves;  //bit n-1 opens solenoid n
+};
+
+//Segments run in order. The last one is held until the shot ends, by the
+//lever or the shot size. A profile with no segments means "build one from
+//the prewet, dwell and pump delay settings", see infusion().
+struct ShotProfile
+{
+  uint8_t        count;
+  ProfileSegment segments[PROFILE_MAX_SEGMENTS];
+
+  //prewet -> dwell (valve closed) -> bloom (pump off) -> extraction, times
+  //in seconds, clamped to 0-PROFILE_MAX_SECONDS; unused phases have zero
+  //length so segment n is ShotPhase n
+  static ShotProfile infusion(int prewet, int dwell, int delayPumpStart);
+
+  //Compact text form for the cloud: hex of the count, 5 bytes per segment
+  //(trigger, amount little endian, pump, valves) and a CRC16 of those bytes.
+  //toHex() needs PROFILE_HEX_MAX chars, fromHex() leaves the profile
+  //untouched and returns false on anything malformed, or when no segment
+  //is PROFILE_COUNTS: the shot size could never end such a shot.
+  uint8_t toHex(char* hex) const;
+  bool fromHex(const char* hex);
+};
+
+#define PROFILE_HEX_MAX (2 * (1 + 5 * PROFILE_MAX_SEGMENTS + 2) + 1)
+
+//Segments of the profile built by ShotProfile::infusion()
+enum ShotPhase {SHOT_PREWET, SHOT_DWELL, SHOT_BLOOM, SHOT_EXTRACT};
+
+//Steps a profile once per millisecond from a timer interrupt, so segment
+//boundaries do not depend on loop() timing. start() and stop() come from
+//the main loop, tick() from the ISR.
+class ProfileExecutor
+{
+  public:
+    ProfileExecutor();
+    ~ProfileExecutor() {};
+
+    void start(const ShotProfile& profile, uint16_t pulses);
+    void stop();
+    bool tick(uint16_t pulses); //true when the outputs of current() should be applied
+
+    bool running() const { return running_; }
+    uint8_t segment() const { return segment_; }
+    const ProfileSegment& current() const { return profile_.segments[segment_]; }
+    bool extracting() const { return running_ && (current().trigger & PROFILE_COUNTS); }
+
+  private:
+    bool finished(uint16_t pulses) const;
+    void skipEmpty();
+
+    ShotProfile             profile_;
+    volatile bool           running_;
+    volatile uint8_t        segment_;
+    bool                    entered_;  //outputs of the current segment applied
+    uint16_t                elapsed_;  //ms into the current segment
+    uint16_t                startPulses_;
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*
+  ShotRecorder.cpp - Compact binary profiles of the last few shots.
+*/
+
+#include <Arduino.h>
+#include "ShotRecorder.h"
+
+#define FLOW_ESCAPE   15
+#define TEMP_ESCAPE   7
+#define OUTPUTS_FLAG  0x80
+
+static uint8_t putVarint(uint8_t* p, uint32_t v){
+  uint8_t n = 0;
+  while(v >= 0x80){
+    p[n++] = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  p[n++] = v;
+  return n;
+}
+
+static uint32_t getVarint(const uint8_t* p, uint16_t& pos){
+  uint32_t v = 0;
+  for(uint8_t shift = 0; ; shift += 7){
+    uint8_t b = p[pos++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if(!(b & 0x80)) return v;
+  }
+}
+
+static uint8_t outputsByte(const ShotSample& s){ return (s.solenoids & 0x07) | (s.phase << 3); }
+
+ShotRecorder::ShotRecorder()
+  : newest_(SHOT_RECORD_SHOTS - 1),
+    count_(0),
+    recording_(false),
+    shotId_(0)
+{
+}
+
+void ShotRecorder::startShot(uint32_t startMs, uint16_t periodMs, int16_t brewTemp_x10){
+  if(recording_) endShot(true);
+
+  newest_ = (newest_ + 1) % SHOT_RECORD_SHOTS;
+  if(count_ < SHOT_RECORD_SHOTS) count_++;
+
+  ShotHeader& h = slots_[newest_].h;
+  h.startMs = startMs;
+  h.periodMs = periodMs;
+  h.samples = 0;
+  h.bytes = 0;
+  h.brewTemp_x10 = brewTemp_x10;
+  h.truncated = 0;
+  h.version = SHOT_FORMAT_VERSION;
+
+  last_ = ShotSample();
+  last_.brewTemp_x10 = brewTemp_x10;
+  recording_ = true;
+}
+
+bool ShotRecorder::record(const ShotSample& s){
+  if(!recording_) return false;
+  Slot& slot = slots_[newest_];
+  if(slot.h.truncated) return false;
+
+  uint8_t buf[12]; //worst case: 1 + 5 + 3 + 2 
+  uint8_t n = 1;
+
+  uint16_t dFlow = s.flowCount - last_.flowCount;
+  int16_t dTemp = s.brewTemp_x10 - last_.brewTemp_x10;
+  bool outputs = s.pump != last_.pump || outputsByte(s) != outputsByte(last_);
+
+  buf[0] = 0;
+  if(dFlow < FLOW_ESCAPE) buf[0] |= dFlow;
+  else{
+    buf[0] |= FLOW_ESCAPE;
+    n += putVarint(buf + n, dFlow);
+  }
+  if(dTemp >= -3 && dTemp <= 3) buf[0] |= (dTemp + 3) << 4;
+  else{
+    buf[0] |= TEMP_ESCAPE << 4;
+    n += putVarint(buf + n, ((uint32_t)dTemp << 1) ^ (uint32_t)(dTemp >> 15)); //zigzag
+  }
+  if(outputs){
+    buf[0] |= OUTPUTS_FLAG;
+    buf[n++] = s.pump;
+    buf[n++] = outputsByte(s);
+  }
+
+  if(slot.h.bytes + n > SHOT_RECORD_BYTES){
+    slot.h.truncated = 1;
+    return false;
+  }
+  memcpy(slot.data + slot.h.bytes, buf, n);
+  slot.h.bytes += n;
+  slot.h.samples++;
+  last_ = s;
+  return true;
+}
+
+void ShotRecorder::endShot(bool keep){
+  if(!recording_) return;
+  recording_ = false;
+  if(keep){
+    shotId_++;
+    return;
+  }
+  //give the slot back, the previous shot becomes the newest again
+  newest_ = (newest_ + SHOT_RECORD_SHOTS - 1) % SHOT_RECORD_SHOTS;
+  count_--;
+}
+
+uint16_t ShotRecorder::samples() const { return recording_ ? slots_[newest_].h.samples : 0; }
+
+const ShotRecorder::Slot* ShotRecorder::slot(uint8_t age) const {
+  if(age >= count_) return NULL;
+  return &slots_[(newest_ + SHOT_RECORD_SHOTS - age) % SHOT_RECORD_SHOTS];
+}
+
+uint16_t ShotRecorder::exportSize(uint8_t age) const {
+  const Slot* s = slot(age);
+  return s ? sizeof(ShotHeader) + s->h.bytes : 0;
+}
+
+uint16_t ShotRecorder::exportChunk(uint8_t age, uint16_t offset, uint8_t* buf, uint16_t len) const {
+  uint16_t size = exportSize(age);
+  if(offset >= size) return 0;
+  if(len > size - offset) len = size - offset;
+  memcpy(buf, (const uint8_t*)slot(age) + offset, len); //header and data are contiguous
+  return len;
+}
+
+void ShotRecorder::dump(uint8_t age, Print* out) const {
+  static const char hex[] = "0123456789ABCDEF";
+  uint8_t chunk[32];
+  char line[2 * sizeof(chunk) + 1];
+  uint16_t offset = 0, n;
+  while((n = exportChunk(age, offset, chunk, sizeof(chunk))) > 0){
+    for(uint16_t i = 0; i < n; i++){
+      line[2 * i] = hex[chunk[i] >> 4];
+      line[2 * i + 1] = hex[chunk[i] & 0x0F];
+    }
+    line[2 * n] = 0;
+    out->println(line);
+    offset += n;
+  }
+}
+
+ShotReader::ShotReader(const uint8_t* blob)
+  : data_(blob + sizeof(ShotHeader)),
+    pos_(0),
+    index_(0)
+{
+  memcpy(&h_, blob, sizeof(h_));
+  last_ = ShotSample();
+  last_.brewTemp_x10 = h_.brewTemp_x10;
+}
+
+bool ShotReader::next(ShotSample& s){
+  if(index_ >= h_.samples || pos_ >= h_.bytes) return false;
+
+  uint8_t tag = data_[pos_++];
+  uint8_t flow = tag & 0x0F;
+  uint8_t temp = (tag >> 4) & 0x07;
+
+  last_.flowCount += flow == FLOW_ESCAPE ? getVarint(data_, pos_) : flow;
+  if(temp == TEMP_ESCAPE){
+    uint32_t z = getVarint(data_, pos_);
+    last_.brewTemp_x10 += (int16_t)((z >> 1) ^ -(int32_t)(z & 1));
+  }
+  else last_.brewTemp_x10 += temp - 3;
+  if(tag & OUTPUTS_FLAG){
+    last_.pump = data_[pos_++];
+    uint8_t b = data_[pos_++];
+    last_.solenoids = b & 0x07;
+    last_.phase = b >> 3;
+  }
+
+  index_++;
+  s = last_;
+  return true;
+}
+
+uint32_t ShotReader::time() const { return index_ ? (uint32_t)(index_ - 1) * h_.periodMs : 0; }
@@ -0,0 +1,101 @@
+/*
+  ShotRecorder.h - Compact binary profiles of the last few shots.
+*/
+#ifndef ShotRecorder_h
+#define ShotRecorder_h
+
+#include <Arduino.h>
+#include "config.h"
+
+#define SHOT_RECORD_BYTES 768 //encoded samples per shot, about 60 s at 10 Hz
+
+struct ShotSample
+{
+  int16_t  brewTemp_x10; //F
+  uint16_t flowCount;    //pulses since the start of the shot
+  uint8_t  pump;         //0-255
+  uint8_t  solenoids;    //bit n-1 is solenoid n
+  uint8_t  phase;        //ShotProfile segment, a ShotPhase for the default profile
+};
+
+//Exported ahead of the encoded samples, little endian
+struct __attribute__((packed)) ShotHeader
+{
+  uint32_t startMs;      //millis() when the shot started
+  uint16_t periodMs;     //between samples
+  uint16_t samples;
+  uint16_t bytes;        //of encoded samples following the header
+  int16_t  brewTemp_x10; //reference for the first temperature delta
+  uint8_t  truncated;    //buffer filled before the shot ended
+  uint8_t  version;
+};
+
+//Each sample is stored as a delta from the previous one, starting from
+//the header temperature, zero pulses and everything off. The first byte
+//holds:
+//  bits 0-3  flow pulse delta 0-14, 15: unsigned varint follows
+//  bits 4-6  temperature delta + 3 in 0.1 F (-3..+3), 7: zigzag varint follows
+//  bit 7     pump duty byte and solenoid/phase byte follow (phase < 32)
+//extra bytes follow in that order. A steady extraction costs one byte per
+//sample, so a 30 s shot at 10 Hz fits in a few hundred bytes.
+#define SHOT_FORMAT_VERSION 1
+
+//Fixed pool of the last SHOT_RECORD_SHOTS shots, newest overwrites oldest.
+//All storage is allocated with the object, nothing during a shot.
+class ShotRecorder
+{
+  public:
+    ShotRecorder();
+    ~ShotRecorder() {};
+
+    void startShot(uint32_t startMs, uint16_t periodMs, int16_t brewTemp_x10);
+    bool record(const ShotSample& sample); //false once the buffer is full
+    void endShot(bool keep);               //keep=false drops the shot
+    bool recording() const { return recording_; }
+    uint16_t samples() const;              //of the shot being recorded
+
+    uint8_t shots() const { return count_; } //stored, including one being recorded
+    uint32_t shotId() const { return shotId_; } //increments on every kept shot
+
+    //Serialized shot, ShotHeader followed by the encoded samples. age 0 is
+    //the newest. Copies up to len bytes from offset, returns the count, 0
+    //past the end, so a shot can be sent out in chunks of any size.
+    uint16_t exportSize(uint8_t age) const;
+    uint16_t exportChunk(uint8_t age, uint16_t offset, uint8_t* buf, uint16_t len) const;
+    void dump(uint8_t age, Print* out) const; //hex, one line per 32 bytes
+
+  private:
+    struct Slot
+    {
+      ShotHeader h;
+      uint8_t    data[SHOT_RECORD_BYTES];
+    };
+
+    const Slot* slot(uint8_t age) const;
+
+    Slot                    slots_[SHOT_RECORD_SHOTS];
+    uint8_t                 newest_;
+    uint8_t                 count_;
+    bool                    recording_;
+    uint32_t                shotId_;
+    ShotSample              last_;
+};
+
+//Walks the samples of an exported (or stored) shot
+class ShotReader
+{
+  public:
+    ShotReader(const uint8_t* blob); //ShotHeader followed by the samples
+    const ShotHeader& header() const { return h_; }
+    bool next(ShotSample& sample); //false after the last sample
+    uint32_t time() const;         //ms into the shot of the last sample read
+
+  private:
+    ShotHeader              h_;
+    const uint8_t*          data_;
+    uint16_t                pos_;
+    uint16_t                index_;
+    ShotSample              last_;
+};
+
+#endif
@@ -0,0 +1,105 @@
+/*
+  TelemetryFrame.cpp - Heap-free status line and binary frame for printAll().
+*/
+
+#include <Arduino.h>
+#include "TelemetryFrame.h"
+#include "utility/CRC.h"
+
+void TelemetryFrame::clear(){
+  len_ = 0;
+  buf_[0] = 0;
+}
+
+TelemetryFrame& TelemetryFrame::put(char c){
+  if(len_ < TELEMETRY_TEXT_MAX - 1){
+    buf_[len_++] = c;
+    buf_[len_] = 0;
+  }
+  return *this;
+}
+
+TelemetryFrame& TelemetryFrame::str(const char* s, uint8_t width){
+  uint8_t n = 0;
+  for(; *s; s++, n++) put(*s);
+  for(; n < width; n++) put(' ');
+  return *this;
+}
+
+TelemetryFrame& TelemetryFrame::num(long v){
+  char digits[11];
+  uint8_t n = 0;
+  unsigned long u = v < 0 ? -(unsigned long)v : v;
+  do{
+    digits[n++] = '0' + u % 10;
+    u /= 10;
+  }while(u);
+  if(v < 0) put('-');
+  while(n) put(digits[--n]);
+  return *this;
+}
+
+TelemetryFrame& TelemetryFrame::fixed(long v, uint8_t decimals){
+  long scale = 1;
+  for(uint8_t i = 0; i < decimals; i++) scale *= 10;
+  if(v < 0){
+    put('-');
+    v = -v;
+  }
+  num(v / scale);
+  if(decimals){
+    put('.');
+    long frac = v % scale;
+    for(scale /= 10; scale > 1 && frac < scale; scale /= 10) put('0');
+    num(frac);
+  }
+  return *this;
+}
+
+//rounds a x10 value to the nearest integer
+static long roundX10(long v){ return v < 0 ? (v - 5) / 10 : (v + 5) / 10; }
+
+void TelemetryFrame::format(const TelemetrySample& s, const char* stateName){
+  clear();
+  str(stateName, 9);
+  for(uint8_t i = 0; i < 3; i++) put(s.switches & (1 << i) ? '1' : '0');
+  put(' ');
+  for(uint8_t i = 0; i < 3; i++) put(s.solenoids & (1 << i) ? '1' : '0');
+  put(' ');
+  num(roundX10(s.rtd1_x10)).put(' ');
+  num(roundX10(s.rtd2_x10)).put(' ');
+  fixed(s.setpoint1_x10, 1).put(' ');
+  fixed(s.setpoint2_x10, 1).put(' ');
+  num(s.flowCount).put(' ');
+  num(s.shotTimer).put(' ');
+  num(s.fill).put(' ');
+  num(s.prewet).put(' ');
+  num(s.dwell);
+}
+
+uint8_t TelemetryFrame::encode(const TelemetrySample& s, uint8_t* frame){
+  uint8_t n = 0;
+  frame[n++] = 'B';
+  frame[n++] = 'T';
+  frame[n++] = TELEMETRY_FRAME_VERSION;
+  memcpy(frame + n, &s, sizeof(s));
+  n += sizeof(s);
+
+  uint16_t crc = 0;
+  for(uint8_t i = 0; i < n; i++) crc = _crc16_update(crc, frame[i]);
+  frame[n++] = crc & 0xFF;
+  frame[n++] = crc >> 8;
+  return n;
+}
+
+bool TelemetryFrame::decode(const uint8_t* frame, TelemetrySample& s){
+  if(frame[0] != 'B' || frame[1] != 'T' || frame[2] != TELEMETRY_FRAME_VERSION) return false;
+
+  uint8_t n = 3 + sizeof(s);
+  uint16_t crc = 0;
+  for(uint8_t i = 0; i < n; i++) crc = _crc16_update(crc, frame[i]);
+  if(frame[n] != (crc & 0xFF) || frame[n + 1] != (crc >> 8)) return false;
+
+  memcpy(&s, frame + 3, sizeof(s));
+  return true;
+}
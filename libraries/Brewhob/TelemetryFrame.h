@@ -0,0 +1,59 @@
+/*
+  TelemetryFrame.h - Heap-free status line and binary frame for printAll().
+*/
+#ifndef TelemetryFrame_h
+#define TelemetryFrame_h
+
+#include <Arduino.h>
+
+#define TELEMETRY_TEXT_MAX 96 //longest status line, including the terminator
+
+//Everything printAll() reports, taken once as integers
+struct __attribute__((packed)) TelemetrySample
+{
+  uint32_t ms;
+  uint8_t  state;         //Brewhob::State
+  uint8_t  switches;      //bit n-1 is switch n
+  uint8_t  solenoids;     //bit n-1 is solenoid n
+  int16_t  rtd1_x10;      //F
+  int16_t  rtd2_x10;
+  int16_t  setpoint1_x10;
+  int16_t  setpoint2_x10;
+  uint16_t flowCount;
+  uint16_t shotTimer;     //s
+  uint16_t fill;          //raw fill probe reading
+  uint16_t prewet;        //s
+  uint16_t dwell;         //s
+};
+
+//Binary frame: 'B' 'T' version, the sample, then the CRC16 of all bytes
+//before it (MegunoLink utility/CRC, seed 0), little endian
+#define TELEMETRY_FRAME_VERSION 1
+#define TELEMETRY_FRAME_BYTES (3 + sizeof(TelemetrySample) + 2)
+
+//Builds lines into a fixed buffer with integer formatting only. Output
+//past the end of the buffer is dropped, the line stays terminated.
+class TelemetryFrame
+{
+  public:
+    TelemetryFrame() { clear(); }
+
+    void clear();
+    TelemetryFrame& str(const char* s, uint8_t width = 0); //left aligned, padded to width
+    TelemetryFrame& num(long v);
+    TelemetryFrame& fixed(long v, uint8_t decimals); //v is scaled by 10^decimals
+    const char* c_str() const { return buf_; }
+    uint8_t length() const { return len_; }
+
+    void format(const TelemetrySample& s, const char* stateName); //the printAll() line
+    static uint8_t encode(const TelemetrySample& s, uint8_t* frame); //TELEMETRY_FRAME_BYTES
+    static bool decode(const uint8_t* frame, TelemetrySample& s);   //false on a bad frame
+
+  private:
+    TelemetryFrame& put(char c);
+
+    char                    buf_[TELEMETRY_TEXT_MAX];
+    uint8_t                 len_;
+};
+
+#endif
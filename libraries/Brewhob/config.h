@@ -15,6 +15,8 @@
 #define HEAT2_PIN 4
 #define RTD1_PIN  8
 #define RTD2_PIN  7
+#define RTD1_DRDY_PIN -1 //MAX31865 DRDY, -1 if not wired
+#define RTD2_DRDY_PIN -1
 #define POT_PIN     A4
 #define POT_POW_PIN A5
 
@@ -28,29 +30,82 @@
 #define AC_PUMP 1
 
 #define WIFI_ENABLED 1
+#ifndef RTOS_ENABLED
+#define RTOS_ENABLED 1 //run control, sensor, cloud and logging as FreeRTOS tasks
+#endif
 #define TIMEZONE_OFFSET -8
 #define TIME_ON_HOUR 8
 #define TIME_ON_MINUTE 0
+#define SETTINGS_FLASH_ROWS 8 //256 byte flash rows for the settings log, see FlashStore
 
 // The value of the Rref resistor. Use 430.0 for PT100 and 4300.0 for PT1000
 #define RREF      4300.0
 // The 'nominal' 0-degrees-C resistance of the sensor
 // 100.0 for PT100, 1000.0 for PT1000
 #define RNOMINAL  1000.0
+#define RTD_PERIOD_MS 1000 //time between the start of consecutive RTD sample cycles, each ~75 ms for both
+#ifndef RTD_CONTINUOUS
+#define RTD_CONTINUOUS 0 //1: MAX31865 auto-convert with the bias on, the latest pair every RTD_PERIOD_MS
+#endif
+#define RTD_MEDIAN_WINDOW 3 //samples; a single glitched conversion never reaches the PID
+#define RTD_MEASUREMENT_NOISE 400 //(0.01 F)^2, variance of one RTD sample, for the Kalman stage
+#define RTD_PROCESS_NOISE 400 //(0.01 F)^2, how far the boiler can drift between samples; lower is smoother but slower
+#define HEATER_WINDOW_MS 2000 //heater time-proportioning period, also the PID output range
 
 #define FILL_DELAY 1
 #define FILL_TALLY_LIM 3 //number of consecutive "low water" reads to cause a fill event 
 #define SHOT_SIZE 350
 #define CC_PER_PULSE 0.20
+#define FLOW_WINDOW 8 //pulses in the flow rate fit
+#define FLOW_OUTLIER_RATIO 3 //pulse intervals this far off the median are bounces or gaps
+#define FLOW_TIMEOUT_MS 1000 //flow rate drops to 0 after this long without a pulse
+#define SHOT_RECORD_PERIOD_MS 100 //shot profile sample period
+#define SHOT_RECORD_SHOTS 4 //shot profiles kept in RAM
+#define TELEMETRY_BINARY 0 //printAll() sends TelemetryFrame binary frames instead of text
 
 #define Kp 200 //14.4
 #define Ki 1 //0.27
 #define Kd 60 //18
+#define PID_INPUT_SCALE 10 //FastPID integer mode, temperatures in 0.1 F; 0 runs the float pipeline
+#define PID_HZ (1000.0 / HEATER_WINDOW_MS) //readPID() runs once per heater window
+#define PID_DERIV_FILTER_S 4 //D on the measurement, filtered: no kick from setpoint changes
+#define PID_WINDUP FastPID::WINDUP_BACK_CALCULATION //integral limited by the heater window
+
+//Gain schedule (ScheduledPID), factors on Kp/Ki/Kd or the autotuned gains.
+//Hold gains within SCHEDULE_NEAR_F of the setpoint, recovery gains beyond
+//SCHEDULE_FAR_F, blended in between; the brew boiler runs shot gains in BREW.
+//The integral only learns near the setpoint: what it picks up during a shot
+//or its recovery comes out later as overshoot, the boiler cools slowly.
+//A Ki factor of 0 freezes the integral, it stays in the output.
+#define SCHEDULE_EN 1
+#define SCHEDULE_TRANSITION_S 20 //gains blend over this long after a state change
+#define SCHEDULE_NEAR_F 1
+#define SCHEDULE_FAR_F 4
+#define SCHEDULE_RECOVERY_KP 1.0
+#define SCHEDULE_RECOVERY_KI 0.0
+#define SCHEDULE_RECOVERY_KD 1.0
+#define SCHEDULE_SHOT_KP 1.0 //feed-forward carries the shot load, the held integral the rest
+#define SCHEDULE_SHOT_KI 0.0
+#define SCHEDULE_SHOT_KD 1.0
 #define SETPOINT1 212
 #define SETPOINT2 260
 
+//Relay autotune (FastPIDAutotune), replaces Kp/Ki/Kd of one boiler
+#define AUTOTUNE_RULE TUNE_ZIEGLER_NICHOLS //TUNE_TYREUS_LUYBEN is gentler but settles slower on the brew boiler
+#define AUTOTUNE_STEP_MS 400 //relay swing either side of the bias, heater ms per window
+#define AUTOTUNE_HYSTERESIS 0.5 //F either side of the setpoint
+#define AUTOTUNE_CYCLES 4 //limit cycles averaged
+#define AUTOTUNE_TIMEOUT_S 7200
+#define TUNING_TEXT_MAX 72 //"kp,ki,kd,kp,ki,kd" for the brew and steam boilers
+
+//Brew heater feed-forward: while water flows through the group, add the
+//power needed to bring the same flow of inlet water up to the setpoint
+#define FEEDFORWARD_EN 1
+#define INLET_TEMP_F 68 //reservoir water
+#define WATER_J_PER_CC_F 2.3256 //specific heat of water, 4.186 J/cc/C
+
 #define DOLLARS_PER_KWH 0.1559
 #define BREW_BOILER_WATTAGE_KW 0.5
 #define STEAM_BOILER_WATTAGE_KW 1
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
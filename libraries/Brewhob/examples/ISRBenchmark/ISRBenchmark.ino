@@ -0,0 +1,94 @@
+/*
+  ISRBenchmark.ino
+
+  Measures the cost of the flowmeter interrupt path in CPU cycles.
+  Compares the old String based check (getState() == "BREW") against
+  Brewhob::flowPulseISR(), which only reads the state enum and updates
+  volatile counters.
+
+  The SAMD21 (Cortex-M0+) has no DWT cycle counter, so SysTick is used:
+  it counts down once per core clock and reloads every millisecond.
+  Interrupts are disabled around each sample so the reading is not
+  disturbed by the SysTick handler itself.
+*/
+#include "Brewhob.h"
+
+#define ITERATIONS 100
+
+Brewhob* brewhob;
+
+static inline uint32_t cyclesBetween(uint32_t start, uint32_t end){
+  uint32_t period = SysTick->LOAD + 1;
+  return (start - end + period) % period;
+}
+
+//cycles spent by the measurement itself, subtracted from every sample
+static uint32_t overhead(){
+  noInterrupts();
+  uint32_t start = SysTick->VAL;
+  uint32_t end = SysTick->VAL;
+  interrupts();
+  return cyclesBetween(start, end);
+}
+
+static void legacyFlowISR(){
+  if(brewhob->getState() == "BREW" &&
+    millis() - brewhob->shotTimerStart_ >= ( brewhob->prewet_ + brewhob->dwell_ + brewhob->delayPumpStart_ ) * 1000 ){
+    brewhob->incrementFM();
+  }
+}
+
+static void report(const char* name, void (*isr)()){
+  uint32_t base = overhead();
+  uint32_t total = 0, worst = 0;
+
+  for(int i = 0; i < ITERATIONS; i++){
+    noInterrupts();
+    uint32_t start = SysTick->VAL;
+    isr();
+    uint32_t end = SysTick->VAL;
+    interrupts();
+
+    //a sample can come in under the measured overhead, keep it at 0
+    uint32_t cycles = cyclesBetween(start, end);
+    cycles = cycles > base ? cycles - base : 0;
+    total += cycles;
+    if(cycles > worst) worst = cycles;
+  }
+
+  Serial.print(name);
+  Serial.print("\tavg ");
+  Serial.print(total / ITERATIONS);
+  Serial.print(" cycles\tmax ");
+  Serial.print(worst);
+  Serial.println(" cycles");
+}
+
+static void newFlowISR(){ brewhob->flowPulseISR(); }
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+
+  brewhob = new Brewhob();
+  brewhob->prewet_ = 0;
+  brewhob->dwell_ = 0;
+  brewhob->delayPumpStart_ = 0;
+  brewhob->setShotSize(32767);
+
+  Serial.println("-- STANDBY (pulse ignored) --");
+  report("String getState()", legacyFlowISR);
+  report("flowPulseISR()   ", newFlowISR);
+
+  //lower the brew lever to enter BREW, pulses are now counted
+  brewhob->switchISR(1);
+  brewhob->serviceState();
+  brewhob->resetFM();
+
+  Serial.println("-- BREW (pulse counted) --");
+  report("String getState()", legacyFlowISR);
+  report("flowPulseISR()   ", newFlowISR);
+}
+
+void loop() {
+}
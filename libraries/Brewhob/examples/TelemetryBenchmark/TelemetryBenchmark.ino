@@ -0,0 +1,91 @@
+/*
+  TelemetryBenchmark.ino
+
+  Measures Brewhob::printAll() in CPU cycles and heap growth. Compares the
+  old String concatenation line against the TelemetryFrame text line and
+  binary frame. Output goes to a sink that discards it, so only the
+  formatting is timed.
+
+  The String path can take longer than one SysTick period, so unlike
+  ISRBenchmark the whole run is timed with micros() and converted to
+  cycles at F_CPU; the average is what matters here. The heap high-water
+  mark is the program break (sbrk(0)): newlib never lowers it, so its growth
+  over the run is the most heap the path ever needed at once, fragmentation
+  included. The TelemetryFrame paths run first so the String path cannot
+  leave free blocks behind for them to reuse.
+*/
+#include "Brewhob.h"
+
+#define ITERATIONS 100
+
+extern "C" char* sbrk(int incr);
+
+Brewhob* brewhob;
+String legacyLog;
+
+class NullPrint : public Print{
+  public:
+    size_t write(uint8_t){ return 1; }
+    size_t write(const uint8_t*, size_t size){ return size; }
+};
+NullPrint sink;
+
+//the printAll() body before TelemetryFrame, same values
+static void legacyPrintAll(){
+  TelemetrySample s = brewhob->getTelemetry();
+  legacyLog = "STANDBY  ";
+  legacyLog = legacyLog
+    + (s.switches & 1 ? 1 : 0)
+    + (s.switches & 2 ? 1 : 0)
+    + (s.switches & 4 ? 1 : 0) + " "
+    + (s.solenoids & 1 ? 1 : 0)
+    + (s.solenoids & 2 ? 1 : 0)
+    + (s.solenoids & 4 ? 1 : 0) + " "
+    + (int)round(brewhob->getRTD(1)) +  " "
+    + (int)round(brewhob->getRTD(2)) +  " "
+    + s.setpoint1_x10 / 10.0 + " "
+    + s.setpoint2_x10 / 10.0 + " "
+    + s.flowCount + " "
+    + s.shotTimer + " "
+    + analogRead(FILL_IN_PIN) + " "
+    + s.prewet + " "
+    + s.dwell;
+  sink.println(legacyLog);
+}
+
+static void textPrintAll(){ brewhob->printAll(); }
+
+static void binaryPrintAll(){
+  uint8_t frame[TELEMETRY_FRAME_BYTES];
+  sink.write(frame, TelemetryFrame::encode(brewhob->getTelemetry(), frame));
+}
+
+static void report(const char* name, void (*print)()){
+  char* heapStart = sbrk(0);
+
+  uint32_t start = micros();
+  for(int i = 0; i < ITERATIONS; i++) print();
+  uint32_t us = micros() - start;
+
+  Serial.print(name);
+  Serial.print("\tavg ");
+  Serial.print(us * (F_CPU / 1000000) / ITERATIONS);
+  Serial.print(" cycles\theap +");
+  Serial.print(sbrk(0) - heapStart);
+  Serial.println(" bytes");
+}
+
+void setup() {
+  Serial.begin(9600);
+  while(!Serial);
+
+  brewhob = new Brewhob();
+  brewhob->setLog(&sink);
+
+  report("TelemetryFrame text  ", textPrintAll);
+  report("TelemetryFrame binary", binaryPrintAll);
+  report("String concatenation ", legacyPrintAll);
+}
+
+void loop() {
+}
@@ -0,0 +1,59 @@
+/*
+  Adafruit_SPIDevice.cpp - Host emulation of an SPI device for the Brewhob simulator.
+*/
+#include "Adafruit_SPIDevice.h"
+
+#define RTD_A 3.9083e-3
+#define RTD_B -5.775e-7
+
+SPIClass SPI;
+
+static float (*rtdSource)(int cs);
+static float rtdNominal = 1000.0;
+static float rtdRef     = 4300.0;
+static long transactions;
+
+void sim_set_rtd_source(float (*celsius)(int cs)){ rtdSource = celsius; }
+
+void sim_set_rtd_parameters(float rNominal, float rRef){
+  rtdNominal = rNominal;
+  rtdRef = rRef;
+}
+
+long sim_spi_transactions(){ return transactions; }
+
+bool Adafruit_SPIDevice::write(const uint8_t *buffer, size_t len,
+                               const uint8_t *prefix_buffer, size_t prefix_len){
+  transactions++;
+  if(len < 2 || !(buffer[0] & 0x80)) return true;
+  uint8_t addr = buffer[0] & 0x7F;
+  if(addr != 0) return true; //only the config register is writable here
+
+  regs_[0] = buffer[1] & ~0x22; //1-shot and fault-clear bits self-clear
+  if(buffer[1] & 0x02) regs_[7] = 0;
+  if((buffer[1] & 0x20) && (buffer[1] & 0x80)) convert();
+  return true;
+}
+
+bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer, size_t write_len,
+                                         uint8_t *read_buffer, size_t read_len,
+                                         uint8_t sendvalue){
+  transactions++;
+  uint8_t addr = write_buffer[0] & 0x7F;
+  if(addr == 1 && (regs_[0] & 0xC0) == 0xC0) convert(); //auto-convert: always a fresh result
+  for(size_t i = 0; i < read_len; i++)
+    read_buffer[i] = (addr + i) < sizeof(regs_) ? regs_[addr + i] : 0;
+  return true;
+}
+
+//Callendar-Van Dusen above 0C, which is all an espresso machine needs.
+void Adafruit_SPIDevice::convert(){
+  float t = rtdSource ? rtdSource(cs_) : 20.0;
+  if(t < 0) t = 0;
+  float r = rtdNominal * (1 + RTD_A * t + RTD_B * t * t);
+  long code = lround(r / rtdRef * 32768);
+  if(code > 32767) code = 32767;
+  uint16_t reg = code << 1;
+  regs_[1] = reg >> 8;
+  regs_[2] = reg & 0xFF;
+}
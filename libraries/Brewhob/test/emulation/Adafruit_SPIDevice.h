@@ -0,0 +1,59 @@
+/*
+  Adafruit_SPIDevice.h - Host emulation of an SPI device for the Brewhob simulator.
+
+  Every chip select is a MAX31865: the config register is kept per device
+  and a one-shot conversion latches the resistance of a PT1000/PT100 at the
+  temperature reported by the simulator for that chip select. Every call
+  counts as one bus transaction.
+*/
+#ifndef Adafruit_SPIDevice_h
+#define Adafruit_SPIDevice_h
+
+#include <Arduino.h>
+
+#define SPI_BITORDER_MSBFIRST 1
+#define SPI_BITORDER_LSBFIRST 0
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+typedef int BusIOBitOrder;
+class SPIClass {};
+extern SPIClass SPI;
+
+//Temperature in C seen by the RTD on a chip select
+void sim_set_rtd_source(float (*celsius)(int cs));
+//Nominal and reference resistance used to encode the RTD value
+void sim_set_rtd_parameters(float rNominal, float rRef);
+//Chip select cycles on every device since start
+long sim_spi_transactions();
+
+class Adafruit_SPIDevice
+{
+  public:
+    Adafruit_SPIDevice(int8_t cspin, uint32_t freq = 1000000,
+                       BusIOBitOrder dataOrder = SPI_BITORDER_MSBFIRST,
+                       uint8_t dataMode = SPI_MODE0, SPIClass *theSPI = &SPI)
+      : cs_(cspin) {}
+    Adafruit_SPIDevice(int8_t cspin, int8_t sck, int8_t miso, int8_t mosi,
+                       uint32_t freq = 1000000,
+                       BusIOBitOrder dataOrder = SPI_BITORDER_MSBFIRST,
+                       uint8_t dataMode = SPI_MODE0)
+      : cs_(cspin) {}
+
+    bool begin(void) { return true; }
+    bool write(const uint8_t *buffer, size_t len,
+               const uint8_t *prefix_buffer = NULL, size_t prefix_len = 0);
+    bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                         uint8_t *read_buffer, size_t read_len,
+                         uint8_t sendvalue = 0xFF);
+
+  private:
+    void convert();
+
+    int8_t  cs_;
+    uint8_t regs_[8] = {0};
+};
+
+#endif
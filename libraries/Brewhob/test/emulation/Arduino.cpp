@@ -0,0 +1,128 @@
+/*
+  Arduino.cpp - Host emulation of the Arduino core for the Brewhob simulator.
+*/
+#include "Arduino.h"
+
+#include <stdio.h>
+
+#define SIM_TICK_US   1000
+#define SIM_MAX_TIMERS 4
+
+HardwareSerial Serial;
+
+static uint64_t         now_us;
+static int              outputs[NUM_PINS];
+static int              inputs[NUM_PINS];
+static int              analogs[NUM_PINS];
+static sim_isr_t        isrs[NUM_PINS];
+static int              isrModes[NUM_PINS];
+static void             (*plantStep)(uint32_t us);
+
+static struct {
+  sim_isr_t isr;
+  uint32_t  periodUs;
+  uint64_t  nextUs;
+} timers[SIM_MAX_TIMERS];
+static int numTimers;
+
+void sim_reset(){
+  now_us = 0;
+  memset(outputs, 0, sizeof(outputs));
+  memset(inputs, 0, sizeof(inputs));
+  memset(analogs, 0, sizeof(analogs));
+  memset(isrs, 0, sizeof(isrs));
+  memset(timers, 0, sizeof(timers));
+  numTimers = 0;
+  plantStep = NULL;
+}
+
+uint64_t sim_micros(){ return now_us; }
+uint32_t millis(){ return (uint32_t)(now_us / 1000); }
+uint32_t micros(){ return (uint32_t)now_us; }
+
+//Moves time forward in SIM_TICK_US steps: hardware timers fire first, then
+//the plant advances and may toggle inputs, which fires pin interrupts.
+void sim_advance(uint32_t us){
+  uint64_t end = now_us + us;
+  while(now_us < end){
+    uint32_t step = end - now_us < SIM_TICK_US ? (uint32_t)(end - now_us) : SIM_TICK_US;
+    now_us += step;
+    for(int i = 0; i < numTimers; i++){
+      while(timers[i].nextUs <= now_us){
+        timers[i].nextUs += timers[i].periodUs;
+        timers[i].isr();
+      }
+    }
+    if(plantStep) plantStep(step);
+  }
+}
+
+void delay(uint32_t ms){ sim_advance(ms * 1000); }
+void delayMicroseconds(uint32_t us){ sim_advance(us); }
+
+void sim_set_plant_step(void (*step)(uint32_t us)){ plantStep = step; }
+
+void sim_attach_timer(uint32_t periodUs, sim_isr_t isr){
+  if(numTimers >= SIM_MAX_TIMERS || periodUs == 0) return;
+  timers[numTimers].isr = isr;
+  timers[numTimers].periodUs = periodUs;
+  timers[numTimers].nextUs = now_us + periodUs;
+  numTimers++;
+}
+
+void pinMode(int, int){}
+
+void digitalWrite(int pin, int val){
+  if(pin >= 0 && pin < NUM_PINS) outputs[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(int pin){
+  return (pin >= 0 && pin < NUM_PINS) ? inputs[pin] : LOW;
+}
+
+void analogWrite(int pin, int val){
+  if(pin >= 0 && pin < NUM_PINS) outputs[pin] = val;
+}
+
+int analogRead(int pin){
+  return (pin >= 0 && pin < NUM_PINS) ? analogs[pin] : 0;
+}
+
+int sim_output(int pin){
+  return (pin >= 0 && pin < NUM_PINS) ? outputs[pin] : 0;
+}
+
+void sim_set_analog(int pin, int val){
+  if(pin >= 0 && pin < NUM_PINS) analogs[pin] = val;
+}
+
+void sim_set_input(int pin, int val){
+  if(pin < 0 || pin >= NUM_PINS) return;
+  int old = inputs[pin];
+  inputs[pin] = val ? HIGH : LOW;
+  if(!isrs[pin] || old == inputs[pin]) return;
+
+  if(isrModes[pin] == CHANGE
+    || (isrModes[pin] == RISING  && inputs[pin] == HIGH)
+    || (isrModes[pin] == FALLING && inputs[pin] == LOW))
+    isrs[pin]();
+}
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode){
+  if(interrupt < 0 || interrupt >= NUM_PINS) return;
+  isrs[interrupt] = isr;
+  isrModes[interrupt] = mode;
+}
+
+void detachInterrupt(int interrupt){
+  if(interrupt >= 0 && interrupt < NUM_PINS) isrs[interrupt] = NULL;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max){
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len){
+  if(echo_) fwrite(buf, 1, len, stdout);
+  return len;
+}
@@ -0,0 +1,181 @@
+/*
+  Arduino.h - Host emulation of the Arduino core for the Brewhob simulator.
+
+  Time is virtual: millis()/micros() only move when the simulator advances
+  the clock (sim_advance()) or the firmware calls delay(). Pin, interrupt
+  and timer state live in Arduino.cpp where the plant model can reach them.
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0
+#define OUTPUT  1
+#define CHANGE  2
+#define FALLING 3
+#define RISING  4
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define NUM_PINS 22
+
+#define DEC 10
+#define HEX 16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define digitalPinToInterrupt(p) (p)
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int val);
+int  digitalRead(int pin);
+void analogWrite(int pin, int val);
+int  analogRead(int pin);
+inline void analogReadResolution(int) {}
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+/* Simulator side of the emulation. */
+typedef void (*sim_isr_t)();
+
+uint64_t sim_micros();                          //full width virtual clock
+void sim_advance(uint32_t us);                  //run timers/plant while moving the clock
+void sim_set_plant_step(void (*step)(uint32_t us)); //called for every tick of the clock
+void sim_attach_timer(uint32_t periodUs, sim_isr_t isr);
+int  sim_output(int pin);                       //last digitalWrite/analogWrite value
+void sim_set_input(int pin, int val);           //drives digitalRead and fires interrupts
+void sim_set_analog(int pin, int val);          //value returned by analogRead
+void sim_reset();
+
+/* Minimal Arduino String, enough for the Brewhob sketch. */
+class String
+{
+  public:
+    String() {}
+    String(const char* s) : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    String(char c) : s_(1, c) {}
+    String(int v)           : s_(std::to_string(v)) {}
+    String(unsigned int v)  : s_(std::to_string(v)) {}
+    String(long v)          : s_(std::to_string(v)) {}
+    String(unsigned long v) : s_(std::to_string(v)) {}
+    String(float v, int decimals = 2)  { format(v, decimals); }
+    String(double v, int decimals = 2) { format(v, decimals); }
+
+    const char* c_str() const { return s_.c_str(); }
+    unsigned int length() const { return s_.length(); }
+    bool operator==(const String& rhs) const { return s_ == rhs.s_; }
+    bool operator!=(const String& rhs) const { return s_ != rhs.s_; }
+    bool operator==(const char* rhs) const { return s_ == rhs; }
+    bool operator!=(const char* rhs) const { return s_ != rhs; }
+    String& operator+=(const String& rhs) { s_ += rhs.s_; return *this; }
+
+    friend String operator+(const String& lhs, const String& rhs) { return String(lhs.s_ + rhs.s_); }
+    friend String operator+(const String& lhs, const char* rhs) { return String(lhs.s_ + rhs); }
+    friend String operator+(const String& lhs, char rhs) { return lhs + String(rhs); }
+    friend String operator+(const String& lhs, int rhs) { return lhs + String(rhs); }
+    friend String operator+(const String& lhs, unsigned int rhs) { return lhs + String(rhs); }
+    friend String operator+(const String& lhs, long rhs) { return lhs + String(rhs); }
+    friend String operator+(const String& lhs, unsigned long rhs) { return lhs + String(rhs); }
+    friend String operator+(const String& lhs, float rhs) { return lhs + String(rhs); }
+    friend String operator+(const String& lhs, double rhs) { return lhs + String(rhs); }
+
+  private:
+    void format(double v, int decimals)
+    {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+      s_ = buf;
+    }
+    std::string s_;
+};
+
+/* Print, as implemented by Serial and anything the firmware logs to. */
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len)
+    {
+      size_t n = 0;
+      while(len--) n += write(*buf++);
+      return n;
+    }
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(const char* s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print((long)v, base); }
+    size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC) { return printf(base == HEX ? "%lX" : "%ld", v); }
+    size_t print(unsigned long v, int base = DEC) { return printf(base == HEX ? "%lX" : "%lu", v); }
+    size_t print(double v, int decimals = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", decimals, v); return write(b); }
+
+    size_t println() { return write("\r\n"); }
+    template <class T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template <class T> size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+  private:
+    template <class T> size_t printf(const char* fmt, T v) { char b[32]; snprintf(b, sizeof(b), fmt, v); return write(b); }
+};
+
+/* Stream, for the libraries that take one as their output. */
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/* Serial port. Output is discarded unless echo is enabled. */
+class HardwareSerial : public Print
+{
+  public:
+    void begin(unsigned long) {}
+    operator bool() const { return true; }
+    int available() { return 0; }
+    int read() { return -1; }
+
+    void setEcho(bool echo) { echo_ = echo; }
+
+    using Print::write;
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t len);
+
+  private:
+    bool echo_ = false;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,64 @@
+/*
+  ArduinoIoTCloud.h - Host emulation of the Arduino IoT Cloud for the Brewhob simulator.
+
+  Properties are plain values; the simulator writes the READWRITE ones
+  directly, the way a dashboard change would arrive through update().
+*/
+#ifndef ArduinoIoTCloud_h
+#define ArduinoIoTCloud_h
+
+#include <Arduino.h>
+
+#define SECONDS   1
+#define ON_CHANGE 0
+
+enum permissionType { READ, WRITE, READWRITE };
+
+template <class T> class CloudValue
+{
+  public:
+    CloudValue() : value_() {}
+    CloudValue(T value) : value_(value) {}
+    CloudValue& operator=(T value) { value_ = value; return *this; }
+    operator T() const { return value_; }
+  private:
+    T value_;
+};
+
+typedef CloudValue<int>           CloudCounter;
+typedef CloudValue<float>         CloudTemperatureSensor;
+typedef CloudValue<unsigned long> CloudTime;
+
+class CloudSchedule
+{
+  public:
+    bool isActive() { return active_; }
+    void setActive(bool active) { active_ = active; }
+  private:
+    bool active_ = true;
+};
+
+class ConnectionHandler {};
+
+class ArduinoIoTCloudClass
+{
+  public:
+    bool begin(ConnectionHandler&, bool = true) { return true; }
+    void update() {}
+    void printDebugInfo() {}
+    template <class T> void addProperty(T&, permissionType, int, void (*)()) {}
+};
+
+extern ArduinoIoTCloudClass ArduinoCloud;
+
+inline void setDebugMessageLevel(int) {}
+
+class Arduino_DebugUtils
+{
+  public:
+    void setDebugOutputStream(Stream*) {}
+};
+
+extern Arduino_DebugUtils Debug;
+
+#endif
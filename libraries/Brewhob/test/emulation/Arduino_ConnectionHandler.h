@@ -0,0 +1,15 @@
+/*
+  Arduino_ConnectionHandler.h - Host emulation for the Brewhob simulator.
+*/
+#ifndef Arduino_ConnectionHandler_h
+#define Arduino_ConnectionHandler_h
+
+#include <ArduinoIoTCloud.h>
+
+class WiFiConnectionHandler : public ConnectionHandler
+{
+  public:
+    WiFiConnectionHandler(const char*, const char*) {}
+};
+
+#endif
@@ -0,0 +1,6 @@
+/*
+  FreeRTOS_SAMD21.h - Empty stand-in for the Brewhob simulator, nothing from it is used on the host.
+*/
+#ifndef FreeRTOS_SAMD21_h
+#define FreeRTOS_SAMD21_h
+#endif
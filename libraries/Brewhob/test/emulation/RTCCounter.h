@@ -0,0 +1,6 @@
+/*
+  RTCCounter.h - Empty stand-in for the Brewhob simulator, nothing from it is used on the host.
+*/
+#ifndef RTCCounter_h
+#define RTCCounter_h
+#endif
@@ -0,0 +1,6 @@
+/*
+  RTCZero.h - Empty stand-in for the Brewhob simulator, nothing from it is used on the host.
+*/
+#ifndef RTCZero_h
+#define RTCZero_h
+#endif
@@ -0,0 +1,48 @@
+/*
+  SAMD21Flash.h - Host emulation of the SAMD21 program flash for the Brewhob simulator.
+
+  The area is a plain array that the simulator can clear to model an upload.
+  Writes can only clear bits and erases set a whole row to 0xff, as on the
+  chip, so FlashStore sees the same contents it would on the board.
+*/
+#ifndef SAMD21Flash_h
+#define SAMD21Flash_h
+
+#include <stdint.h>
+#include <string.h>
+#include "utility/FlashMemory.h"
+
+#define SAMD21_FLASH_AREA(Name, Rows) \
+  static uint8_t Name[(Rows) * 256] = { }
+
+class SAMD21Flash : public MLP::FlashMemory{
+  public:
+    enum { PageSize = 64, RowBytes = 256 };
+
+    SAMD21Flash(const uint8_t* area, uint32_t areaSize)
+      : area_((uint8_t*)area), rows_(areaSize / RowBytes){}
+
+    uint16_t RowCount() const { return rows_; }
+    uint16_t RowSize() const { return RowBytes; }
+
+    void Read(uint32_t offset, void* destination, uint16_t length){
+      memcpy(destination, area_ + offset, length);
+    }
+    bool Write(uint32_t offset, const void* source, uint16_t length){
+      if((offset & 3) || (length & 3) || offset + length > (uint32_t)rows_ * RowBytes) return false;
+      const uint8_t* bytes = (const uint8_t*)source;
+      for(uint16_t i = 0; i < length; i++) area_[offset + i] &= bytes[i];
+      return memcmp(area_ + offset, source, length) == 0;
+    }
+    bool EraseRow(uint16_t row){
+      if(row >= rows_) return false;
+      memset(area_ + (uint32_t)row * RowBytes, 0xff, RowBytes);
+      return true;
+    }
+
+  private:
+    uint8_t* area_;
+    uint16_t rows_;
+};
+
+#endif
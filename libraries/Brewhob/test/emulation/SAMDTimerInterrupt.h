@@ -0,0 +1,37 @@
+/*
+  SAMDTimerInterrupt.h - Host emulation of the SAMD hardware timer for the Brewhob simulator.
+*/
+#ifndef SAMDTimerInterrupt_h
+#define SAMDTimerInterrupt_h
+
+#include <Arduino.h>
+
+typedef enum
+{
+  TIMER_TC3 = 0,
+  TIMER_TCC = 1,
+  MAX_TIMER
+} SAMDTimerNumber;
+
+typedef void (*timerCallback)();
+
+class SAMDTimerInterrupt
+{
+  public:
+    SAMDTimerInterrupt(SAMDTimerNumber) {}
+
+    //interval in microseconds, run off the virtual clock
+    bool attachInterruptInterval(unsigned long interval, timerCallback callback)
+    {
+      sim_attach_timer(interval, callback);
+      return true;
+    }
+    bool setInterval(unsigned long interval, timerCallback callback)
+    {
+      return attachInterruptInterval(interval, callback);
+    }
+};
+
+typedef SAMDTimerInterrupt SAMDTimer;
+
+#endif
@@ -0,0 +1,77 @@
+/*
+  Plant.cpp - Thermal, hydraulic and flowmeter model of the espresso machine
+  driven by the Brewhob simulator.
+*/
+#include "Plant.h"
+
+#include <Arduino.h>
+#include "config.h"
+
+#define WATER_J_PER_CC_K 4.186
+#define FILL_PROBE_WET   500  //analogRead of the fill probe, Brewhob treats > 2000 as dry
+#define FILL_PROBE_DRY   3000
+
+Plant::Plant(const PlantParams& p)
+  : params(p),
+    brewC_(p.ambientC),
+    steamC_(p.ambientC),
+    steamLevel_(p.steamLevel_cc),
+    shotFlow_(0),
+    pumped_(0),
+    flowAccum_(0),
+    energyJ_(0),
+    steamWand_(false),
+    flowPin_(LOW)
+{
+}
+
+void Plant::step(uint32_t us){
+  float dt = us * 1e-6;
+
+  //heaters, element wattage from config.h
+  float brewW  = sim_output(HEAT1_PIN) ? BREW_BOILER_WATTAGE_KW  * 1000 : 0;
+  float steamW = sim_output(HEAT2_PIN) ? STEAM_BOILER_WATTAGE_KW * 1000 : 0;
+  energyJ_ += (brewW + steamW) * dt;
+
+  //hydraulics: the pump feeds whichever valves are open
+  float duty = sim_output(PUMP_PIN) / 255.0;
+  bool fill = sim_output(SOL1_PIN), brew = sim_output(SOL2_PIN), tea = sim_output(SOL3_PIN);
+
+  //flow through the puck builds up as it saturates, and stops with the
+  //valve closed (dwell) or the pump off (bloom)
+  float shotTarget = brew ? params.shotFlow_ccs * duty : 0;
+  if(shotTarget > shotFlow_) shotFlow_ += (shotTarget - shotFlow_) * dt / params.puckTau_s;
+  else shotFlow_ = shotTarget;
+
+  float fillFlow = fill ? params.pumpFlow_ccs * duty : 0;
+  float teaFlow  = tea  ? params.pumpFlow_ccs * duty : 0; //pushes hot water out of the steam boiler
+  float total    = shotFlow_ + fillFlow + teaFlow;
+
+  //brew boiler: fresh water replaces what goes to the group
+  float brewCap = params.brewMetal_JK + params.brewWater_cc * WATER_J_PER_CC_K;
+  float brewQ = brewW
+              - params.brewLoss_WK * (brewC_ - params.ambientC)
+              - shotFlow_ * WATER_J_PER_CC_K * (brewC_ - params.inletC);
+  brewC_ += brewQ * dt / brewCap;
+
+  //steam boiler: fill water mixes in, steam leaves
+  float steamCap = params.steamMetal_JK + steamLevel_ * WATER_J_PER_CC_K;
+  float steamQ = steamW
+               - params.steamLoss_WK * (steamC_ - params.ambientC)
+               - (fillFlow + teaFlow) * WATER_J_PER_CC_K * (steamC_ - params.inletC)
+               - (steamWand_ ? params.steamDraw_W : 0);
+  steamC_ += steamQ * dt / steamCap;
+  steamLevel_ += (fillFlow - (steamWand_ ? params.steamDraw_ccs : 0)) * dt;
+  if(steamLevel_ < 0) steamLevel_ = 0;
+
+  sim_set_analog(FILL_IN_PIN, steamLevel_ >= params.steamProbe_cc ? FILL_PROBE_WET : FILL_PROBE_DRY);
+
+  //flowmeter: one edge on FLOW_PIN per CC_PER_PULSE through the pump
+  pumped_ += total * dt;
+  flowAccum_ += total * dt;
+  while(flowAccum_ >= CC_PER_PULSE){
+    flowAccum_ -= CC_PER_PULSE;
+    flowPin_ = !flowPin_;
+    sim_set_input(FLOW_PIN, flowPin_);
+  }
+}
@@ -0,0 +1,63 @@
+/*
+  Plant.h - Thermal, hydraulic and flowmeter model of the espresso machine
+  driven by the Brewhob simulator.
+*/
+#ifndef Plant_h
+#define Plant_h
+
+#include <stdint.h>
+
+struct PlantParams
+{
+  float ambientC          = 22;    //room temperature
+  float inletC            = 20;    //reservoir water temperature
+
+  float brewMetal_JK      = 450;   //boiler shell and element, heat capacity
+  float brewWater_cc      = 300;   //brew boiler is always full
+  float brewLoss_WK       = 0.45;  //loss to ambient per degree
+
+  float steamMetal_JK     = 900;
+  float steamLevel_cc     = 1200;  //initial water volume
+  float steamProbe_cc     = 1100;  //fill probe touches water above this volume
+  float steamLoss_WK      = 0.8;
+
+  float pumpFlow_ccs      = 8;     //free flow of the pump at full duty (fill, tea)
+  float shotFlow_ccs      = 2;     //flow through a saturated puck at full duty
+  float puckTau_s         = 4;     //time for the puck to saturate
+  float steamDraw_ccs     = 0.5;   //water leaving as steam while the wand is open
+  float steamDraw_W       = 1200;  //heat leaving with the steam while the wand is open
+};
+
+class Plant
+{
+  public:
+    Plant(const PlantParams& params = PlantParams());
+
+    void step(uint32_t us); //advance, reading outputs and driving inputs of the emulation
+
+    float brewC() const { return brewC_; }
+    float steamC() const { return steamC_; }
+    float steamLevel() const { return steamLevel_; }
+    float shotFlow() const { return shotFlow_; }      //cc/s through the group
+    float pumpedVolume() const { return pumped_; }    //cc through the flowmeter, total
+    float energyKWh() const { return energyJ_ / 3.6e6; }
+
+    void setSteamWand(bool open) { steamWand_ = open; }
+    void setSteamLevel(float cc) { steamLevel_ = cc; }
+    void setTemperatures(float brewC, float steamC) { brewC_ = brewC; steamC_ = steamC; }
+
+    PlantParams params;
+
+  private:
+    float brewC_;
+    float steamC_;
+    float steamLevel_;
+    float shotFlow_;
+    float pumped_;
+    float flowAccum_;  //cc since the last flowmeter edge
+    double energyJ_;
+    bool  steamWand_;
+    int   flowPin_;
+};
+
+#endif
@@ -0,0 +1,212 @@
+/*
+  Simulator.cpp - Runs the unmodified Brewhob_one sketch on the host against
+  the Plant model, on a virtual clock.
+*/
+#include "Simulator.h"
+
+//The sketch, compiled as is. Defines setup(), loop() and the cloud properties.
+#include "Brewhob_one.ino"
+
+ArduinoIoTCloudClass ArduinoCloud;
+Arduino_DebugUtils   Debug;
+
+static Plant     thePlant;
+static FILE*     csv;
+static FILE*     bin;
+static uint32_t  csvPeriod, binPeriod;
+
+static void plantStep(uint32_t us){ thePlant.step(us); }
+
+static float rtdSource(int cs){
+  return cs == RTD1_PIN ? thePlant.brewC() : thePlant.steamC();
+}
+
+static TraceSample sample(){
+  TraceSample s;
+  s.t_ms          = millis();
+  s.state         = brewhob->getStateId();
+  s.outputs       = (sim_output(HEAT1_PIN) ? TRACE_HEAT1 : 0)
+                  | (sim_output(HEAT2_PIN) ? TRACE_HEAT2 : 0)
+                  | (sim_output(PUMP_PIN)  ? TRACE_PUMP  : 0)
+                  | (sim_output(SOL1_PIN)  ? TRACE_SOL1  : 0)
+                  | (sim_output(SOL2_PIN)  ? TRACE_SOL2  : 0)
+                  | (sim_output(SOL3_PIN)  ? TRACE_SOL3  : 0);
+  s.brewC_x100    = lround(thePlant.brewC() * 100);
+  s.steamC_x100   = lround(thePlant.steamC() * 100);
+  s.rtd1F_x10     = lround(brewhob->getRTD(1) * 10);
+  s.rtd2F_x10     = lround(brewhob->getRTD(2) * 10);
+  s.flowCount     = brewhob->getFlowCount();
+  s.shotFlow_x100 = lround(thePlant.shotFlow() * 100);
+  s.flowRate_x100 = lround(brewhob->getFlowRateCCs() * 100);
+  s.steamLevel_cc = lround(thePlant.steamLevel());
+  return s;
+}
+
+static void trace(){
+  uint32_t now = millis();
+  if(csv && now % csvPeriod == 0){
+    TraceSample s = sample();
+    fprintf(csv, "%u,%s,%d,%d,%d,%d,%d,%d,%.2f,%.2f,%.1f,%.1f,%u,%.2f,%.2f,%u\n",
+      s.t_ms, Brewhob::stateName((Brewhob::State)s.state),
+      !!(s.outputs & TRACE_HEAT1), !!(s.outputs & TRACE_HEAT2), !!(s.outputs & TRACE_PUMP),
+      !!(s.outputs & TRACE_SOL1), !!(s.outputs & TRACE_SOL2), !!(s.outputs & TRACE_SOL3),
+      s.brewC_x100 / 100.0, s.steamC_x100 / 100.0, s.rtd1F_x10 / 10.0, s.rtd2F_x10 / 10.0,
+      s.flowCount, s.shotFlow_x100 / 100.0, s.flowRate_x100 / 100.0, s.steamLevel_cc);
+  }
+  if(bin && now % binPeriod == 0){
+    TraceSample s = sample();
+    fwrite(&s, sizeof(s), 1, bin);
+  }
+}
+
+//power on: RAM as the sketch declares it, flash and the plant as they are
+static void boot(){
+  sim_reset();
+  sim_set_plant_step(plantStep);
+  sim_set_rtd_parameters(RNOMINAL, RREF);
+  sim_set_rtd_source(rtdSource);
+
+  last1s_ms = last2s_ms = last10s_ms = 0;
+  lastFill_ms = lastCloud_ms = lastLog_ms = 0;
+  delete brewhob; //left over from a previous begin()
+  brewhob = NULL;
+
+  settings = defaultSettings;
+  cloudProfile = ShotProfile();
+  memset(cloudTuning, 0, sizeof(cloudTuning));
+  cloudTuned = false;
+  _ShotSize = 0;
+  _BrewBoilerSP = _SteamBoilerSP = 0;
+  _Prewet = _Dwell = _DelayPumpStart = 0;
+  _BrewBoilerOn = _SteamBoilerOn = false;
+  _Profile = "";
+  _Tuning = "";
+  _Autotune = 0;
+
+  setup();
+}
+
+void Simulator::begin(const PlantParams& params){
+  thePlant = Plant(params);
+  memset(settingsArea, 0, sizeof(settingsArea)); //as after an upload
+  boot();
+
+  //what the dashboard would sync on the first update()
+  setSetpoints(SETPOINT1, SETPOINT2);
+  setShotSize(SHOT_SIZE);
+  setInfusion(0, 0, 0);
+  setProfile("");
+  setAutotune(0);
+  setTuning("");
+  setBoilersOn(true, true);
+  setScheduleActive(true);
+}
+
+void Simulator::reboot(){ boot(); }
+
+void Simulator::run(uint32_t ms){
+  for(uint32_t i = 0; i < ms; i++){
+    loop();
+    sim_advance(1000);
+    trace();
+  }
+}
+
+Plant& Simulator::plant(){ return thePlant; }
+int Simulator::state(){ return brewhob->getStateId(); }
+float Simulator::rtd(int sensorNum){ return brewhob->getRTD(sensorNum); }
+int Simulator::flowCount(){ return brewhob->getFlowCount(); }
+float Simulator::flowRate(){ return brewhob->getFlowRateCCs(); }
+int Simulator::shotTimer(){ return brewhob->getShotTimer(); }
+const char* Simulator::lastShot(){ return brewhob->lastShotSpecs_.c_str(); }
+const ShotRecorder& Simulator::shotRecorder(){ return brewhob->getShotRecorder(); }
+void Simulator::setFeedForward(bool enabled){ brewhob->setFeedForward(enabled); }
+void Simulator::setScheduling(bool enabled){ brewhob->setScheduling(enabled); }
+const char* Simulator::logLine(){ return brewhob->log_.c_str(); }
+TelemetrySample Simulator::telemetry(){ return brewhob->getTelemetry(); }
+bool Simulator::output(int pin){ return sim_output(pin) != 0; }
+
+void Simulator::pressSwitch(int swNum){
+  int pin = swNum == 1 ? SW1_PIN : swNum == 2 ? SW2_PIN : SW3_PIN;
+  sim_set_input(pin, HIGH);
+  run(50);
+  sim_set_input(pin, LOW);
+  run(150); //past the 100 ms debounce
+}
+
+uint32_t Simulator::pullShot(uint32_t timeoutMs){
+  uint32_t start = millis();
+  pressSwitch(1);
+  while(state() != Brewhob::BREW && millis() - start < 2000) run(1);
+  while(state() == Brewhob::BREW && millis() - start < timeoutMs) run(10);
+  uint32_t shot = millis() - start;
+  pressSwitch(1);
+  return shot;
+}
+
+void Simulator::setSetpoints(int brewF, int steamF){
+  _BrewBoilerSP = settings.brewSP = brewF;
+  _SteamBoilerSP = settings.steamSP = steamF;
+}
+
+void Simulator::setShotSize(int pulses){
+  _ShotSize = settings.shotSize = pulses;
+}
+
+void Simulator::setInfusion(int prewet, int dwell, int delayPumpStart){
+  _Prewet = settings.prewet = prewet;
+  _Dwell = settings.dwell = dwell;
+  _DelayPumpStart = settings.delayPumpStart = delayPumpStart;
+}
+
+bool Simulator::setProfile(const char* hex){
+  ShotProfile before = cloudProfile;
+  _Profile = hex;
+  onProfileChange();
+  settings.profile = cloudProfile;
+  return *hex == 0 || memcmp(&before, &cloudProfile, sizeof(before)) != 0;
+}
+
+void Simulator::setAutotune(int boiler){
+  _Autotune = settings.autotune = boiler;
+}
+
+int Simulator::autotune(){ return brewhob->getAutotune(); }
+const char* Simulator::tuning(){ return _Tuning.c_str(); }
+
+bool Simulator::setTuning(const char* text){
+  _Tuning = text;
+  cloudTuned = false;
+  onTuningChange();
+  settings.tuned = cloudTuned;
+  memcpy(settings.gains, cloudTuning, sizeof(settings.gains));
+  return cloudTuned;
+}
+
+void Simulator::setBoilersOn(bool brew, bool steam){
+  _BrewBoilerOn = settings.brewBoilerOn = brew;
+  _SteamBoilerOn = settings.steamBoilerOn = steam;
+}
+
+void Simulator::setScheduleActive(bool active){
+  _Schedule.setActive(active);
+  settings.power = active;
+}
+
+void Simulator::traceCsv(FILE* file, uint32_t periodMs){
+  csv = file;
+  csvPeriod = periodMs ? periodMs : 1;
+  if(csv) fprintf(csv, "t_ms,state,heat1,heat2,pump,sol1,sol2,sol3,brew_c,steam_c,rtd1_f,rtd2_f,flow_count,shot_flow_ccs,flow_rate_ccs,steam_level_cc\n");
+}
+
+void Simulator::traceBinary(FILE* file, uint32_t periodMs){
+  bin = file;
+  binPeriod = periodMs ? periodMs : 1;
+  if(bin){
+    uint32_t size = sizeof(TraceSample);
+    fwrite(TRACE_MAGIC, 1, 8, bin);
+    fwrite(&size, sizeof(size), 1, bin);
+  }
+}
+
+void Simulator::echoSerial(bool echo){ Serial.setEcho(echo); }
@@ -0,0 +1,87 @@
+/*
+  Simulator.h - Runs the unmodified Brewhob_one sketch on the host against
+  the Plant model, on a virtual clock.
+
+  The sketch and its globals exist once per process, so there is a single
+  simulator; begin() resets the emulation and reruns setup().
+*/
+#ifndef Simulator_h
+#define Simulator_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include "Plant.h"
+#include "ShotRecorder.h"
+#include "TelemetryFrame.h"
+
+//Output bits in TraceSample::outputs
+#define TRACE_HEAT1 0x01
+#define TRACE_HEAT2 0x02
+#define TRACE_PUMP  0x04
+#define TRACE_SOL1  0x08
+#define TRACE_SOL2  0x10
+#define TRACE_SOL3  0x20
+
+//One record of the binary trace, little endian as written by the host.
+struct __attribute__((packed)) TraceSample
+{
+  uint32_t t_ms;
+  uint8_t  state;        //Brewhob::State
+  uint8_t  outputs;      //TRACE_* bits
+  int16_t  brewC_x100;   //plant temperatures
+  int16_t  steamC_x100;
+  int16_t  rtd1F_x10;    //what the firmware believes, in F
+  int16_t  rtd2F_x10;
+  uint16_t flowCount;    //firmware flowmeter count
+  uint16_t shotFlow_x100; //plant cc/s through the group
+  uint16_t flowRate_x100; //firmware flow estimate, cc/s
+  uint16_t steamLevel_cc;
+};
+
+#define TRACE_MAGIC "BHTRACE2"
+
+namespace Simulator
+{
+  void begin(const PlantParams& params = PlantParams());
+  void run(uint32_t ms); //one loop() per virtual millisecond
+  //power cycle without the cloud: the flash and the plant keep their state
+  void reboot();
+
+  Plant& plant();
+  int state();           //Brewhob::State of the firmware
+  float rtd(int sensorNum);
+  int flowCount();
+  float flowRate();      //firmware estimate, cc/s
+  int shotTimer();
+  const char* lastShot();
+  const ShotRecorder& shotRecorder();
+  const char* logLine();  //last printAll() line
+  TelemetrySample telemetry();
+  bool output(int pin);
+
+  void pressSwitch(int swNum); //rising edge on SW<n>_PIN
+  //lower the lever, wait for the shot to end (or timeoutMs), raise it again;
+  //returns the virtual shot time in ms
+  uint32_t pullShot(uint32_t timeoutMs = 90000);
+
+  //cloud dashboard values
+  void setSetpoints(int brewF, int steamF);
+  void setShotSize(int pulses);
+  void setInfusion(int prewet, int dwell, int delayPumpStart);
+  bool setProfile(const char* hex); //as _Profile from the dashboard, "" for the infusion settings
+  void setBoilersOn(bool brew, bool steam);
+  void setScheduleActive(bool active);
+  void setFeedForward(bool enabled);
+  void setScheduling(bool enabled);
+  void setAutotune(int boiler); //_Autotune, 0 cancels
+  int autotune();               //boiler being tuned, 0 once finished
+  const char* tuning();         //_Tuning, as saved in the cloud
+  bool setTuning(const char* text);
+
+  //trace every periodMs to CSV and/or binary, NULL to close
+  void traceCsv(FILE* file, uint32_t periodMs = 100);
+  void traceBinary(FILE* file, uint32_t periodMs = 100);
+  void echoSerial(bool echo);
+}
+
+#endif
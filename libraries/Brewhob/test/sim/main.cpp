@@ -0,0 +1,77 @@
+/*
+  main.cpp - Command line front end of the Brewhob simulator.
+
+  brewhob_sim [--hours H] [--shot-every MIN] [--csv FILE] [--bin FILE]
+              [--trace-ms MS] [--echo]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Simulator.h"
+#include "Brewhob.h"
+
+static void usage(){
+  fprintf(stderr, "usage: brewhob_sim [--hours H] [--shot-every MIN] [--csv FILE] [--bin FILE] [--trace-ms MS] [--echo]\n");
+  exit(1);
+}
+
+int main(int argc, char** argv){
+  float hours = 1, shotEvery = 15;
+  const char *csvPath = NULL, *binPath = NULL;
+  uint32_t traceMs = 100;
+  bool echo = false;
+
+  for(int i = 1; i < argc; i++){
+    bool more = i + 1 < argc;
+    if(!strcmp(argv[i], "--hours") && more)           hours = atof(argv[++i]);
+    else if(!strcmp(argv[i], "--shot-every") && more) shotEvery = atof(argv[++i]);
+    else if(!strcmp(argv[i], "--csv") && more)        csvPath = argv[++i];
+    else if(!strcmp(argv[i], "--bin") && more)        binPath = argv[++i];
+    else if(!strcmp(argv[i], "--trace-ms") && more)   traceMs = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--echo"))               echo = true;
+    else usage();
+  }
+
+  FILE* csv = csvPath ? fopen(csvPath, "w") : NULL;
+  FILE* bin = binPath ? fopen(binPath, "wb") : NULL;
+  if((csvPath && !csv) || (binPath && !bin)){
+    perror("brewhob_sim");
+    return 1;
+  }
+
+  clock_t wall = clock();
+  Simulator::echoSerial(echo);
+  Simulator::begin();
+  Simulator::traceCsv(csv, traceMs);
+  Simulator::traceBinary(bin, traceMs);
+
+  uint32_t total = hours * 3600000, next = shotEvery * 60000;
+  int shots = 0;
+  float minF = 1e9, maxF = -1e9;
+  while(millis() < total){
+    if(shotEvery > 0 && millis() >= next){
+      uint32_t start = millis();
+      Simulator::pressSwitch(1);
+      while(Simulator::state() == Brewhob::BREW || millis() - start < 1000){
+        Simulator::run(10);
+        float f = Simulator::rtd(1);
+        if(f < minF) minF = f;
+        if(f > maxF) maxF = f;
+        if(millis() - start > 90000) break;
+      }
+      Simulator::pressSwitch(1);
+      printf("shot %d at %.1f min: %s\n", ++shots, start / 60000.0, Simulator::lastShot());
+      next += shotEvery * 60000;
+    }
+    Simulator::run(100);
+  }
+
+  printf("%.2f h simulated in %.2f s, %d shots, %.3f kWh\n",
+    hours, (double)(clock() - wall) / CLOCKS_PER_SEC, shots, Simulator::plant().energyKWh());
+  if(shots) printf("brew RTD during shots %.1f..%.1f F\n", minF, maxF);
+
+  if(csv) fclose(csv);
+  if(bin) fclose(bin);
+  return 0;
+}
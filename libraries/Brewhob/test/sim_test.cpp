@@ -0,0 +1,492 @@
+/*
+  sim_test.cpp - Regression tests of the Brewhob firmware against the simulated machine.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "Simulator.h"
+#include "Brewhob.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if(!(cond)){ printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+  } while(0)
+
+static void warmUp(){
+  Simulator::begin();
+  Simulator::run(20 * 60000UL);
+}
+
+static void testWarmUp(){
+  printf("warm up\n");
+  warmUp();
+  CHECK(fabs(Simulator::rtd(1) - SETPOINT1) < 5);
+  CHECK(fabs(Simulator::rtd(2) - SETPOINT2) < 10);
+  CHECK(Simulator::state() == Brewhob::STANDBY);
+}
+
+static void testHeatersNeverOverlap(){
+  printf("heaters never overlap\n");
+  Simulator::begin();
+  int overlaps = 0, steamOn = 0;
+  for(int i = 0; i < 10 * 60000; i++){
+    Simulator::run(1);
+    bool h1 = Simulator::output(HEAT1_PIN), h2 = Simulator::output(HEAT2_PIN);
+    overlaps += h1 && h2;
+    steamOn += h2;
+  }
+  CHECK(overlaps == 0);
+  CHECK(steamOn > 0);
+}
+
+static void testShot(){
+  printf("shot\n");
+  warmUp();
+  uint32_t ms = Simulator::pullShot();
+  CHECK(Simulator::state() == Brewhob::STANDBY);
+  CHECK(ms > 20000 && ms < 60000);
+  CHECK(strstr(Simulator::lastShot(), "350 Pulses") != NULL);
+
+  //lever is up again: the next shot starts from zero
+  Simulator::run(2000);
+  CHECK(Simulator::flowCount() == 0);
+}
+
+static void testFlowRate(){
+  printf("flow rate\n");
+  warmUp();
+  Simulator::pressSwitch(1);
+  Simulator::run(15000); //well into the shot, puck saturated
+  float worst = 0;
+  for(int i = 0; i < 10; i++){
+    Simulator::run(500);
+    float plant = Simulator::plant().shotFlow();
+    float err = fabs(Simulator::flowRate() - plant) / plant;
+    if(err > worst) worst = err;
+  }
+  printf("  worst error %.1f%%\n", worst * 100);
+  CHECK(worst < 0.1);
+  while(Simulator::state() == Brewhob::BREW) Simulator::run(10);
+  Simulator::run(100);
+  CHECK(Simulator::flowRate() == 0);
+  Simulator::pressSwitch(1);
+}
+
+//reset() from another task lands between two update()s; the window must
+//drop what was pushed before it and keep what came after
+static void testFlowReset(){
+  printf("flow reset\n");
+  Simulator::begin();
+  FlowEstimator flow(CC_PER_PULSE, 4);
+  for(int i = 0; i < 4; i++){ flow.pushPulse(micros()); sim_advance(20000); } //50 pulses/s
+  flow.update();
+  CHECK(fabs(flow.flowRate() - 50 * CC_PER_PULSE) < 0.5);
+  for(int i = 0; i < 3; i++){ flow.pushPulse(micros()); sim_advance(20000); } //not drained yet
+  flow.reset();
+  CHECK(flow.flowRate() == 0);
+  for(int i = 0; i < 4; i++){ flow.pushPulse(micros()); sim_advance(100000); } //10 pulses/s
+  flow.update();
+  CHECK(fabs(flow.flowRate() - 10 * CC_PER_PULSE) < 0.1);
+}
+
+static void testShotProfile(){
+  printf("shot profile\n");
+  warmUp();
+  Simulator::setInfusion(3, 5, 0);
+  uint32_t ms = Simulator::pullShot();
+  const ShotRecorder& shots = Simulator::shotRecorder();
+  CHECK(shots.shots() == 1);
+
+  //export in small chunks, as over the cloud, then decode
+  uint8_t blob[sizeof(ShotHeader) + SHOT_RECORD_BYTES];
+  uint16_t size = shots.exportSize(0), n = 0;
+  while(n < size) n += shots.exportChunk(0, n, blob + n, 20);
+  CHECK(n == size);
+  printf("  %u ms, %u bytes\n", ms, size);
+
+  ShotReader reader(blob);
+  CHECK(!reader.header().truncated);
+  CHECK(reader.header().bytes < reader.header().samples * 1.2); //about a byte per sample
+  CHECK(abs((int)reader.header().samples - (int)(ms / SHOT_RECORD_PERIOD_MS)) <= 2);
+  ShotSample s;
+  int phases[4] = {0}, lastFlow = 0, flowMonotonic = 1;
+  float tempErr = 0;
+  while(reader.next(s)){
+    phases[s.phase]++;
+    flowMonotonic &= s.flowCount >= lastFlow;
+    lastFlow = s.flowCount;
+    if(s.phase == SHOT_DWELL) CHECK(!(s.solenoids & 2));
+    tempErr = fmax(tempErr, fabs(s.brewTemp_x10 / 10.0 - SETPOINT1));
+  }
+  CHECK(flowMonotonic);
+  CHECK(lastFlow >= 349);
+  CHECK(abs(phases[SHOT_PREWET] - 30) <= 2 && abs(phases[SHOT_DWELL] - 50) <= 2);
+  CHECK(tempErr < 15);
+
+  //ring keeps the last SHOT_RECORD_SHOTS, newest first
+  for(int i = 0; i < SHOT_RECORD_SHOTS + 1; i++){
+    Simulator::setInfusion(0, 0, 0);
+    Simulator::pullShot();
+    Simulator::run(5000);
+  }
+  CHECK(shots.shots() == SHOT_RECORD_SHOTS);
+  CHECK(shots.exportSize(SHOT_RECORD_SHOTS) == 0);
+  Simulator::setInfusion(0, 0, 0);
+}
+
+static void testTelemetry(){
+  printf("telemetry\n");
+  warmUp();
+  printf("  %s\n", Simulator::logLine());
+  CHECK(strncmp(Simulator::logLine(), "STANDBY  000 000 ", 17) == 0);
+  CHECK(strstr(Simulator::logLine(), " 212.0 260.0 ") != NULL);
+
+  TelemetrySample s = Simulator::telemetry(), d;
+  uint8_t frame[TELEMETRY_FRAME_BYTES];
+  CHECK(TelemetryFrame::encode(s, frame) == TELEMETRY_FRAME_BYTES);
+  CHECK(TelemetryFrame::decode(frame, d) && memcmp(&s, &d, sizeof(s)) == 0);
+  frame[7] ^= 0x10;
+  CHECK(!TelemetryFrame::decode(frame, d));
+
+  Simulator::setInfusion(300, 90000, 0); //past a byte, and past 16 bits
+  Simulator::run(100);
+  s = Simulator::telemetry();
+  CHECK(s.prewet == 300 && s.dwell == 0xFFFF);
+  Simulator::setInfusion(0, 0, 0);
+
+  TelemetryFrame f;
+  f.fixed(-1234, 2).str(" ").fixed(7, 3).str(" ").num(-2147483647L - 1);
+  CHECK(strcmp(f.c_str(), "-12.34 0.007 -2147483648") == 0);
+}
+
+//largest drop of the brew water below its temperature at the lever, over a shot
+static float shotDroop(bool feedForward){
+  warmUp();
+  Simulator::setFeedForward(feedForward);
+  float start = Simulator::plant().brewC(), low = start;
+  Simulator::pressSwitch(1);
+  while(Simulator::state() == Brewhob::BREW){
+    Simulator::run(10);
+    if(Simulator::plant().brewC() < low) low = Simulator::plant().brewC();
+  }
+  Simulator::pressSwitch(1);
+  Simulator::setFeedForward(FEEDFORWARD_EN);
+  return start - low;
+}
+
+static void testFeedForward(){
+  printf("feed-forward\n");
+  float without = shotDroop(false), with = shotDroop(true);
+  printf("  brew droop %.2f C without, %.2f C with\n", without, with);
+  CHECK(with < without * 0.7);
+}
+
+//cold start of the brew boiler over 30 minutes: seconds until it stays
+//within 1 F of the setpoint, and the highest reading above it
+static void brewWarmUp(const char* tuning, int& settled, float& overshoot){
+  Simulator::begin();
+  Simulator::setTuning(tuning);
+  settled = 0;
+  overshoot = 0;
+  for(int s = 1; s <= 30 * 60; s++){
+    Simulator::run(1000);
+    float err = Simulator::rtd(1) - SETPOINT1;
+    if(fabs(err) > 1) settled = s;
+    if(err > overshoot) overshoot = err;
+  }
+}
+
+static void testAutotune(){
+  printf("autotune\n");
+  warmUp();
+  Simulator::setAutotune(1);
+  Simulator::run(1000);
+  CHECK(Simulator::autotune() == 1);
+  for(int s = 0; s < AUTOTUNE_TIMEOUT_S && Simulator::autotune(); s += 10) Simulator::run(10000);
+  Simulator::run(2000); //cloud saves the result
+  CHECK(Simulator::autotune() == 0);
+
+  PIDGains gains[2];
+  CHECK(Brewhob::parseTuning(Simulator::tuning(), gains));
+  printf("  brew Kp %.1f Ki %.3f Kd %.1f\n", gains[0].kp, gains[0].ki, gains[0].kd);
+  CHECK(gains[0].kp > 0 && gains[0].ki > 0 && gains[0].kd > 0);
+  CHECK(gains[1].kp == Kp && gains[1].ki == Ki && gains[1].kd == Kd); //steam untouched
+
+  //saved gains come back from the cloud after a restart
+  char saved[TUNING_TEXT_MAX];
+  strncpy(saved, Simulator::tuning(), sizeof(saved) - 1);
+  saved[sizeof(saved) - 1] = 0;
+  int before, guess, after;
+  float beforeOver, guessOver, afterOver;
+  brewWarmUp("", before, beforeOver);
+  brewWarmUp(saved, after, afterOver);
+  printf("  warm up settles in %d s, %.2f F over with config.h gains; %d s, %.2f F over tuned\n",
+    before, beforeOver, after, afterOver);
+  CHECK(after < before);
+
+  //with back-calculation the config.h gains never cross the setpoint, so
+  //the overshoot is compared with a poor guess: a quarter of Kp and Kd,
+  //four times Ki, as gains carried over from another boiler might be
+  char mistuned[TUNING_TEXT_MAX];
+  snprintf(mistuned, sizeof(mistuned), "%g,%g,%g,%g,%g,%g",
+    Kp / 4.0, Ki * 4.0, Kd / 4.0, (double)Kp, (double)Ki, (double)Kd);
+  brewWarmUp(mistuned, guess, guessOver);
+  printf("  %d s, %.2f F over with mistuned gains\n", guess, guessOver);
+  CHECK(after < guess);
+  CHECK(afterOver < guessOver);
+}
+
+//three shots a minute apart: seconds after each until the brew boiler
+//stays within 1 F, worst of the three
+static int backToBackRecovery(bool scheduling){
+  warmUp();
+  Simulator::setScheduling(scheduling);
+  int worst = 0;
+  for(int shot = 0; shot < 3; shot++){
+    Simulator::pullShot();
+    int settled = 0;
+    for(int s = 1; s <= 60; s++){
+      Simulator::run(1000);
+      if(fabs(Simulator::rtd(1) - SETPOINT1) > 1) settled = s;
+    }
+    if(settled > worst) worst = settled;
+  }
+  return worst;
+}
+
+static void testGainSchedule(){
+  printf("gain schedule\n");
+  int without = backToBackRecovery(false), with = backToBackRecovery(true);
+  printf("  back-to-back recovery %d s with one gain set, %d s scheduled\n", without, with);
+  CHECK(with < 60);
+  CHECK(with < without);
+}
+
+static void testPrewetDwell(){
+  printf("prewet and dwell\n");
+  warmUp();
+  Simulator::setInfusion(3, 5, 0);
+  Simulator::pressSwitch(1);
+  Simulator::run(1000);
+  CHECK(Simulator::output(SOL2_PIN) && Simulator::output(PUMP_PIN)); //prewet
+  Simulator::run(4000);
+  CHECK(!Simulator::output(SOL2_PIN));                               //dwell
+  Simulator::run(5000);
+  CHECK(Simulator::output(SOL2_PIN) && Simulator::output(PUMP_PIN)); //extraction
+  while(Simulator::state() == Brewhob::BREW) Simulator::run(10);
+  Simulator::pressSwitch(1);
+  CHECK(strstr(Simulator::lastShot(), "Prewet 3s") != NULL);
+  CHECK(strstr(Simulator::lastShot(), "Dwell 5s") != NULL);
+}
+
+static void testTeaDuringDwell(){
+  printf("tea switch during dwell\n");
+  warmUp();
+  Simulator::setInfusion(3, 5, 0);
+  Simulator::pressSwitch(1);
+  Simulator::run(4000);
+  int pulses = Simulator::flowCount();
+  Simulator::pressSwitch(2);
+  Simulator::run(1000);
+  CHECK(!Simulator::output(SOL2_PIN) && !Simulator::output(SOL3_PIN)); //still dwelling, no tea water
+  CHECK(Simulator::flowCount() == pulses);
+  Simulator::run(3000);
+  CHECK(Simulator::output(SOL2_PIN) && Simulator::output(PUMP_PIN) && !Simulator::output(SOL3_PIN)); //extraction
+  while(Simulator::state() == Brewhob::BREW) Simulator::run(10);
+  Simulator::pressSwitch(2);
+  Simulator::pressSwitch(1);
+  CHECK(strstr(Simulator::lastShot(), "Dwell 5s") != NULL);
+}
+
+//ms from now until pin reads val, 0 on timeout
+static uint32_t msUntil(int pin, bool val, uint32_t timeoutMs = 60000){
+  for(uint32_t ms = 1; ms <= timeoutMs; ms++){
+    Simulator::run(1);
+    if(Simulator::output(pin) == val) return ms;
+  }
+  return 0;
+}
+
+static void testDwellAndBloom(){
+  printf("dwell and bloom together\n");
+  warmUp();
+  Simulator::setInfusion(2, 3, 4);
+  Simulator::pressSwitch(1);
+  uint32_t prewet = msUntil(SOL2_PIN, false);
+  uint32_t dwell = msUntil(PUMP_PIN, false);
+  CHECK(Simulator::output(SOL2_PIN));
+  uint32_t bloom = msUntil(PUMP_PIN, true);
+  prewet += 199; //pressSwitch() returns 199 ms into the shot
+  printf("  prewet %u ms, dwell %u ms, bloom %u ms\n", prewet, dwell, bloom);
+  CHECK(abs((int)prewet - 2000) <= 1 && abs((int)dwell - 3000) <= 1 && abs((int)bloom - 4000) <= 1);
+  CHECK(Simulator::flowCount() == 0); //infusion is not part of the shot
+  while(Simulator::state() == Brewhob::BREW) Simulator::run(10);
+  Simulator::pressSwitch(1);
+  CHECK(strstr(Simulator::lastShot(), "Dwell 3s, Bloom 4s") != NULL);
+}
+
+static void testCustomProfile(){
+  printf("custom profile\n");
+  ShotProfile p;
+  p.count = 3;
+  p.segments[0] = {PROFILE_VOLUME, 10, 255, 0x02};                   //prewet by volume
+  p.segments[1] = {PROFILE_TIME, 2500, 0, 0};                        //soak, all closed
+  p.segments[2] = {PROFILE_TIME | PROFILE_COUNTS, 0, 255, 0x02};     //extraction
+  char hex[PROFILE_HEX_MAX];
+  p.toHex(hex);
+  printf("  %s\n", hex);
+
+  ShotProfile q;
+  CHECK(q.fromHex(hex) && q.count == 3 && q.segments[0].amount == 10 && q.segments[1].trigger == PROFILE_TIME);
+  hex[4] ^= 1;
+  CHECK(!q.fromHex(hex));
+  CHECK(!q.fromHex("03zz"));
+  hex[4] ^= 1;
+
+  //a profile the shot size cannot end is refused
+  ShotProfile untimed = p;
+  untimed.segments[2].trigger = PROFILE_TIME;
+  char bad[PROFILE_HEX_MAX];
+  untimed.toHex(bad);
+  CHECK(!q.fromHex(bad) && q.segments[2].trigger == (PROFILE_TIME | PROFILE_COUNTS));
+
+  //infusion times past 16 bit ms clamp instead of wrapping
+  ShotProfile slow = ShotProfile::infusion(70, 120, -1);
+  CHECK(slow.segments[SHOT_PREWET].amount == PROFILE_MAX_SECONDS * 1000);
+  CHECK(slow.segments[SHOT_DWELL].amount == PROFILE_MAX_SECONDS * 1000);
+  CHECK(slow.segments[SHOT_BLOOM].amount == 0);
+
+  warmUp();
+  CHECK(Simulator::setProfile(hex));
+  Simulator::pressSwitch(1);
+  uint32_t prewet = msUntil(PUMP_PIN, false);
+  int pulses = Simulator::plant().pumpedVolume() / CC_PER_PULSE;
+  uint32_t soak = msUntil(PUMP_PIN, true);
+  printf("  prewet %u ms (%d pulses), soak %u ms\n", prewet, pulses, soak);
+  CHECK(prewet > 0 && abs((int)soak - 2500) <= 1);
+  uint32_t ms = 0;
+  while(Simulator::state() == Brewhob::BREW){ Simulator::run(10); ms += 10; }
+  Simulator::pressSwitch(1);
+  CHECK(strstr(Simulator::lastShot(), "350 Pulses") != NULL);
+  CHECK(Simulator::shotRecorder().exportSize(0) > 0);
+  Simulator::setProfile("");
+}
+
+static void testFill(){
+  printf("fill\n");
+  warmUp();
+  Simulator::plant().setSteamLevel(900);
+  bool sawFill = false;
+  for(int i = 0; i < 120 && !(sawFill && Simulator::state() == Brewhob::STANDBY); i++){
+    Simulator::run(1000);
+    if(Simulator::state() == Brewhob::FILL){
+      sawFill = true;
+      CHECK(Simulator::output(SOL1_PIN) && Simulator::output(PUMP_PIN));
+    }
+  }
+  CHECK(sawFill);
+  CHECK(Simulator::state() == Brewhob::STANDBY);
+  CHECK(Simulator::plant().steamLevel() >= Simulator::plant().params.steamProbe_cc);
+  CHECK(!Simulator::output(SOL1_PIN));
+}
+
+//Both RTDs settle and convert together: their first samples land in the
+//same millisecond instead of one conversion time apart.
+static void testRTDPair(){
+  printf("rtd pair\n");
+  Simulator::begin();
+  float before1 = Simulator::rtd(1), before2 = Simulator::rtd(2);
+  uint32_t t = 0, t1 = 0, t2 = 0;
+  while((!t1 || !t2) && t < 5000){
+    Simulator::run(1);
+    t++;
+    if(!t1 && Simulator::rtd(1) != before1) t1 = t;
+    if(!t2 && Simulator::rtd(2) != before2) t2 = t;
+  }
+  CHECK(t1 && t2);
+  CHECK(t1 == t2);
+}
+
+//One-shot: CONFIG is written without being read back, and clearing the
+//fault and turning on the bias share a write. Four transactions per
+//sensor per sample: bias on, 1-shot, read, bias off.
+static void testRTDTransactions(){
+  printf("rtd transactions\n");
+  Simulator::begin();
+  Simulator::run(RTD_PERIOD_MS * 2);
+  long start = sim_spi_transactions();
+  Simulator::run(RTD_PERIOD_MS * 10);
+  long perSample = (sim_spi_transactions() - start) / 10;
+  if(RTD_CONTINUOUS) CHECK(perSample <= 2 * (RTD_PERIOD_MS / 21 + 1));
+  else CHECK(perSample == 2 * 4);
+}
+
+static void testScheduleOff(){
+  printf("schedule off\n");
+  warmUp();
+  Simulator::setScheduleActive(false);
+  Simulator::run(5000);
+  CHECK(Simulator::state() == Brewhob::OFF);
+  Simulator::run(HEATER_WINDOW_MS * 2);
+  CHECK(!Simulator::output(HEAT1_PIN) && !Simulator::output(HEAT2_PIN));
+}
+
+//dashboard values come back from flash after a power cycle without the cloud
+static void testSettingsRestore(){
+  printf("settings restore\n");
+  const char* tuned = "1.500,0.020,3.000,2.000,0.010,4.000";
+  Simulator::begin();
+  Simulator::setSetpoints(205, 255);
+  Simulator::setShotSize(300);
+  Simulator::setInfusion(3, 4, 2);
+  CHECK(Simulator::setTuning(tuned));
+  Simulator::run(3000); //saved by the cloud step
+
+  Simulator::reboot();
+  Simulator::run(1);
+  TelemetrySample s = Simulator::telemetry();
+  CHECK(s.setpoint1_x10 == 2050 && s.setpoint2_x10 == 2550);
+  CHECK(s.prewet == 3 && s.dwell == 4);
+  CHECK(strcmp(Simulator::tuning(), tuned) == 0);
+
+  //only the changed value is written, the rest is still there
+  Simulator::setSetpoints(210, 255);
+  Simulator::run(2000);
+  Simulator::reboot();
+  Simulator::run(1);
+  s = Simulator::telemetry();
+  CHECK(s.setpoint1_x10 == 2100 && s.setpoint2_x10 == 2550);
+  CHECK(s.prewet == 3 && s.dwell == 4);
+
+  //an upload clears the area, back to config.h
+  Simulator::begin();
+  Simulator::run(1);
+  s = Simulator::telemetry();
+  CHECK(s.setpoint1_x10 == SETPOINT1 * 10 && s.prewet == 0);
+}
+
+int main(){
+  testWarmUp();
+  testHeatersNeverOverlap();
+  testShot();
+  testFlowRate();
+  testFlowReset();
+  testShotProfile();
+  testTelemetry();
+  testFeedForward();
+  testAutotune();
+  testGainSchedule();
+  testPrewetDwell();
+  testTeaDuringDwell();
+  testDwellAndBloom();
+  testCustomProfile();
+  testFill();
+  testScheduleOff();
+  testRTDPair();
+  testRTDTransactions();
+  testSettingsRestore();
+
+  printf(failures ? "%d FAILED\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -19,14 +19,13 @@
 #define PIN_OUTPUT    9
 
 float Kp=0.1, Ki=0.5, Kd=0, Hz=10;
-int output_bits = 8;
-bool output_signed = false;
 
-FastPID myPID(Kp, Ki, Kd, Hz, output_bits, output_signed);
+FastPID myPID(Kp, Ki, Kd, Hz);
 
 void setup()
 {
   Serial.begin(9600);
+  myPID.setOutputRange(0, 255);
 }
 
 void loop()
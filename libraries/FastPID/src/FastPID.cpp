@@ -1,19 +1,126 @@
 #include "FastPID.h"
+#include "FastPIDFixed.h"
 
 #include <Arduino.h>
 
+using FastPIDFixed::toParam;
+
 FastPID::~FastPID() {
 }
 
 void FastPID::clear() { 
   _sum = 0; 
   _last_err = 0;
+  _last_fb = 0;
+  _dfilt = 0;
+  _isum = 0;
+  _last_ierr = 0;
+  _last_ifb = 0;
+  _idfilt = 0;
+  _primed = false;
 } 
 
-void FastPID::setCoefficients(float kp, float ki, float kd, float hz) {
+// Per step constants of the derivative filter and back-calculation
+void FastPID::derive() {
+  FastPIDFixed::derive(_p, _i, _d, _hz, _tf, _tt, _alpha, _kt);
+  toParam(_alpha, _alphaq);
+  toParam(_kt, _ktq);
+}
+
+bool FastPID::setCoefficients(float kp, float ki, float kd, float hz) {
+  int32_t pq, iq, dq;
+  if (_fixed && !quantize(kp, ki / hz, kd * hz, pq, iq, dq))
+    return false;
+
+  float oldP = _p, oldD = _d;
+  int32_t oldPq = _pq, oldDq = _dq;
+
   _p = kp;
   _i = ki / hz;
   _d = kd * hz;
+  _hz = hz;
+  if (_fixed) {
+    _pq = pq;
+    _iq = iq;
+    _dq = dq;
+  }
+  derive();
+
+  // Bumpless: at the last error and derivative, P + I + D is what it was
+  // before. A ki of 0 holds the integral, which still absorbs the change
+  // if there is one.
+  if (_fixed ? !_iq && !_isum : !_i && !_sum)
+    return true;
+  if (_fixed)
+    _isum = FastPIDFixed::bumpless(_isum, oldPq, _pq, _last_ierr, oldDq, _dq, _idfilt);
+  else {
+    _sum += (oldP - _p) * _last_err;
+    if (oldD)
+      _sum += (oldD - _d) * _dfilt;
+  }
+  return true;
+}
+
+void FastPID::setDerivative(DerivativeSource source, float filterSeconds) {
+  _dsource = source;
+  _tf = filterSeconds > 0 ? filterSeconds : 0;
+  derive();
+}
+
+void FastPID::setAntiWindup(WindupMode mode, float trackingSeconds) {
+  _windup = mode;
+  _tt = trackingSeconds > 0 ? trackingSeconds : 0;
+  derive();
+}
+
+bool FastPID::quantize(float p, float i, float d, int32_t &pq, int32_t &iq, int32_t &dq) const {
+  return toParam(p / _scale, pq) && toParam(i / _scale, iq) && toParam(d / _scale, dq);
+}
+
+bool FastPID::setIntegerMode(bool enable, int16_t inputScale) {
+  if (inputScale < 1)
+    return false;
+
+  int16_t oldScale = _scale;
+  int32_t pq, iq, dq;
+  _scale = inputScale;
+  if (enable && !quantize(_p, _i, _d, pq, iq, dq)) {
+    _scale = oldScale;
+    return false;
+  }
+  if (enable) {
+    _pq = pq;
+    _iq = iq;
+    _dq = dq;
+  }
+
+  // Carry the state across to the other pipeline
+  if (enable && !_fixed) {
+    float isum = _sum * PARAM_MULT;
+    _isum = isum > INT32_MAX ? INT32_MAX : isum < INT32_MIN ? INT32_MIN : int32_t(isum);
+    _last_ierr = _last_err * _scale;
+    _last_ifb = _last_fb * _scale;
+    _idfilt = _dfilt * _scale * PARAM_MULT;
+  }
+  else if (!enable && _fixed) {
+    _sum = float(_isum) / PARAM_MULT;
+    _last_err = float(_last_ierr) / _scale;
+    _last_fb = float(_last_ifb) / _scale;
+    _dfilt = float(_idfilt) / PARAM_MULT / _scale;
+  }
+  _fixed = enable;
+  return true;
+}
+
+int16_t FastPID::stepInt(int16_t sp, int16_t fb) {
+  if (!_fixed)
+    return step(float(sp) / _scale, float(fb) / _scale);
+  return stepFixed(sp, fb);
+}
+
+int16_t FastPID::stepFixed(int32_t sp, int32_t fb) {
+  return FastPIDFixed::step(sp, fb, _pq, _iq, _dq, _alphaq, _ktq, _outmin, _outmax, _dsource, _windup,
+                            _isum, _last_ierr, _last_ifb, _idfilt, _primed);
 }
 
 void FastPID::setOutputRange(int16_t min, int16_t max)
@@ -24,6 +131,11 @@ void FastPID::setOutputRange(int16_t min, int16_t max)
 
 int16_t FastPID::step(float sp, float fb) {
 
+  if (_fixed) {
+    float s = sp * _scale, f = fb * _scale;
+    return stepFixed(int32_t(s < 0 ? s - 0.5f : s + 0.5f), int32_t(f < 0 ? f - 0.5f : f + 0.5f));
+  }
+
   // int16 + int16 = int17
   float err = sp - fb;
   int32_t P = 0, I = 0;
@@ -34,25 +146,13 @@ int16_t FastPID::step(float sp, float fb) {
     P = _p * err;
   }
 
-  //discourage wind-up
-  if (_i) {
-    // int17 * int16 = int33
-    _sum += err * _i;
-
-    // Limit sum to 32-bit signed value so that it saturates, never overflows.
-    if (_sum > INTEG_MAX)
-      _sum = INTEG_MAX;
-    else if (_sum < INTEG_MIN)
-      _sum = INTEG_MIN;
-
-    // int32
-    I = _sum;
-  }
-
   if (_d) {
     // (int17 - int16) - (int16 - int16) = int19
-    int32_t deriv = (err - _last_err);
-    _last_err = err; 
+    float deriv;
+    if (_dsource == DERIV_ON_MEASUREMENT)
+      deriv = _primed ? _last_fb - fb : 0;
+    else
+      deriv = int32_t(err - _last_err);
 
     // Limit the derivative to 16-bit signed value.
     if (deriv > DERIV_MAX)
@@ -60,27 +160,69 @@ int16_t FastPID::step(float sp, float fb) {
     else if (deriv < DERIV_MIN)
       deriv = DERIV_MIN;
 
+    if (_alpha < 1) {
+      _dfilt += _alpha * (deriv - _dfilt);
+      deriv = _dfilt;
+    }
+    else
+      _dfilt = deriv; // kept for bumpless gain changes
+
     // int16 * int16 = int32
     D = _d* deriv;
   }
+  _last_err = err; 
+  _last_fb = fb;
+  _primed = true;
+
+  //discourage wind-up
+  if (_i) {
+    // int17 * int16 = int33
+    float sum = _sum + err * _i;
+
+    if (_windup == WINDUP_CLAMP) {
+      // Limit sum to 32-bit signed value so that it saturates, never overflows.
+      if (sum > INTEG_MAX)
+        sum = INTEG_MAX;
+      else if (sum < INTEG_MIN)
+        sum = INTEG_MIN;
+    }
+    else {
+      // The integral alone never needs more than the output range
+      if (sum > _outmax)
+        sum = _outmax;
+      else if (sum < _outmin)
+        sum = _outmin;
+    }
+
+    if (_windup == WINDUP_CONDITIONAL) {
+      // Hold the integral while it would drive a saturated output further
+      int64_t v = int64_t(P) + int32_t(sum) + D;
+      if ((v > _outmax && err > 0) || (v < _outmin && err < 0))
+        sum = _sum;
+    }
+    _sum = sum;
+  }
+  // int32, held at its last value while ki is 0
+  I = _sum;
 
   // int32 (P) + int32 (I) + int32 (D) = int34
   int64_t out = int64_t(P) + int64_t(I) + int64_t(D);
 
-  
- /* Serial.print(" P:");
-  Serial.print(P);
-  Serial.print(" I:");
-  Serial.print(I);
-  Serial.print(" D:");
-  Serial.print(D);
-*/
-
   // Make the output saturate
-  if (out > _outmax) 
-    out = _outmax;
-  else if (out < _outmin) 
-    out = _outmin;
+  int64_t sat = out;
+  if (sat > _outmax) 
+    sat = _outmax;
+  else if (sat < _outmin) 
+    sat = _outmin;
+
+  if (_i && _windup == WINDUP_BACK_CALCULATION && sat != out) {
+    // Track the saturated output
+    _sum += _kt * (sat - out);
+    if (_sum > _outmax)
+      _sum = _outmax;
+    else if (_sum < _outmin)
+      _sum = _outmin;
+  }
 
-  return out;
+  return sat;
 }
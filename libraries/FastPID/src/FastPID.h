@@ -3,19 +3,58 @@
 
 #include <stdint.h>
 
+// Integral limits of WINDUP_CLAMP, the other modes use the output range
 #define INTEG_MAX    2000
 #define INTEG_MIN    (INT32_MIN)
 #define DERIV_MAX    2000
 #define DERIV_MIN    (INT16_MIN)
 
+// Integer mode: coefficients are Q15.16 fixed point
+#define PARAM_SHIFT  16
+#define PARAM_MULT   (((int32_t)1) << PARAM_SHIFT)
 
 
 /*
-  A fixed point PID controller with a 32-bit internal calculation pipeline.
+  A PID controller with two pipelines. By default step() works in float.
+  setIntegerMode(true) switches to a fixed point pipeline: coefficients are
+  converted to Q15.16 once, the integral is an int32 that saturates, and
+  only the three coefficient products use a 64-bit intermediate. No float
+  operation runs per step when the integer step() is used, which matters on
+  parts without an FPU such as the SAMD21.
+
+  Integer mode inputs are in units of 1/inputScale. The output of each term
+  is truncated toward zero as in float mode, so the two modes agree to
+  within 1 count per non-zero term, from rounding the coefficients to
+  Q15.16. The integral saturates at INTEG_MAX as in float mode, and at
+  INT32_MIN >> PARAM_SHIFT on the low side instead of INTEG_MIN.
+  The derivative resolves input changes of 1/inputScale; float mode
+  truncates the change in error to a whole unit first, so with inputScale
+  above 1 the D terms can differ.
+
+  The defaults reproduce the original controller. setDerivative() and
+  setAntiWindup() select a different form:
+  - DERIV_ON_MEASUREMENT differentiates -fb instead of the error, so a
+    setpoint change does not kick the output. An optional first order
+    filter with a time constant in seconds smooths the derivative.
+  - WINDUP_CONDITIONAL stops integrating while the output is saturated
+    and the error would push it further. WINDUP_BACK_CALCULATION feeds
+    the saturated part of the output back into the integral, with a
+    tracking time constant in seconds (0 uses sqrt(Ti Td), or Ti without
+    a D term). Both limit the
+    integral to the output range rather than INTEG_MAX.
+  setCoefficients() moves the integral by the change in the P term at
+  the last error and in the D term at the last (filtered) derivative, so
+  new gains do not bump the output. A ki of 0 stops the integral where it
+  is rather than dropping it from the output; with no integral at all
+  there is nothing to absorb the change. A kd going from 0 starts from
+  the derivative as it is.
 */
 class FastPID {
 
 public:
+  enum DerivativeSource { DERIV_ON_ERROR, DERIV_ON_MEASUREMENT };
+  enum WindupMode { WINDUP_CLAMP, WINDUP_CONDITIONAL, WINDUP_BACK_CALCULATION };
+
   FastPID() 
   {
     clear();
@@ -23,25 +62,60 @@ public:
 
   FastPID(float kp, float ki, float kd, float hz)
   {
+    clear();
     setCoefficients(kp,ki,kd,hz);
   }
 
   ~FastPID();
 
-  void setCoefficients(float kp, float ki, float kd, float hz);
+  // In integer mode, returns false and keeps the old gains if a new
+  // coefficient scaled by 1/inputScale does not fit Q15.16.
+  bool setCoefficients(float kp, float ki, float kd, float hz);
   void setOutputRange(int16_t min, int16_t max);
+  void setDerivative(DerivativeSource source, float filterSeconds = 0);
+  void setAntiWindup(WindupMode mode, float trackingSeconds = 0);
   void clear();
   int16_t step(float sp, float fb);
 
+  // Returns false, and stays in float mode, if a coefficient scaled by
+  // 1/inputScale does not fit Q15.16. Switching keeps the integral and the
+  // last error, so it is bumpless.
+  bool setIntegerMode(bool enable, int16_t inputScale = 1);
+  bool integerMode() const { return _fixed; }
+  int16_t inputScale() const { return _scale; }
+  // Integer mode step, sp and fb in units of 1/inputScale. In float mode
+  // the inputs are converted and the float step() runs.
+  int16_t stepInt(int16_t sp, int16_t fb);
+
 private:
 
+  void derive();
+  bool quantize(float p, float i, float d, int32_t &pq, int32_t &iq, int32_t &dq) const;
+  int16_t stepFixed(int32_t sp, int32_t fb);
+
   // Configuration
-  float _p, _i, _d;
-  int16_t _outmax, _outmin; 
+  float _p = 0, _i = 0, _d = 0;
+  float _hz = 1;
+  int16_t _outmax = INT16_MAX, _outmin = 0; 
+  bool _fixed = false;
+  int16_t _scale = 1;
+  int32_t _pq = 0, _iq = 0, _dq = 0; // Q15.16, per input count
+  DerivativeSource _dsource = DERIV_ON_ERROR;
+  WindupMode _windup = WINDUP_CLAMP;
+  float _tf = 0, _tt = 0;   // seconds
+  float _alpha = 1, _kt = 1; // per step, from _tf and _tt
+  int32_t _alphaq = PARAM_MULT, _ktq = PARAM_MULT; // Q15.16
   
   // State
   float _sum;
   float _last_err;
+  float _last_fb;
+  float _dfilt;
+  int32_t _isum;      // Q15.16, output units
+  int32_t _last_ierr; // input counts
+  int32_t _last_ifb;
+  int32_t _idfilt;    // Q15.16, input counts
+  bool _primed;       // _last_fb holds a reading
 };
 
 #endif
@@ -0,0 +1,149 @@
+#include "FastPIDAutotune.h"
+#include "FastPID.h"
+
+#include <math.h>
+
+#define SKIP_CYCLES 2
+
+bool FastPIDAutotune::begin(float hz, int16_t outMin, int16_t outMax, int16_t amplitude,
+                            float hysteresis, uint8_t cycles, uint32_t timeout) {
+  if (hz <= 0 || outMin >= outMax || amplitude <= 0 || 2 * int32_t(amplitude) > int32_t(outMax) - outMin ||
+      hysteresis < 0 || cycles == 0) {
+    _state = FAILED;
+    return false;
+  }
+
+  _hz = hz;
+  _hyst = hysteresis;
+  _outmin = outMin;
+  _outmax = outMax;
+  _amp = amplitude;
+  _target = cycles;
+  _timeout = timeout;
+
+  _high = true;
+  _approach = true;
+  _bias = int32_t(outMin) + amplitude;
+  _steps = _upAt = _downAt = 0;
+  _max = _min = 0;
+  _cycles = 0;
+  _ampSum = _periodSum = 0;
+  _ku = _pu = 0;
+  _state = RUNNING;
+  return true;
+}
+
+void FastPIDAutotune::cancel() {
+  if (_state == RUNNING)
+    _state = IDLE;
+}
+
+int16_t FastPIDAutotune::step(float sp, float fb) {
+  if (_state != RUNNING)
+    return _outmin;
+
+  _steps++;
+  if (_timeout && _steps > _timeout) {
+    _state = FAILED;
+    return _outmin;
+  }
+
+  if (_high) {
+    if (fb < _min)
+      _min = fb;
+    if (fb > sp + _hyst) {
+      _high = false;
+      _downAt = _steps;
+      _max = fb;
+    }
+  }
+  else {
+    if (fb > _max)
+      _max = fb;
+    if (fb < sp - _hyst) {
+      _high = true;
+      if (_approach)
+        _approach = false;
+      else
+        finishCycle();
+      _upAt = _steps;
+      _min = fb;
+    }
+  }
+
+  if (_state != RUNNING)
+    return _outmin;
+  if (_approach)
+    return _high ? _outmax : _outmin;
+
+  int32_t out = _high ? _bias + _amp : _bias - _amp;
+  if (out > _outmax)
+    out = _outmax;
+  else if (out < _outmin)
+    out = _outmin;
+  return out;
+}
+
+// Called on the switch to high that closes a cycle: _max came from the low
+// half just ended, _min from the high half before it
+void FastPIDAutotune::finishCycle() {
+  uint32_t high = _downAt - _upAt;
+  uint32_t low = _steps - _downAt;
+
+  // Even out the halves, a long low half means too much heat on average
+  _bias -= int32_t(_amp) * (int32_t(low) - int32_t(high)) / int32_t(low + high);
+  if (_bias < int32_t(_outmin) + _amp)
+    _bias = int32_t(_outmin) + _amp;
+  else if (_bias > int32_t(_outmax) - _amp)
+    _bias = int32_t(_outmax) - _amp;
+
+  // Let the bias and the transient from the approach settle
+  if (++_cycles <= SKIP_CYCLES)
+    return;
+
+  _ampSum += (_max - _min) / 2;
+  _periodSum += (low + high) / _hz;
+
+  if (_cycles - SKIP_CYCLES < _target)
+    return;
+
+  float a = _ampSum / _target;
+  float h = a > _hyst ? sqrtf(a * a - _hyst * _hyst) : a;
+  if (h <= 0) {
+    _state = FAILED;
+    return;
+  }
+  _ku = 4 * _amp / (float(M_PI) * h);
+  _pu = _periodSum / _target;
+  _state = DONE;
+}
+
+PIDGains FastPIDAutotune::gains(TuningRule rule) const {
+  PIDGains g = {0, 0, 0};
+  if (_state != DONE)
+    return g;
+
+  float ti, td;
+  if (rule == TUNE_ZIEGLER_NICHOLS) {
+    g.kp = 0.6f * _ku;
+    ti = _pu / 2;
+    td = _pu / 8;
+  }
+  else {
+    g.kp = _ku / 2.2f;
+    ti = 2.2f * _pu;
+    td = _pu / 6.3f;
+  }
+  g.ki = g.kp / ti;
+  g.kd = g.kp * td;
+  return g;
+}
+
+bool FastPIDAutotune::apply(FastPID &pid, TuningRule rule) const {
+  if (_state != DONE)
+    return false;
+  PIDGains g = gains(rule);
+  pid.setCoefficients(g.kp, g.ki, g.kd, _hz);
+  pid.clear();
+  return true;
+}
@@ -0,0 +1,78 @@
+#ifndef FastPIDAutotune_H
+#define FastPIDAutotune_H
+
+#include <stdint.h>
+
+class FastPID;
+
+struct PIDGains {
+  float kp, ki, kd;
+};
+
+// Tuning rules, from the ultimate gain Ku and period Pu
+enum TuningRule {
+  TUNE_ZIEGLER_NICHOLS,  // Kp 0.6 Ku, Ti Pu/2, Td Pu/8: fast, overshoots
+  TUNE_TYREUS_LUYBEN     // Kp Ku/2.2, Ti 2.2 Pu, Td Pu/6.3: less overshoot
+};
+
+/*
+  Relay feedback autotuner (Astrom-Hagglund). While running, step() takes
+  the place of FastPID::step(): the output is driven to outMax until the
+  process first reaches the setpoint, then switches between bias + amplitude
+  and bias - amplitude each time the feedback leaves the hysteresis band.
+  The process settles into a limit cycle at its ultimate period Pu. Its
+  amplitude a gives the ultimate gain, Ku = 4 d / (pi sqrt(a^2 - h^2)).
+
+  The bias is adjusted every cycle so the high and low halves last the same
+  time. This keeps the cycle symmetric on processes, such as a boiler, that
+  heat much faster than they cool. The first two cycles are discarded while
+  it settles.
+
+  Call step() at the same hz as the controller it tunes.
+*/
+class FastPIDAutotune {
+
+public:
+  enum State { IDLE, RUNNING, DONE, FAILED };
+
+  FastPIDAutotune() : _state(IDLE) {}
+
+  // amplitude in output counts, hysteresis in input units. timeout in
+  // steps, 0 for none. Returns false on a bad configuration.
+  bool begin(float hz, int16_t outMin, int16_t outMax, int16_t amplitude,
+             float hysteresis, uint8_t cycles = 4, uint32_t timeout = 0);
+  void cancel();
+  int16_t step(float sp, float fb);
+
+  State state() const { return _state; }
+  uint8_t cycles() const { return _cycles; }  // completed so far
+  float ultimateGain() const { return _ku; }  // output counts per input unit
+  float ultimatePeriod() const { return _pu; } // seconds
+
+  // Valid once state() is DONE
+  PIDGains gains(TuningRule rule) const;
+  bool apply(FastPID &pid, TuningRule rule) const;
+
+private:
+  void finishCycle();
+
+  // Configuration
+  float _hz, _hyst;
+  int16_t _outmin, _outmax, _amp;
+  uint8_t _target;
+  uint32_t _timeout;
+
+  // State
+  State _state;
+  bool _high, _approach;
+  int32_t _bias;
+  uint32_t _steps, _upAt, _downAt;
+  float _max, _min;
+  uint8_t _cycles;
+  float _ampSum, _periodSum;
+
+  // Result
+  float _ku, _pu;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef FastPIDBank_H
+#define FastPIDBank_H
+
+#include <stdint.h>
+#include "FastPID.h"
+#include "FastPIDFixed.h"
+
+/*
+  N integer mode controllers stepped in one call. Coefficients and state
+  are kept as one array per field, so a step walks each array in order
+  and no per-loop object or pointer is involved. The bank allocates
+  nothing and the constructor is constexpr, so a bank can be a global
+  that is zero initialized before setup() runs.
+
+  Each loop behaves exactly like a FastPID in integer mode with the same
+  coefficients, input scale, output range and form. Every loop outputs 0
+  until setOutputRange() is called for it, and the form defaults to the
+  original one as in FastPID. Loop indices are not checked.
+
+  The float configuration of each loop is kept so the form can be changed
+  after the gains; it is not touched by step().
+*/
+template <uint8_t N>
+class FastPIDBank {
+
+public:
+  constexpr FastPIDBank()
+    : _p(), _i(), _d(), _hz(), _tf(), _tt(),
+      _pq(), _iq(), _dq(), _alphaq(), _ktq(), _outmin(), _outmax(), _dsource(), _windup(),
+      _isum(), _last_err(), _last_fb(), _dfilt(), _primed() {}
+
+  static constexpr uint8_t size() { return N; }
+
+  // Returns false, and leaves the loop as it was, if a coefficient scaled
+  // by 1/inputScale does not fit Q15.16. Bumpless like FastPID.
+  bool setCoefficients(uint8_t loop, float kp, float ki, float kd, float hz, int16_t inputScale = 1) {
+    int32_t pq, iq, dq;
+    if (hz <= 0 || inputScale < 1 ||
+        !FastPIDFixed::toParam(kp / inputScale, pq) ||
+        !FastPIDFixed::toParam(ki / hz / inputScale, iq) ||
+        !FastPIDFixed::toParam(kd * hz / inputScale, dq))
+      return false;
+
+    if (ki || _isum[loop])
+      _isum[loop] = FastPIDFixed::bumpless(_isum[loop], _pq[loop], pq, _last_err[loop], _dq[loop], dq, _dfilt[loop]);
+    _p[loop] = kp;
+    _i[loop] = ki / hz;
+    _d[loop] = kd * hz;
+    _hz[loop] = hz;
+    _pq[loop] = pq;
+    _iq[loop] = iq;
+    _dq[loop] = dq;
+    derive(loop);
+    return true;
+  }
+
+  void setOutputRange(uint8_t loop, int16_t min, int16_t max) {
+    _outmin[loop] = min;
+    _outmax[loop] = max;
+  }
+
+  void setDerivative(uint8_t loop, FastPID::DerivativeSource source, float filterSeconds = 0) {
+    _dsource[loop] = source;
+    _tf[loop] = filterSeconds > 0 ? filterSeconds : 0;
+    derive(loop);
+  }
+
+  void setAntiWindup(uint8_t loop, FastPID::WindupMode mode, float trackingSeconds = 0) {
+    _windup[loop] = mode;
+    _tt[loop] = trackingSeconds > 0 ? trackingSeconds : 0;
+    derive(loop);
+  }
+
+  void clear(uint8_t loop) {
+    _isum[loop] = 0;
+    _last_err[loop] = 0;
+    _last_fb[loop] = 0;
+    _dfilt[loop] = 0;
+    _primed[loop] = false;
+  }
+
+  void clear() {
+    for (uint8_t n = 0; n < N; n++)
+      clear(n);
+  }
+
+  // One loop, sp and fb in units of 1/inputScale
+  int16_t step(uint8_t loop, int16_t sp, int16_t fb) {
+    return FastPIDFixed::step(sp, fb, _pq[loop], _iq[loop], _dq[loop], _alphaq[loop], _ktq[loop],
+                              _outmin[loop], _outmax[loop], _dsource[loop], _windup[loop],
+                              _isum[loop], _last_err[loop], _last_fb[loop], _dfilt[loop], _primed[loop]);
+  }
+
+  // Every loop, out[n] from sp[n] and fb[n]
+  void step(const int16_t *sp, const int16_t *fb, int16_t *out) {
+    for (uint8_t n = 0; n < N; n++)
+      out[n] = step(n, sp[n], fb[n]);
+  }
+
+private:
+  void derive(uint8_t loop) {
+    float alpha, kt;
+    FastPIDFixed::derive(_p[loop], _i[loop], _d[loop], _hz[loop], _tf[loop], _tt[loop], alpha, kt);
+    FastPIDFixed::toParam(alpha, _alphaq[loop]);
+    FastPIDFixed::toParam(kt, _ktq[loop]);
+  }
+
+  // Configuration, per step coefficients as in FastPID
+  float _p[N], _i[N], _d[N];
+  float _hz[N];
+  float _tf[N], _tt[N];      // seconds
+  int32_t _pq[N], _iq[N], _dq[N]; // Q15.16, per input count
+  int32_t _alphaq[N], _ktq[N];    // Q15.16
+  int16_t _outmin[N], _outmax[N];
+  uint8_t _dsource[N];
+  uint8_t _windup[N];
+
+  // State
+  int32_t _isum[N];     // Q15.16, output units
+  int32_t _last_err[N]; // input counts
+  int32_t _last_fb[N];
+  int32_t _dfilt[N];    // Q15.16, input counts
+  bool _primed[N];
+};
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef FastPIDFixed_H
+#define FastPIDFixed_H
+
+#include <stdint.h>
+#include <math.h>
+#include "FastPID.h"
+
+/*
+  The integer pipeline of FastPID, shared with FastPIDBank. Coefficients
+  and state are passed by reference so each keeps its own layout: members
+  of one controller, or arrays indexed by loop.
+*/
+namespace FastPIDFixed {
+
+// Q15.16, rounded. False if it does not fit.
+inline bool toParam(float in, int32_t &out) {
+  float q = in * PARAM_MULT;
+  if (q >= 2147483647.0f || q <= -2147483648.0f)
+    return false;
+  out = q < 0 ? int32_t(q - 0.5f) : int32_t(q + 0.5f);
+  return true;
+}
+
+// Division, unlike a shift, truncates toward zero as the float casts do
+inline int32_t fromParam(int64_t v) {
+  return v / PARAM_MULT;
+}
+
+// Per step derivative filter and back-calculation constants from the
+// per step coefficients p, i, d. Tracking time defaults to sqrt(Ti Td),
+// or Ti without a D term.
+inline void derive(float p, float i, float d, float hz, float tf, float tt,
+                   float &alpha, float &kt) {
+  alpha = tf > 0 ? 1 / (1 + tf * hz) : 1;
+
+  float ti = i ? p / (i * hz) : 0;
+  float td = p ? d / (p * hz) : 0;
+  if (tt <= 0)
+    tt = td > 0 ? sqrtf(ti * td) : ti;
+  kt = tt > 0 ? 1 / (tt * hz) : 1;
+  if (kt > 1)
+    kt = 1;
+}
+
+// Move the integral so P + I + D at the last error and filtered derivative
+// stays where it was. With oldDq 0 the filter did not run, the D term
+// starts from dfilt as it is.
+inline int32_t bumpless(int32_t isum, int32_t oldPq, int32_t pq, int32_t lastErr,
+                        int32_t oldDq, int32_t dq, int32_t dfilt) {
+  int64_t sum = int64_t(isum) + (int64_t(oldPq) - pq) * lastErr;
+  if (oldDq) {
+    // D as step() works it out, each product within int63
+    int64_t oldD = int64_t(oldDq) * dfilt / (int64_t(PARAM_MULT) * PARAM_MULT);
+    int64_t newD = int64_t(dq) * dfilt / (int64_t(PARAM_MULT) * PARAM_MULT);
+    sum += (oldD - newD) * PARAM_MULT;
+  }
+  return sum > INT32_MAX ? INT32_MAX : sum < INT32_MIN ? INT32_MIN : int32_t(sum);
+}
+
+// One step, sp and fb in input counts. alphaq filters the derivative
+// when it is between 0 and PARAM_MULT. Always inlined, so with constant
+// coefficients (FastPIDStatic) the unused terms and modes fold away.
+inline __attribute__((always_inline)) int16_t step(int32_t sp, int32_t fb,
+                    int32_t pq, int32_t iq, int32_t dq, int32_t alphaq, int32_t ktq,
+                    int16_t outmin, int16_t outmax, uint8_t dsource, uint8_t windup,
+                    int32_t &isum, int32_t &lastErr, int32_t &lastFb, int32_t &dfilt, bool &primed) {
+  // int16 - int16 = int17
+  int32_t err = sp - fb;
+  int32_t P = 0, I = 0, D = 0;
+
+  if (pq) {
+    // int32 * int17 = int49
+    P = fromParam(int64_t(pq) * err);
+  }
+
+  if (dq) {
+    // int17 - int17 = int18
+    int32_t deriv;
+    if (dsource == FastPID::DERIV_ON_MEASUREMENT)
+      deriv = primed ? lastFb - fb : 0;
+    else
+      deriv = err - lastErr;
+
+    // Limit the derivative to 16-bit signed value.
+    if (deriv > DERIV_MAX)
+      deriv = DERIV_MAX;
+    else if (deriv < DERIV_MIN)
+      deriv = DERIV_MIN;
+
+    if (alphaq > 0 && alphaq < PARAM_MULT) {
+      // The filter stays within the derivative limits: int16 in Q15.16
+      // = int32, Q15.16 * int33 = int50
+      dfilt += fromParam(int64_t(alphaq) * (int64_t(deriv) * PARAM_MULT - dfilt));
+      // int32 * int32 = int63, Q15.16 * Q15.16
+      D = int64_t(dq) * dfilt / (int64_t(PARAM_MULT) * PARAM_MULT);
+    }
+    else {
+      // int32 * int16 = int48
+      D = fromParam(int64_t(dq) * deriv);
+      // kept for bumpless gain changes, int16 in Q15.16 fits int32
+      dfilt = deriv * PARAM_MULT;
+    }
+  }
+  lastErr = err;
+  lastFb = fb;
+  primed = true;
+
+  if (iq) {
+    // int32 * int17 = int49, saturated back into the int32 sum
+    int64_t sum = int64_t(isum) + int64_t(iq) * err;
+    int64_t lo = INT32_MIN, hi = int64_t(INTEG_MAX) * PARAM_MULT;
+    if (windup != FastPID::WINDUP_CLAMP) {
+      lo = int64_t(outmin) * PARAM_MULT;
+      hi = int64_t(outmax) * PARAM_MULT;
+    }
+    if (sum > hi)
+      sum = hi;
+    else if (sum < lo)
+      sum = lo;
+
+    if (windup == FastPID::WINDUP_CONDITIONAL) {
+      // Hold the integral while it would drive a saturated output further
+      int64_t v = int64_t(P) + fromParam(sum) + D;
+      if ((v > outmax && err > 0) || (v < outmin && err < 0))
+        sum = isum;
+    }
+    isum = sum;
+  }
+  // Held at its last value while iq is 0
+  I = fromParam(isum);
+
+  // int32 (P) + int32 (I) + int32 (D) = int34
+  int64_t out = int64_t(P) + int64_t(I) + int64_t(D);
+
+  // Make the output saturate
+  int64_t sat = out;
+  if (sat > outmax)
+    sat = outmax;
+  else if (sat < outmin)
+    sat = outmin;
+
+  if (iq && windup == FastPID::WINDUP_BACK_CALCULATION && sat != out) {
+    // Q15.16 * int35, the difference is bounded by the saturated terms
+    int64_t sum = int64_t(isum) + int64_t(ktq) * (sat - out);
+    int64_t lo = int64_t(outmin) * PARAM_MULT, hi = int64_t(outmax) * PARAM_MULT;
+    isum = sum > hi ? hi : sum < lo ? lo : sum;
+  }
+
+  return sat;
+}
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef FastPIDStatic_H
+#define FastPIDStatic_H
+
+#include <stdint.h>
+#include "FastPID.h"
+#include "FastPIDFixed.h"
+
+// FastPIDStatic gains, rates and times are template parameters in
+// thousandths: Kp 14.4 is 14400, Hz 0.5 is 500.
+#define STATIC_PARAM_MULT 1000
+
+namespace FastPIDFixed {
+
+// Rounded to nearest, d > 0
+constexpr int64_t divRound(int64_t n, int64_t d) {
+  return (n < 0 ? n - d / 2 : n + d / 2) / d;
+}
+
+constexpr int64_t sqrtBetween(int64_t v, int64_t lo, int64_t hi) {
+  return lo >= hi ? lo
+       : ((lo + hi + 1) / 2) * ((lo + hi + 1) / 2) <= v ? sqrtBetween(v, (lo + hi + 1) / 2, hi)
+       : sqrtBetween(v, lo, (lo + hi + 1) / 2 - 1);
+}
+
+// Integer square root, rounded down
+constexpr int64_t isqrt(int64_t v) {
+  return v > 0 ? sqrtBetween(v, 0, 3037000499LL) : 0;
+}
+
+constexpr bool fits(int64_t q) {
+  return q >= INT32_MIN && q <= INT32_MAX;
+}
+
+}
+
+/*
+  An integer mode FastPID whose gains, rate, output range and form are
+  fixed at compile time. Template parameters that are not whole numbers
+  are in 1/STATIC_PARAM_MULT: Kp, Ki, Kd, Hz, FilterS and TrackingS.
+
+  The Q15.16 coefficients and the filter and tracking constants are
+  worked out by the compiler, so there is no setCoefficients() and no
+  float anywhere. step() runs the FastPID integer step with those
+  constants, so a term whose coefficient is zero, an unused derivative
+  filter and the unused windup modes are compiled out. Inputs are in
+  units of 1/InputScale as in FastPID::stepInt().
+
+  Outputs agree with a FastPID in integer mode with the same settings to
+  within a count or two per term: here the coefficients are rounded once
+  from the exact ratio, there from float.
+*/
+template <int32_t Kp, int32_t Ki, int32_t Kd, int32_t Hz, int16_t OutMin, int16_t OutMax,
+          int16_t InputScale = 1,
+          FastPID::DerivativeSource Source = FastPID::DERIV_ON_ERROR, int32_t FilterS = 0,
+          FastPID::WindupMode Windup = FastPID::WINDUP_CLAMP, int32_t TrackingS = 0>
+class FastPIDStatic {
+
+  static constexpr int64_t M = STATIC_PARAM_MULT;
+
+  // Ti = Kp / Ki and Td = Kd / Kp in seconds; tracking defaults to
+  // sqrt(Ti Td) = sqrt(Kd / Ki), or Ti without a D term
+  static constexpr bool hasTd = Kp != 0 && Kd != 0 && (Kd > 0) == (Kp > 0);
+  static constexpr int64_t ti = Ki ? FastPIDFixed::divRound(M * Kp, Ki) : 0;
+  static constexpr int64_t tt = TrackingS > 0 ? TrackingS
+                              : hasTd && Ki > 0 ? FastPIDFixed::isqrt(FastPIDFixed::divRound(M * M * Kd, Ki))
+                              : ti > 0 ? ti : 0;
+  static constexpr int64_t ktq = tt > 0 ? FastPIDFixed::divRound(PARAM_MULT * M * M, tt * Hz) : PARAM_MULT;
+
+public:
+  // Q15.16, per input count
+  static constexpr int32_t pq = FastPIDFixed::divRound(int64_t(Kp) * PARAM_MULT, M * InputScale);
+  static constexpr int32_t iq = FastPIDFixed::divRound(int64_t(Ki) * PARAM_MULT, int64_t(Hz) * InputScale);
+  static constexpr int32_t dq = FastPIDFixed::divRound(int64_t(Kd) * Hz * PARAM_MULT, M * M * InputScale);
+  // Q15.16, per step
+  static constexpr int32_t alphaq = FilterS > 0 ? FastPIDFixed::divRound(PARAM_MULT * M * M, M * M + int64_t(FilterS) * Hz)
+                                                : PARAM_MULT;
+  static constexpr int32_t trackq = ktq > PARAM_MULT ? PARAM_MULT : ktq;
+
+  static_assert(Hz > 0, "FastPIDStatic: Hz must be positive");
+  static_assert(InputScale > 0, "FastPIDStatic: InputScale must be positive");
+  static_assert(OutMin < OutMax, "FastPIDStatic: OutMin must be below OutMax");
+  static_assert(FastPIDFixed::fits(FastPIDFixed::divRound(int64_t(Kp) * PARAM_MULT, M * InputScale)) &&
+                FastPIDFixed::fits(FastPIDFixed::divRound(int64_t(Ki) * PARAM_MULT, int64_t(Hz) * InputScale)) &&
+                FastPIDFixed::fits(FastPIDFixed::divRound(int64_t(Kd) * Hz * PARAM_MULT, M * M * InputScale)),
+                "FastPIDStatic: a coefficient does not fit Q15.16");
+
+  constexpr FastPIDStatic() : _isum(0), _last_err(0), _last_fb(0), _dfilt(0), _primed(false) {}
+
+  void clear() {
+    _isum = 0;
+    _last_err = 0;
+    _last_fb = 0;
+    _dfilt = 0;
+    _primed = false;
+  }
+
+  int16_t step(int16_t sp, int16_t fb) {
+    return FastPIDFixed::step(sp, fb, pq, iq, dq, alphaq, trackq, OutMin, OutMax, Source, Windup,
+                              _isum, _last_err, _last_fb, _dfilt, _primed);
+  }
+
+private:
+  int32_t _isum;     // Q15.16, output units
+  int32_t _last_err; // input counts
+  int32_t _last_fb;
+  int32_t _dfilt;    // Q15.16, input counts
+  bool _primed;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "ScheduledPID.h"
+
+static PIDGains lerp(const PIDGains &a, const PIDGains &b, float w) {
+  PIDGains g;
+  g.kp = a.kp + (b.kp - a.kp) * w;
+  g.ki = a.ki + (b.ki - a.ki) * w;
+  g.kd = a.kd + (b.kd - a.kd) * w;
+  return g;
+}
+
+ScheduledPID::ScheduledPID(float hz, const PIDGains &gains, uint8_t transitionSteps)
+  : _pid(gains.kp, gains.ki, gains.kd, hz), _hz(hz), _transition(transitionSteps),
+    _phase(0), _blend(transitionSteps), _from(gains), _applied(gains),
+    _countScale(0), _held(0)
+{
+  for (uint8_t i = 0; i < SCHEDULE_PHASES; i++)
+    setGains(i, gains);
+}
+
+void ScheduledPID::setGains(uint8_t phase, const PIDGains &gains) {
+  GainSet set = { gains, gains, 0, 0 };
+  setGains(phase, set);
+}
+
+void ScheduledPID::setGains(uint8_t phase, const GainSet &set) {
+  _sets[phase % SCHEDULE_PHASES] = set;
+  _countScale = 0;
+  _held = 0;
+}
+
+void ScheduledPID::clear() {
+  _pid.clear();
+  _blend = _transition;
+}
+
+PIDGains ScheduledPID::target(uint8_t phase, float err) const {
+  const GainSet &s = _sets[phase];
+  if (err < 0)
+    err = -err;
+  if (err <= s.nearError)
+    return s.near;
+  if (err >= s.farError)
+    return s.far;
+  return lerp(s.near, s.far, (err - s.nearError) / (s.farError - s.nearError));
+}
+
+// Target gains, part way from _from while a phase change blends
+PIDGains ScheduledPID::blended(uint8_t phase, float err) {
+  PIDGains g = target(phase, err);
+  if (_blend < _transition) {
+    _blend++;
+    g = lerp(_from, g, float(_blend) / _transition);
+  }
+  return g;
+}
+
+void ScheduledPID::enter(uint8_t phase) {
+  if (phase == _phase)
+    return;
+  _phase = phase;
+  _from = _applied;
+  _blend = 0;
+  _held = 0;
+}
+
+// False if integer mode refused the gains, the old ones stay
+bool ScheduledPID::apply(const PIDGains &g) {
+  if (g.kp == _applied.kp && g.ki == _applied.ki && g.kd == _applied.kd)
+    return true;
+  if (!_pid.setCoefficients(g.kp, g.ki, g.kd, _hz))
+    return false;
+  _applied = g;
+  return true;
+}
+
+int16_t ScheduledPID::step(uint8_t phase, float sp, float fb) {
+  phase %= SCHEDULE_PHASES;
+  enter(phase);
+  _held = 0;
+  apply(blended(phase, sp - fb));
+  return _pid.step(sp, fb);
+}
+
+int16_t ScheduledPID::stepInt(uint8_t phase, int16_t sp, int16_t fb) {
+  phase %= SCHEDULE_PHASES;
+  enter(phase);
+
+  int16_t scale = _pid.inputScale();
+  if (_countScale != scale) {
+    for (uint8_t i = 0; i < SCHEDULE_PHASES; i++) {
+      _near[i] = _sets[i].nearError * scale;
+      _far[i] = _sets[i].farError * scale;
+    }
+    _countScale = scale;
+  }
+
+  int32_t err = int32_t(sp) - fb;
+  if (err < 0)
+    err = -err;
+  const GainSet &s = _sets[phase];
+  const PIDGains *held = err <= _near[phase] ? &s.near : err >= _far[phase] ? &s.far : 0;
+  if (held && _blend >= _transition) {
+    if (held != _held && apply(*held))
+      _held = held;
+  }
+  else {
+    _held = 0;
+    apply(blended(phase, float(err) / scale));
+  }
+  return _pid.stepInt(sp, fb);
+}
@@ -0,0 +1,74 @@
+#ifndef ScheduledPID_H
+#define ScheduledPID_H
+
+#include <stdint.h>
+#include "FastPID.h"
+#include "FastPIDAutotune.h"
+
+#define SCHEDULE_PHASES 8
+
+// Gains for one phase. At or below nearError (input units, either sign)
+// the near gains apply, at or above farError the far gains, linearly
+// interpolated in between.
+struct GainSet {
+  PIDGains near, far;
+  float nearError, farError;
+};
+
+/*
+  A FastPID whose gains follow a schedule: one GainSet per phase, a small
+  integer the caller chooses (Brewhob passes its State). Each step picks
+  the gains for the phase and the error magnitude. After a phase change
+  the gains blend from where they were to the new set over a number of
+  steps. Gains are only handed to FastPID::setCoefficients() when they
+  change, which moves the integral so the output does not jump.
+
+  Configure the form, output range and integer mode on pid(). In integer
+  mode use stepInt(): within the near or far errors, once a blend is
+  over, it picks the gains without float math and leaves them alone.
+  Blending after a phase change, or between nearError and farError, the
+  gains are still worked out in float and quantized on every step.
+*/
+class ScheduledPID {
+
+public:
+  ScheduledPID(float hz, const PIDGains &gains, uint8_t transitionSteps = 0);
+
+  FastPID &pid() { return _pid; }
+
+  void setGains(uint8_t phase, const PIDGains &gains); // near and far alike
+  void setGains(uint8_t phase, const GainSet &set);
+  const GainSet &gains(uint8_t phase) const { return _sets[phase % SCHEDULE_PHASES]; }
+  void setTransition(uint8_t steps) { _transition = steps; }
+
+  int16_t step(uint8_t phase, float sp, float fb);
+  // sp and fb in units of 1/inputScale, as FastPID::stepInt()
+  int16_t stepInt(uint8_t phase, int16_t sp, int16_t fb);
+  PIDGains current() const { return _applied; } // gains of the last step
+  void clear();
+
+private:
+  PIDGains target(uint8_t phase, float err) const;
+  PIDGains blended(uint8_t phase, float err);
+  void enter(uint8_t phase);
+  bool apply(const PIDGains &g);
+
+  FastPID _pid;
+  float _hz;
+  GainSet _sets[SCHEDULE_PHASES];
+  uint8_t _transition;
+
+  uint8_t _phase;
+  uint8_t _blend;     // steps since the phase changed
+  PIDGains _from;     // gains when it changed
+  PIDGains _applied;
+
+  // stepInt(): errors of each set in input counts, worked out for
+  // _countScale (0 once a set changes), and the near or far gains
+  // applied unblended, or 0
+  int32_t _near[SCHEDULE_PHASES], _far[SCHEDULE_PHASES];
+  int16_t _countScale;
+  const PIDGains *_held;
+};
+
+#endif
@@ -1,20 +1,20 @@
 #! /usr/bin/python3
 
-import distutils.sysconfig 
-from distutils.core import setup, Extension
+from setuptools import setup, Extension
 
 # build the harness. 
 ext = Extension('ArduinoPID',
                      sources = ['arduinopid_wrapper.cpp', 'arduinopid_lib/PID_v1.cpp'],
-                     include_dirs = ['Arduino-PID-Library/']
+                     include_dirs = ['arduinopid_lib/', 'emulation/'],
+                     extra_compile_args = ['-std=c++11', '-DARDUINO=100', '-O2']
 )
 
-# install
+# build next to the test scripts
 setup (name = 'ArduinoPID',
        version = '1.0',
        description = 'Test harness for my a reference PID controller',
        ext_modules = [ext],
-       script_args = ['install', '--install-platlib=./']
+       script_args = ['build_ext', '--inplace']
 )
 
 # test
@@ -11,39 +11,28 @@ configure(PyObject *self, PyObject *args) {
   float kp;
   float ki;
   float kd; 
-  int bits=16; 
-  bool sign=false;
+  float hz = 1;
+  int outmin = 0;
+  int outmax = INT16_MAX;
   
-  if (!PyArg_ParseTuple(args, "fffib", &kp, &ki, &kd, &bits, &sign))
+  if (!PyArg_ParseTuple(args, "fff|fii", &kp, &ki, &kd, &hz, &outmin, &outmax))
     return NULL;
 
-  int64_t outmax, outmin;
-  if (bits > 16 || bits < 1) {
+  if (hz <= 0 || outmin > outmax)
     return PyBool_FromLong(false);
-  }  
-  else {
-    if (sign) {
-      outmax = ((0x1ULL << (bits - 1)) - 1);
-      outmin = -((0x1ULL << (bits - 1)));
-    }
-    else {
-      outmax = ((0x1ULL << bits) - 1);
-      outmin = 0;
-    }
-  }
 
   pid.SetTunings(kp, ki, kd);
   pid.SetOutputLimits(outmin, outmax);
   pid.SetMode(AUTOMATIC);
-  pid.SetSampleTime(1000); 
+  pid.SetSampleTime(1000 / hz); 
   return PyBool_FromLong(true);
 }
 
 static PyObject *
 step(PyObject *self, PyObject *args) {
-  int sp; 
-  int fb;
-  if (!PyArg_ParseTuple(args, "ii", &sp, &fb))
+  float sp; 
+  float fb;
+  if (!PyArg_ParseTuple(args, "ff", &sp, &fb))
     return NULL;
 
   Setpoint = sp;
@@ -0,0 +1,114 @@
+/*
+  FastPIDBank benchmark. For N = 2, 4 and 8 it runs N loops of a bank
+  against N FastPID controllers in integer mode, with the same gains and
+  forms, each closed around a first order plant. It fails if any output
+  differs, and reports ns per loop per step for both.
+*/
+#include <chrono>
+#include <stdio.h>
+#include "FastPID.h"
+#include "FastPIDBank.h"
+
+#define STEPS  200000
+#define SCALE  10
+
+static volatile int32_t sink;
+
+struct Loop {
+  float kp, ki, kd, hz;
+  int16_t outmin, outmax;
+  FastPID::DerivativeSource dsource;
+  float filter;
+  FastPID::WindupMode windup;
+};
+
+// Boiler like loops in both forms, plus a faster one with a signed output
+static const Loop loops[] = {
+  { 200, 1,    60, 0.5, 0, 2000, FastPID::DERIV_ON_MEASUREMENT, 4, FastPID::WINDUP_BACK_CALCULATION },
+  { 200, 1,    60, 0.5, 0, 2000, FastPID::DERIV_ON_ERROR,       0, FastPID::WINDUP_CLAMP },
+  { 2.5, 0.8, 0.1,  10, -1000, 1000, FastPID::DERIV_ON_MEASUREMENT, 0.5, FastPID::WINDUP_CONDITIONAL },
+  { 40,  0.2,   0,   1, 0, 1000, FastPID::DERIV_ON_ERROR,       0, FastPID::WINDUP_BACK_CALCULATION },
+};
+#define LOOPS (sizeof(loops) / sizeof(loops[0]))
+
+// Setpoint in 1/SCALE units, stepped every few thousand steps
+static int16_t setpoint(uint8_t n, long t) {
+  return (n % 2 ? 2000 : 2050) + ((t / 3000) % 3) * 40;
+}
+
+// Plant: the feedback moves toward a level set by the output
+static int16_t plant(int16_t fb, int16_t out, const Loop &l) {
+  int32_t target = 700 + int32_t(out) * 2 - l.outmin;
+  return fb + (target - fb) / 64;
+}
+
+template <uint8_t N>
+static bool run() {
+  static FastPIDBank<N> bank;
+  FastPID pid[N];
+  int16_t sp[N], fb[N], fbs[N], out[N];
+
+  for (uint8_t n = 0; n < N; n++) {
+    const Loop &l = loops[n % LOOPS];
+    bank.setCoefficients(n, l.kp, l.ki, l.kd, l.hz, SCALE);
+    bank.setOutputRange(n, l.outmin, l.outmax);
+    bank.setDerivative(n, l.dsource, l.filter);
+    bank.setAntiWindup(n, l.windup);
+
+    pid[n].setCoefficients(l.kp, l.ki, l.kd, l.hz);
+    pid[n].setOutputRange(l.outmin, l.outmax);
+    pid[n].setDerivative(l.dsource, l.filter);
+    pid[n].setAntiWindup(l.windup);
+    pid[n].setIntegerMode(true, SCALE);
+    fb[n] = fbs[n] = 700;
+  }
+
+  // Closed loop, both must agree on every step
+  for (long t = 0; t < STEPS / 10; t++) {
+    for (uint8_t n = 0; n < N; n++)
+      sp[n] = setpoint(n, t);
+    bank.step(sp, fb, out);
+    for (uint8_t n = 0; n < N; n++) {
+      int16_t o = pid[n].stepInt(sp[n], fbs[n]);
+      if (o != out[n]) {
+        printf("N=%d loop %d step %ld: bank %d FastPID %d\n", N, n, t, out[n], o);
+        return false;
+      }
+      fb[n] = fbs[n] = plant(fb[n], out[n], loops[n % LOOPS]);
+    }
+  }
+
+  // Timing, open loop on the last feedback so only the controllers run
+  int32_t acc = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long t = 0; t < STEPS; t++) {
+    sp[0] = setpoint(0, t);
+    bank.step(sp, fb, out);
+    acc += out[N - 1];
+  }
+  auto mid = std::chrono::steady_clock::now();
+  for (long t = 0; t < STEPS; t++) {
+    sp[0] = setpoint(0, t);
+    for (uint8_t n = 0; n < N; n++)
+      out[n] = pid[n].stepInt(sp[n], fb[n]);
+    acc += out[N - 1];
+  }
+  auto end = std::chrono::steady_clock::now();
+  sink = acc;
+
+  double div = double(STEPS) * N;
+  printf("%d      %8.1f       %8.1f\n", N,
+         std::chrono::duration<double, std::nano>(mid - start).count() / div,
+         std::chrono::duration<double, std::nano>(end - mid).count() / div);
+  return true;
+}
+
+int main() {
+  // The bank has to be usable as a constant initialized global
+  static constexpr FastPIDBank<2> zero;
+  static_assert(zero.size() == 2, "FastPIDBank<2>");
+
+  printf("N  bank ns/loop  FastPID ns/loop\n");
+  bool ok = run<2>() && run<4>() && run<8>();
+  return ok ? 0 : 1;
+}
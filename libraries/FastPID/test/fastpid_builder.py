@@ -1,20 +1,20 @@
 #! /usr/bin/python3
 
-import distutils.sysconfig 
-from distutils.core import setup, Extension
+from setuptools import setup, Extension
 
 # build the harness. 
 ext = Extension('FastPID',
                      sources = ['fastpid_wrapper.cpp', '../src/FastPID.cpp'],
-                     include_dirs = ['../src/']
+                     include_dirs = ['../src/', 'emulation/'],
+                     extra_compile_args = ['-std=c++11', '-DARDUINO=100', '-O2']
 )
 
-# install
+# build next to the test scripts
 setup (name = 'FastPID',
        version = '1.0',
        description = 'Test harness for my PID controller',
        ext_modules = [ext],
-       script_args = ['install', '--install-platlib=./']
+       script_args = ['build_ext', '--inplace']
 )
 
 # test
@@ -1,4 +1,5 @@
 #include <Python.h>
+#include <chrono>
 #include "FastPID.h"
 
 FastPID pid; 
@@ -8,28 +9,110 @@ configure(PyObject *self, PyObject *args) {
   float kp;
   float ki;
   float kd; 
-  int bits=16; 
-  bool sign=false;
+  float hz = 1;
+  int outmin = 0;
+  int outmax = INT16_MAX;
 
-  if (!PyArg_ParseTuple(args, "fffib", &kp, &ki, &kd, &bits, &sign))
+  if (!PyArg_ParseTuple(args, "fff|fii", &kp, &ki, &kd, &hz, &outmin, &outmax))
     return NULL;
 
-  return PyBool_FromLong(pid.configure(kp, ki, kd, 1, bits, sign));
+  if (hz <= 0 || outmin > outmax || outmin < INT16_MIN || outmax > INT16_MAX)
+    return PyBool_FromLong(false);
+
+  pid.setIntegerMode(false);
+  pid.setDerivative(FastPID::DERIV_ON_ERROR);
+  pid.setAntiWindup(FastPID::WINDUP_CLAMP);
+  pid.setCoefficients(kp, ki, kd, hz);
+  pid.setOutputRange(outmin, outmax);
+  pid.clear();
+  return PyBool_FromLong(true);
+}
+
+static PyObject *
+integer(PyObject *self, PyObject *args) {
+  int scale = 1;
+  if (!PyArg_ParseTuple(args, "|i", &scale))
+    return NULL;
+
+  return PyBool_FromLong(pid.setIntegerMode(scale > 0, scale > 0 ? scale : 1));
+}
+
+static PyObject *
+form(PyObject *self, PyObject *args) {
+  int measurement = 0;
+  float filter = 0;
+  int windup = FastPID::WINDUP_CLAMP;
+  float tracking = 0;
+  if (!PyArg_ParseTuple(args, "|ifif", &measurement, &filter, &windup, &tracking))
+    return NULL;
+
+  if (windup < FastPID::WINDUP_CLAMP || windup > FastPID::WINDUP_BACK_CALCULATION)
+    return PyBool_FromLong(false);
+
+  pid.setDerivative(measurement ? FastPID::DERIV_ON_MEASUREMENT : FastPID::DERIV_ON_ERROR, filter);
+  pid.setAntiWindup(FastPID::WindupMode(windup), tracking);
+  return PyBool_FromLong(true);
+}
+
+static PyObject *
+clear(PyObject *self, PyObject *args) {
+  pid.clear();
+  Py_RETURN_NONE;
 }
 
 static PyObject *
 step(PyObject *self, PyObject *args) {
-  int sp; 
-  int err;
-  if (!PyArg_ParseTuple(args, "ii", &sp, &err))
+  float sp; 
+  float fb;
+  if (!PyArg_ParseTuple(args, "ff", &sp, &fb))
     return NULL;
 
-  return PyLong_FromLong(pid.step(sp, err));
+  return PyLong_FromLong(pid.step(sp, fb));
+}
+
+// Times step() in C++, calls through Python would swamp it. The feedback
+// walks around the setpoint so the integral does not saturate.
+static PyObject *
+bench(PyObject *self, PyObject *args) {
+  int steps = 1000000;
+  float sp = 0;
+  if (!PyArg_ParseTuple(args, "|if", &steps, &sp))
+    return NULL;
+
+  float fb[64];
+  int16_t fbInt[64];
+  uint16_t lfsr = 0xACE1;
+  float walk = 0;
+  for (int i = 0; i < 64; i++) {
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);
+    walk += int(lfsr % 7) - 3;
+    fb[i] = sp + walk / 10;
+    fbInt[i] = sp * 10 + walk;
+  }
+
+  volatile int16_t sink = 0;
+  pid.clear();
+  auto start = std::chrono::steady_clock::now();
+  if (pid.integerMode())
+    for (int i = 0; i < steps; i++)
+      sink = pid.stepInt(int16_t(sp * 10), fbInt[i & 63]);
+  else
+    for (int i = 0; i < steps; i++)
+      sink = pid.step(sp, fb[i & 63]);
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  (void)sink;
+  pid.clear();
+
+  return PyFloat_FromDouble(double(ns) / steps);
 }
 
 static PyMethodDef PIDMethods[] = {
-    {"configure",  configure, METH_VARARGS, "Configure the PID."},
+    {"configure",  configure, METH_VARARGS, "Configure the PID: kp, ki, kd, hz, outmin, outmax."},
+    {"integer",  integer, METH_VARARGS, "Select integer mode with an input scale, 0 for float mode."},
+    {"form",  form, METH_VARARGS, "Controller form: D on measurement, D filter s, windup mode, tracking s."},
+    {"clear",  clear, METH_VARARGS, "Clear the PID state."},
     {"step",  step, METH_VARARGS, "Run a PID step."},
+    {"bench",  bench, METH_VARARGS, "Average ns per step over n steps."},
     {NULL, NULL, 0, NULL}
 };
 
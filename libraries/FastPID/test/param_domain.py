@@ -1,35 +1,29 @@
-import numpy 
-import scipy 
-import matplotlib.pyplot as plt
-import random 
-import datetime 
-import os 
-import sys
-import time 
-import math
-import argparse
-import matplotlib.pyplot as plt
-
 import FastPID
-import ArduinoPID
-import AutoPID
-
-import refpid
-import process
 
-def main() :
+def largest(scale) :
+    '''Double Kp from 1 until integer mode rejects it'''
     kp = 1
-    while FastPID.configure(kp-1,0,0,16,False) :
-        print ('{} okay'.format(kp-1))
+    while True :
+        FastPID.configure(kp, 0, 0)
+        if not FastPID.integer(scale) :
+            return kp
         kp *= 2
-    
-    
-    print ('-------')
+
+def smallest() :
+    '''Halve Kp from 1 until a full scale error gives no output'''
     kp = 1
-    while FastPID.configure(kp,0,0,16,False) :
-        print ('{} okay'.format(kp))
+    while True :
+        FastPID.configure(kp / 2, 0, 0)
+        FastPID.integer(1)
+        if FastPID.step(2 ** 15 - 1, 0) == 0 :
+            return kp
         kp /= 2
 
-        
+def main() :
+    for scale in (1, 10, 100) :
+        print ('input scale {}: Kp {} rejected'.format(scale, largest(scale)))
+    print ('-------')
+    print ('smallest Kp with an output: {}'.format(smallest()))
+
 if __name__ == '__main__' :
     main()
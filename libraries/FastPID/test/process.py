@@ -1,50 +1,110 @@
-import numpy 
-
-class DifferentialFactory :
-    def __init__(self, func) :
-        self.output = 0
-        self.func = func
-        
-    def __call__(self, cmd) :
-        self.output += cmd
-        self.output -= self.func(self.output) 
-        return self.output
-    
-
-class Process : 
-    '''Simulate a control process with a selectable PID controller and factory
-process functions''' 
-
-    def __init__(self, pid, setpoint, steps, **kwargs) :
-        self.pid = pid 
-
-        # Generate the setpoint stimulus
-        self.steps = steps
-        self.setpoint = numpy.resize([1], (self.steps,))
-        self.setpoint[0] = 0
-        self.setpoint[1] = 0
-        self.setpoint *= setpoint 
-        
-        # Create the output arrays 
-        self.feedback = numpy.resize([], self.setpoint.shape)
-        self.output = numpy.resize([], self.setpoint.shape)
-
-        if 'factory_function' not in kwargs : 
-            self.factory_func = lambda x : x 
-        else:
-            self.factory_func = kwargs['factory_function']
-
-        if 'output_filter' not in kwargs : 
-            self.output_filter = lambda x : x 
-        else:
-            self.output_filter = kwargs['output_filter'] 
-
-    def run(self) :         
-        output = 0 
-        feedback = 0
-        for x, point in enumerate(self.setpoint) : 
-            feedback = self.factory_func(output)
-            self.output[x,] = output 
-            self.feedback[x,] = feedback
-            output = round(self.output_filter(self.pid.step(point, feedback)))
-            
+import collections
+
+
+class Fopdt :
+    '''First order plus dead time process. The output settles at
+ambient + gain * input with time constant tau, input reaches the process
+after dead seconds. With the defaults it is the Brewhob brew boiler: 500 W
+element time-proportioned over a 2000 ms window (input 0-2000), 1706 J/K,
+0.45 W/K to a 70 F room, about 10 s from element to RTD.'''
+
+    def __init__(self, gain=1.0, tau=3790.0, dead=10.0, ambient=70.0, dt=2.0, start=None) :
+        self.gain = gain
+        self.tau = tau
+        self.ambient = ambient
+        self.dt = dt
+        self.value = ambient if start is None else start
+        self.delay = collections.deque([0.0] * max(int(round(dead / dt)), 0))
+
+    def step(self, u, disturbance=0.0) :
+        '''Advance dt with input u, disturbance in the same units as u'''
+        self.delay.append(u + disturbance)
+        u = self.delay.popleft()
+        target = self.ambient + self.gain * u
+        self.value += (target - self.value) * self.dt / self.tau
+        return self.value
+
+
+class Scenario :
+    '''A closed loop run: the process starts at start, the setpoint steps
+from start to setpoint at t=0, or to moveTo at event when given, and
+disturbance(t) is added to the PID output.'''
+
+    def __init__(self, name, setpoint, start, seconds, disturbance=None, event=0.0, moveTo=None) :
+        self.name = name
+        self.start = start
+        self.seconds = seconds
+        self.disturbance = disturbance if disturbance else lambda t : 0.0
+        self.event = event  # metrics are taken from here on
+        self.moveTo = moveTo
+        self.initial = setpoint
+
+    def setpoint(self, t) :
+        if self.moveTo is not None and t >= self.event :
+            return self.moveTo
+        return self.initial
+
+
+class Process :
+    '''Simulate a control process with a selectable PID controller'''
+
+    def __init__(self, pid, scenario, plant=None, hz=0.5) :
+        self.pid = pid
+        self.scenario = scenario
+        self.dt = 1.0 / hz
+        self.plant = plant if plant else Fopdt(dt=self.dt, start=scenario.start)
+        self.time = []
+        self.setpoint = []
+        self.feedback = []
+        self.output = []
+
+    def run(self) :
+        feedback = self.plant.value
+        steps = int(self.scenario.seconds / self.dt)
+        for x in range(steps) :
+            t = x * self.dt
+            setpoint = self.scenario.setpoint(t)
+            output = self.pid.step(setpoint, feedback)
+            self.time.append(t)
+            self.setpoint.append(setpoint)
+            self.feedback.append(feedback)
+            self.output.append(output)
+            feedback = self.plant.step(output, self.scenario.disturbance(t))
+        return self
+
+    def metrics(self, band=1.0) :
+        '''ISE (units^2 s), overshoot (units above setpoint), settling time
+(s until the error stays within band) and kick (largest output change
+between two steps) from the scenario event on.'''
+        ise = 0.0
+        overshoot = 0.0
+        settled = None
+        kick = 0
+        last = None
+        for t, sp, fb, out in zip(self.time, self.setpoint, self.feedback, self.output) :
+            if t < self.scenario.event :
+                last = out
+                continue
+            if last is not None :
+                kick = max(kick, abs(out - last))
+            last = out
+            err = sp - fb
+            ise += err * err * self.dt
+            overshoot = max(overshoot, -err)
+            if abs(err) > band :
+                settled = None
+            elif settled is None :
+                settled = t
+        settling = (settled - self.scenario.event) if settled is not None else float('inf')
+        return {'ise': ise, 'overshoot': overshoot, 'settling': settling, 'kick': kick}
+
+
+def scenarios() :
+    '''The boiler scenarios the benchmark runs'''
+    shot = lambda t : -2680.0 if 3600 <= t < 3630 else 0.0  # 670 W drawn by a 30 s shot
+    return [
+        Scenario('warmup', 212.0, 70.0, 3600),
+        Scenario('setpoint', 212.0, 200.0, 3600),
+        Scenario('shot', 212.0, 212.0, 4800, disturbance=shot, event=3600),
+        Scenario('sp_change', 205.0, 205.0, 4800, event=3600, moveTo=212.0),
+    ]
@@ -1,45 +1,91 @@
 
-class refpid : 
-    def __init__(self, p, i, d, bits, sign) : 
-        self.kp = p
-        self.ki = i
-        self.kd = d 
-        self.sum = 0
-        self.lasterr = 0
-        self.lastsp = 0
-        self.stepno = 0
-        if bits == 16 : 
-            self.max = 2 ** (bits-1) - 1
-        else :
-            self.max = 2 ** bits - 1
-        if sign : 
-            self.min = -2 ** (bits-1) 
-        else:
-            self.min = 0 
+import math
+
+INTEG_MAX = 2000
+INTEG_MIN = -2 ** 31
+DERIV_MAX = 2000
+DERIV_MIN = -2 ** 15
+
+WINDUP_CLAMP = 0
+WINDUP_CONDITIONAL = 1
+WINDUP_BACK_CALCULATION = 2
+
+
+def trunc(x) :
+    return int(x)
 
-    def step(self, sp, fb) :
-        err = sp - fb 
 
-        P = err * self.kp
+def clamp(x, lo, hi) :
+    return min(max(x, lo), hi)
 
-        if self.stepno > 0 : 
-            self.sum += err * self.ki
-            I = self.sum 
 
-            D = self.kd * ((err - self.lasterr) - (sp - self.lastsp))
-            self.lasterr = err  
-            self.lastsp = sp 
+class refpid :
+    '''Reference for the float pipeline of FastPID::step(): each term is
+truncated toward zero, the integral saturates at INTEG_MAX/INTEG_MIN and
+the change in error is truncated to a whole unit before the derivative.
+Integer mode saturates the integral at INT32_MIN >> 16, pass integ_min
+to model it.
+
+measurement, filter, windup and tracking select the controller form as
+FastPID::setDerivative() and FastPID::setAntiWindup() do.'''
+
+    def __init__(self, p, i, d, hz=1.0, outmin=0, outmax=2 ** 15 - 1, integ_min=INTEG_MIN,
+                 measurement=False, filter=0.0, windup=WINDUP_CLAMP, tracking=0.0) :
+        self.kp = p
+        self.ki = i / hz
+        self.kd = d * hz
+        self.min = outmin
+        self.max = outmax
+        self.integ_min = integ_min
+        self.measurement = measurement
+        self.windup = windup
+        self.alpha = 1 / (1 + filter * hz) if filter > 0 else 1.0
+        ti = self.kp / (self.ki * hz) if self.ki else 0
+        td = self.kd / (self.kp * hz) if self.kp else 0
+        tt = tracking if tracking > 0 else (math.sqrt(ti * td) if td > 0 else ti)
+        self.kt = min(1 / (tt * hz), 1.0) if tt > 0 else 1.0
+        self.sum = 0.0
+        self.lasterr = 0.0
+        self.lastfb = 0.0
+        self.dfilt = 0.0
+        self.primed = False
+
+    def step(self, sp, fb) :
+        err = sp - fb
+
+        P = trunc(self.kp * err) if self.kp else 0
 
-        else:
-            I = 0
-            D = 0
-            
-        out = P + I + D 
+        D = 0
+        if self.kd :
+            if self.measurement :
+                deriv = self.lastfb - fb if self.primed else 0
+            else :
+                deriv = trunc(err - self.lasterr)
+            deriv = clamp(deriv, DERIV_MIN, DERIV_MAX)
+            if self.alpha < 1 :
+                self.dfilt += self.alpha * (deriv - self.dfilt)
+                deriv = self.dfilt
+            D = trunc(self.kd * deriv)
+        self.lasterr = err
+        self.lastfb = fb
+        self.primed = True
 
-        if out > self.max :
-            out = self.max
-        elif out < self.min : 
-            out = self.min
+        I = 0
+        if self.ki :
+            s = self.sum + err * self.ki
+            if self.windup == WINDUP_CLAMP :
+                s = clamp(s, self.integ_min, INTEG_MAX)
+            else :
+                s = clamp(s, self.min, self.max)
+            if self.windup == WINDUP_CONDITIONAL :
+                v = P + trunc(s) + D
+                if (v > self.max and err > 0) or (v < self.min and err < 0) :
+                    s = self.sum
+            self.sum = s
+            I = trunc(self.sum)
 
-        self.stepno += 1
-        return round(out)
+        out = P + I + D
+        sat = clamp(out, self.min, self.max)
+        if self.ki and self.windup == WINDUP_BACK_CALCULATION and sat != out :
+            self.sum = clamp(self.sum + self.kt * (sat - out), self.min, self.max)
+        return sat
@@ -0,0 +1,108 @@
+/*
+  ScheduledPID test. The feedback ramps slowly through the near and far
+  errors of a schedule, then the phase changes under a steady error. With
+  bumpless gain changes the output only moves by what the ramp and the
+  integral account for; it fails if one step moves it more than MAX_STEP
+  counts. The far and shot gains have ki 0, which must freeze the
+  integral, not drop it. A kd change alone must not bump the output
+  either.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "ScheduledPID.h"
+
+#define HZ       0.5f
+#define SP       200.0f
+#define MAX_STEP 40 // integer mode sees the ramp in 0.1 F steps
+
+static int failures = 0;
+
+// Steps once and keeps the largest output change in worst
+static void step(ScheduledPID &pid, uint8_t phase, float fb, int16_t &last, int &worst) {
+  int16_t out = pid.step(phase, SP, fb);
+  if (abs(out - last) > worst)
+    worst = abs(out - last);
+  last = out;
+}
+
+static void run(bool integer) {
+  PIDGains hold = {200, 1, 60}, recovery = {100, 0, 60}, shot = {100, 0, 30};
+  GainSet idle = {hold, recovery, 1, 4};
+  ScheduledPID pid(HZ, hold, 10);
+  pid.setGains(0, idle);
+  pid.setGains(1, shot);
+  pid.pid().setOutputRange(0, 2000);
+  pid.pid().setDerivative(FastPID::DERIV_ON_MEASUREMENT);
+  if (integer && !pid.pid().setIntegerMode(true, 10)) {
+    printf("  integer mode refused\n");
+    failures++;
+    return;
+  }
+
+  // Build up an integral near the setpoint
+  float fb = SP - 0.5f;
+  int16_t last = 0;
+  int settle = 0;
+  for (int n = 0; n < 200; n++)
+    step(pid, 0, fb, last, settle);
+
+  // Out past the far error and back, 0.01 F a step
+  int ramp = 0;
+  for (; fb > SP - 6; fb -= 0.01f)
+    step(pid, 0, fb, last, ramp);
+  for (; fb < SP - 0.5f; fb += 0.01f)
+    step(pid, 0, fb, last, ramp);
+
+  // Into the shot phase and back, at a steady 2 F error
+  fb = SP - 2;
+  for (int n = 0; n < 5; n++)
+    step(pid, 0, fb, last, settle);
+  int phase = 0;
+  for (int n = 0; n < 30; n++)
+    step(pid, 1, fb, last, phase);
+  for (int n = 0; n < 30; n++)
+    step(pid, 0, fb, last, phase);
+
+  printf("  %s: largest step %d across the thresholds, %d across phase changes\n",
+         integer ? "integer" : "float", ramp, phase);
+  if (ramp > MAX_STEP || phase > MAX_STEP)
+    failures++;
+}
+
+// Two controllers on the same ramp, one switches to a phase that only
+// triples kd, without a blend. On the step it switches the change in the
+// D term is absorbed into the integral, so both give the same output to
+// within rounding.
+static void kdChange(bool integer) {
+  PIDGains gains = {100, 1, 60}, moreD = {100, 1, 180};
+  ScheduledPID pid[2] = {ScheduledPID(HZ, gains), ScheduledPID(HZ, gains)};
+  for (int k = 0; k < 2; k++) {
+    pid[k].setGains(1, moreD);
+    pid[k].pid().setOutputRange(0, 2000);
+    pid[k].pid().setDerivative(FastPID::DERIV_ON_MEASUREMENT, 4);
+    pid[k].pid().setIntegerMode(integer, 10);
+  }
+
+  int16_t out[2] = {0, 0};
+  float fb = SP - 10;
+  for (int n = 0; n <= 30; n++, fb += 0.2f)
+    for (int k = 0; k < 2; k++) {
+      uint8_t phase = k && n == 30 ? 1 : 0;
+      int16_t counts = int16_t(fb * 10 + 0.5f);
+      out[k] = integer ? pid[k].stepInt(phase, int16_t(SP * 10), counts) : pid[k].step(phase, SP, fb);
+    }
+  printf("  %s: %d with the old kd, %d switching\n", integer ? "integer" : "float", out[0], out[1]);
+  if (abs(out[1] - out[0]) > 2)
+    failures++;
+}
+
+int main() {
+  printf("schedule\n");
+  run(false);
+  run(true);
+  printf("kd change\n");
+  kdChange(false);
+  kdChange(true);
+  printf(failures ? "%d FAILED\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}
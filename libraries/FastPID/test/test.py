@@ -1,140 +1,200 @@
 #! /usr/bin/python3
 
-import numpy 
-import scipy 
-import matplotlib.pyplot as plt
-import random 
-import datetime 
-import os 
+import random
+import itertools
+import time
+import json
 import sys
-import time 
-import math
 import argparse
-import matplotlib.pyplot as plt
 
 import FastPID
-import ArduinoPID
-import AutoPID
 
 import refpid
 import process
 
-def randomtest(seed, steps, turns, pid, name, bits, sign) :
-    random.seed(a=seed) 
-    results = numpy.array([])
-    results.resize((turns,))
-    outdir = 'randomtest-seed-{}'.format(seed)
-
-    for test_num in range (turns) : 
-        kp = round(random.uniform(0, 255), 3)
-        ki = round(random.uniform(0, kp), 3)
-        kd = round(random.uniform(0, ki), 3)
-        pid.configure(kp, ki, kd, bits, sign)
-        reference = refpid.refpid(kp, ki, kd, bits, sign)
-        ref = process.Process(reference, steps, turns)
-        dut = process.Process(pid, steps, turns)
-        ref.run()
-        dut.run()
-
-        # Check for fit
-        errf = numpy.square(numpy.subtract(ref.output, dut.output))
-        err = numpy.cumsum(errf) / numpy.arange(1, ref.output.size+1, dtype=float)
-        chi2 = numpy.sum(errf) / ref.output.size
-
-        results[test_num,] = chi2
-
-        if chi2 > 1000 :
-            if not os.path.isdir(outdir) :
-                os.mkdir(outdir)
-            outfile = os.path.join(outdir, "{}-p{}-i{}-d{}.png".format(name, kp, ki, kd))
-            setline = plt.plot(ref.setpoint, '', label='Setpoint')
-            refline = plt.plot(ref.output, '', label='Reference')
-            outline = plt.plot(dut.output, '', label='Output/Feedback')
-            plt.legend(['Setpoint', 'Reference', 'Out/Feedback'])
-            plt.xlabel('Time (Seconds)')
-            plt.ylabel('Codes')
-            plt.title('{} vs. Reference (p={} i={} d={})'.format(name, kp, ki, kd))
-            plt.savefig(outfile)
-            plt.close()
-            
-    best = numpy.amin(results)
-    worst = numpy.amax(results)
-    med = numpy.median(results)
-    
-    print ("Best: {} Worst: {} Median: {}".format(best,worst,med))
-    
-    plt.hist(results)
-    outfile = os.path.join(outdir, "{}-histogram.png".format(name))
-    plt.savefig(outfile)
+# Brewhob brew boiler loop: 0.5 Hz, heater window 0-2000 ms
+BOILER_GAINS = (200.0, 1.0, 60.0)
+BOILER_HZ = 0.5
+BOILER_OUT = (0, 2000)
+BOILER_SCALE = 10
+
+# Controller forms: D on measurement, D filter (s), windup mode, tracking (s).
+# legacy is the original controller, boiler is the form Brewhob runs.
+FORMS = {
+    'legacy' : (False, 0.0, refpid.WINDUP_CLAMP, 0.0),
+    'boiler' : (True, 4.0, refpid.WINDUP_BACK_CALCULATION, 0.0),
+}
+
+# Metrics gated by --baseline, ns/step is machine dependent and reported only
+GATED = ('ise', 'overshoot', 'settling', 'kick')
+
+
+def modes(which) :
+    '''(name, input scale) for each pipeline under test, scale 0 is float'''
+    out = []
+    if which in ('float', 'both') :
+        out.append(('float', 0))
+    if which in ('integer', 'both') :
+        out.append(('integer', BOILER_SCALE))
+    return out
+
+
+def forms(which) :
+    return sorted(FORMS) if which == 'all' else [which]
+
+
+def walk(seed, steps) :
+    '''Setpoint/feedback pairs: a setpoint that steps now and then and a
+noisy feedback that follows it.'''
+    rnd = random.Random(seed)
+    sp = float(rnd.randint(-1000, 1000))
+    fb = sp
+    for x in range(steps) :
+        if rnd.random() < 0.02 :
+            sp += rnd.randint(-50, 50)
+        fb += rnd.randint(-3, 3) + (sp - fb) * 0.2
+        fb = float(round(fb))
+        yield sp, fb
+
+
+def reference(args) :
+    '''Compare FastPID in both pipelines against refpid over random
+coefficients. Returns the worst difference in output counts.'''
+    rnd = random.Random(args.seed)
+    worst = {}
+    for turn in range(args.t) :
+        kp = round(rnd.uniform(0, 255), 3)
+        ki = round(rnd.uniform(0, kp), 3)
+        kd = round(rnd.uniform(0, ki), 3)
+        outmin = rnd.choice([-32768, -2000, 0])
+        outmax = rnd.choice([2000, 32767])
+        for (mode, scale), form in itertools.product(modes(args.mode), forms(args.form)) :
+            name = '{}/{}'.format(mode, form)
+            measurement, filter, windup, tracking = FORMS[form]
+            FastPID.configure(kp, ki, kd, 1, outmin, outmax)
+            FastPID.form(measurement, filter, windup, tracking)
+            if scale and not FastPID.integer(1) :
+                continue
+            ref = refpid.refpid(kp, ki, kd, 1, outmin, outmax,
+                                integ_min=-2 ** 15 if scale else refpid.INTEG_MIN,
+                                measurement=measurement, filter=filter, windup=windup, tracking=tracking)
+            diff = 0
+            for sp, fb in walk(args.seed + turn, args.n) :
+                diff = max(diff, abs(ref.step(sp, fb) - FastPID.step(sp, fb)))
+            if diff > worst.get(name, (-1,))[0] :
+                worst[name] = (diff, kp, ki, kd)
+
+    failed = False
+    for name, (diff, kp, ki, kd) in sorted(worst.items()) :
+        ok = diff <= args.tolerance
+        failed |= not ok
+        print('{:16} worst {:3} counts (p={} i={} d={}) {}'.format(name, diff, kp, ki, kd, 'ok' if ok else 'FAIL'))
+    return not failed
+
+
+def boiler(scale, form) :
+    FastPID.configure(*BOILER_GAINS, BOILER_HZ, *BOILER_OUT)
+    FastPID.form(*FORMS[form])
+    if scale :
+        FastPID.integer(scale)
+
+
+def run_scenario(scenario, scale, form) :
+    boiler(scale, form)
+    return process.Process(FastPID, scenario, hz=BOILER_HZ).run()
+
+
+def bench(args) :
+    '''Closed loop boiler scenarios. With --baseline the run fails if a
+gated metric is worse than the baseline by more than --tolerance percent.'''
+    results = {}
+    runs = {}
+    for (mode, scale), form in itertools.product(modes(args.mode), forms(args.form)) :
+        for scenario in process.scenarios() :
+            run = run_scenario(scenario, scale, form)
+            key = '{}/{}/{}'.format(mode, form, scenario.name)
+            runs[key] = run
+            results[key] = run.metrics()
+        boiler(scale, form)
+        ns = FastPID.bench(args.n, 212.0)
+        for scenario in process.scenarios() :
+            results['{}/{}/{}'.format(mode, form, scenario.name)]['ns_step'] = ns
+
+    baseline = {}
+    if args.baseline :
+        with open(args.baseline) as f :
+            baseline = json.load(f)
+
+    failed = False
+    print('{:24} {:>12} {:>10} {:>10} {:>6} {:>8}'.format('run', 'ISE', 'overshoot', 'settling', 'kick', 'ns/step'))
+    for key, m in sorted(results.items()) :
+        flags = []
+        if key in baseline :
+            for metric in GATED :
+                limit = baseline[key][metric] * (1 + args.tolerance / 100.0) + 1e-6
+                if m[metric] > limit :
+                    flags.append(metric)
+        failed |= bool(flags)
+        print('{:24} {:12.1f} {:10.2f} {:10.0f} {:6} {:8.1f} {}'.format(
+            key, m['ise'], m['overshoot'], m['settling'], m['kick'], m['ns_step'],
+            ('worse: ' + ', '.join(flags)) if flags else ''))
+
+    if args.json :
+        with open(args.json, 'w') as f :
+            json.dump({k : {m : round(v[m], 3) for m in GATED} for k, v in results.items()}, f, indent=2, sort_keys=True)
+            f.write('\n')
+
+    if args.plot :
+        plot(runs)
+
+    return not failed
+
+
+def plot(runs) :
+    import matplotlib.pyplot as plt
+    for key, run in sorted(runs.items()) :
+        fig, ax1 = plt.subplots()
+        ax1.set_title(key)
+        ax1.set_xlabel('Time (Seconds)')
+        ax1.set_ylabel('Setpoint (green), Feedback (red)')
+        ax1.plot(run.time, run.setpoint, 'g--', run.time, run.feedback, 'r')
+        ax2 = ax1.twinx()
+        ax2.set_ylabel('Output (blue)')
+        ax2.plot(run.time, run.output)
     plt.show()
-    
+
+
 def main() :
     parser = argparse.ArgumentParser(description="Run PID tests")
-    parser.add_argument('test', help='The test to execute.', choices=['reference', 'random', 'load'])
-    parser.add_argument('-p', help='Kp', type=float, default=1)
-    parser.add_argument('-i', help='Ki', type=float, default=0)
-    parser.add_argument('-d', help='Kd', type=float, default=0)
-    parser.add_argument('-n', help='Number of steps to simulate.', type=int, default=100)
-    parser.add_argument('-t', help='Number of random turns to test.', type=int, default=100)
-    parser.add_argument('--obits', help='Number of output bits.', type=int, default=16)
-    parser.add_argument('--osign', help='Signedness of the output.', type=int, default=0)
-    parser.add_argument('--pid', help='PID implementation to use.', choices=['FastPID', 'ArduinoPID', 'AutoPID'], default='FastPID')
-    parser.add_argument('--seed', help='Random seed to use.', default=int(time.time()))
-    
-    args = parser.parse_args()
+    sub = parser.add_subparsers(dest='test')
+    sub.required = True
+
+    ref = sub.add_parser('reference', help='Compare FastPID against the reference implementation.')
+    ref.add_argument('-n', help='Number of steps per turn.', type=int, default=500)
+    ref.add_argument('-t', help='Number of random turns to test.', type=int, default=100)
+    ref.add_argument('--seed', help='Random seed to use.', type=int, default=int(time.time()))
+    ref.add_argument('--mode', choices=['float', 'integer', 'both'], default='both')
+    ref.add_argument('--form', choices=sorted(FORMS) + ['all'], default='all')
+    ref.add_argument('--tolerance', help='Allowed difference in output counts.', type=int, default=3)
+
+    ben = sub.add_parser('bench', help='Closed loop boiler benchmark.')
+    ben.add_argument('-n', help='Steps timed for ns/step.', type=int, default=1000000)
+    ben.add_argument('--mode', choices=['float', 'integer', 'both'], default='both')
+    ben.add_argument('--form', choices=sorted(FORMS) + ['all'], default='all')
+    ben.add_argument('--json', help='Write the gated metrics to this file.')
+    ben.add_argument('--baseline', help='Fail if worse than the metrics in this file.')
+    ben.add_argument('--tolerance', help='Allowed regression in percent.', type=float, default=2.0)
+    ben.add_argument('--plot', action='store_true', help='Plot each run (needs matplotlib).')
 
-    if args.pid == 'FastPID' :
-        pid = FastPID
-    elif args.pid == 'ArduinoPID' :
-        pid = ArduinoPID
-    else:
-        pid = AutoPID        
-
-    if not pid.configure(args.p, args.i, args.d, args.obits, args.osign) :
-        print ('Error configuring the PID.')
-        exit(-1)
-    
-    if args.test == 'reference' :    
-        # Test the PID against the reference implementation.
-        reference = refpid.refpid(args.p, args.i, args.d, args.obits, bool(args.osign))
-        ref = process.Process(reference, 100, args.n)
-        dut = process.Process(pid, 100, args.n)
-        ref.run()
-        dut.run()
-        
-        setline = plt.plot(ref.setpoint, '', label='Setpoint')
-        refline = plt.plot(ref.output, '--', label='Reference')
-        outline = plt.plot(dut.output, '', label='Output/Feedback')
-        plt.legend(['Setpoint', 'Reference', 'Out/Feedback'])
-        plt.xlabel('Time (Seconds)')
-        plt.ylabel('Codes')
-        plt.title('{} vs. Reference (p={} i={} d={})'.format(args.pid, args.p, args.i, args.d))
-        plt.show()
-
-    if args.test == 'random' :
-        # Test random parameters vs. the reference implementation. Look for outliers. 
-        randomtest(args.seed, args.n, args.t, pid, args.pid, args.obits, bool(args.osign))
-
-    if args.test == 'load' :
-        factory_f = process.DifferentialFactory(lambda x : math.log(x *.1) * 0.1 )
-        dut = process.Process(pid, 100, args.n)
-
-        x = numpy.arange(0, args.n) 
-        dut.run()
-        fig, ax1 = plt.subplots()
-        ax1.set_xlabel('Step')
-        ax1.set_ylabel('Setpoint (green), Feedback (red)')
-        ax1.tick_params('y', color='r')
-        ax1.plot(x, dut.setpoint, 'g--', dut.feedback, 'r')
+    args = parser.parse_args()
 
-        ax3 = ax1.twinx()
-        ax3.set_ylabel('Output (blue)')
-        ax3.plot(x, dut.output)
+    if args.test == 'reference' :
+        print('seed {}'.format(args.seed))
+        ok = reference(args)
+    else :
+        ok = bench(args)
 
-        #fig.tight_layout()
-        plt.show()
-        pass
+    sys.exit(0 if ok else 1)
 
 if __name__ == '__main__' :
     main()
-    
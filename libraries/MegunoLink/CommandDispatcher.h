@@ -2,7 +2,7 @@
 
 #include "utility/CommandDispatcherBase.h"
 
-template<int MAX_COMMANDS = 10, int MAX_VARIABLES = 10> class CommandDispatcher : public MLP::CommandDispatcherBase
+template<int MAX_COMMANDS = MLP_DEFAULT_MAX_COMMANDS, int MAX_VARIABLES = MLP_DEFAULT_MAX_VARIABLES> class CommandDispatcher : public MLP::CommandDispatcherBase
 {
   // Array of commands we can match & dispatch. 
   MLP::CommandCallback m_Commands[MAX_COMMANDS];
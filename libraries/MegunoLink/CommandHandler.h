@@ -6,7 +6,7 @@
 #include "utility/CommandDispatcherBase.h"
 #include "utility/StreamParser.h"
 
-template <int MAX_COMMANDS = 10, int CP_SERIAL_BUFFER_SIZE = 30, int MAX_VARIABLES=10> class CommandHandler : public MLP::CommandDispatcherBase, public MLP::StreamParser
+template <int MAX_COMMANDS = MLP_DEFAULT_MAX_COMMANDS, int CP_SERIAL_BUFFER_SIZE = MLP_DEFAULT_BUFFER_SIZE, int MAX_VARIABLES = MLP_DEFAULT_MAX_VARIABLES> class CommandHandler : public MLP::CommandDispatcherBase, public MLP::StreamParser
 {
   // Array of commands we can match & dispatch. 
   MLP::CommandCallback m_Commands[MAX_COMMANDS];
@@ -4,7 +4,7 @@
 #include "CommandDispatcher.h"
 #include "utility/StreamParser.h"
 
-template <int CP_SERIAL_BUFFER_SIZE = 30> class CommandProcessor : public MLP::StreamParser
+template <int CP_SERIAL_BUFFER_SIZE = MLP_DEFAULT_BUFFER_SIZE> class CommandProcessor : public MLP::StreamParser
 {
   // Buffer for data received.
   char m_achBuffer[CP_SERIAL_BUFFER_SIZE];
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 /* 
 * Implements a simple linear recursive exponential filter. 
 * See: http://www.statistics.com/glossary&term_id=756 */
@@ -12,6 +14,8 @@ template<class T> class ExponentialFilter
   T m_Current;
 
 public:
+  typedef T ValueType;
+
   ExponentialFilter(T WeightNew, T Initial)
     : m_WeightNew(WeightNew), m_Current(Initial)
   { }
@@ -43,6 +47,8 @@ template<> class ExponentialFilter<float>
   float m_fCurrent;
 
 public:
+  typedef float ValueType;
+
   ExponentialFilter(float fWeightNew, float fInitial)
     : m_fWeightNew(fWeightNew/100.0), m_fCurrent(fInitial)
   { }
@@ -68,3 +74,302 @@ public:
   }
 };
 
+/*
+* Median of the last N samples. A single outlier, such as a glitch on an
+* RTD conversion, never reaches the output when N is 3 or more, and a step
+* passes through after (N + 1)/2 samples. Insertion into a sorted copy of
+* the window costs O(N) compares per sample; no arithmetic is done on T,
+* so any type with < works. Until the window fills, the median of the
+* samples so far (the lower middle one for an even count). */
+template<class T, uint8_t N> class MedianFilter
+{
+  static_assert(N > 0, "MedianFilter needs a window of at least one sample");
+
+  // Samples in arrival order. m_Next is where the next goes, which is the
+  // oldest once the window is full.
+  T m_History[N];
+
+  // The same samples in ascending order. 
+  T m_Sorted[N];
+
+  uint8_t m_Next;
+  uint8_t m_Count;
+
+public:
+  typedef T ValueType;
+
+  MedianFilter(T Initial)
+  {
+    SetCurrent(Initial);
+  }
+
+  void Filter(T New)
+  {
+    uint8_t i = 0;
+    if (m_Count == N)
+    {
+      // Drop the oldest sample from the sorted copy. 
+      T Old = m_History[m_Next];
+      while (i < N - 1 && m_Sorted[i] != Old)
+        ++i;
+      for (; i < N - 1; ++i)
+        m_Sorted[i] = m_Sorted[i + 1];
+    }
+    else
+    {
+      ++m_Count;
+    }
+
+    m_History[m_Next] = New;
+    m_Next = m_Next + 1 == N ? 0 : m_Next + 1;
+
+    for (i = m_Count - 1; i > 0 && New < m_Sorted[i - 1]; --i)
+      m_Sorted[i] = m_Sorted[i - 1];
+    m_Sorted[i] = New;
+  }
+
+  T Current() const { return m_Sorted[m_Count ? (m_Count - 1)/2 : 0]; }
+
+  // Empties the window; Current() returns NewValue until the next sample. 
+  void SetCurrent(T NewValue)
+  {
+    m_Next = 0;
+    m_Count = 0;
+    m_Sorted[0] = NewValue;
+  }
+};
+
+/*
+* Scalar Kalman filter for a value that wanders as a random walk. 
+* ProcessNoise is the variance the true value gains per sample and
+* MeasurementNoise the variance of a sample, both in sample units squared.
+* The gain settles where the two balance: the smaller ProcessNoise is
+* against MeasurementNoise, the smoother and the slower the output.
+* InitialVariance says how far Initial can be trusted; 0 takes the first
+* sample as it is.
+*
+* The integer version keeps FractionBits bits below the sample unit and
+* needs no float: one 32 bit divide and two 64 bit multiplies a sample.
+* Variances up to about 2^22 fit. */
+template<class T> class KalmanFilter
+{
+  static const uint8_t FractionBits = 8;
+  static const uint8_t GainBits = 15;
+
+  // Variances are scaled by 2^FractionBits like the estimate. A negative
+  // variance means there is no estimate yet. 
+  int32_t m_ProcessNoise;
+  int32_t m_MeasurementNoise;
+  int32_t m_Variance;
+
+  // Current estimate, scaled by 2^FractionBits. 
+  int32_t m_Current;
+
+public:
+  typedef T ValueType;
+
+  KalmanFilter(T ProcessNoise, T MeasurementNoise, T Initial, T InitialVariance = 0)
+    : m_ProcessNoise((int32_t)ProcessNoise << FractionBits),
+      m_MeasurementNoise((int32_t)MeasurementNoise << FractionBits),
+      m_Variance(InitialVariance > 0 ? (int32_t)InitialVariance << FractionBits : -1),
+      m_Current((int32_t)Initial << FractionBits)
+  { }
+
+  void Filter(T New)
+  {
+    int32_t Measured = (int32_t)New << FractionBits;
+    if (m_Variance < 0)
+    {
+      m_Current = Measured;
+      m_Variance = m_MeasurementNoise;
+      return;
+    }
+
+    // Predict, then weigh the sample by Gain = P/(P + R), in Q15. Both
+    // terms are shifted down until the divide fits 32 bits. 
+    m_Variance += m_ProcessNoise;
+    uint32_t Predicted = m_Variance;
+    uint32_t Total = Predicted + m_MeasurementNoise;
+    while (Total >= (1UL << (31 - GainBits)))
+    {
+      Predicted >>= 1;
+      Total >>= 1;
+    }
+    int32_t Gain = Total ? (int32_t)((Predicted << GainBits)/Total) : 0;
+
+    m_Current += (int32_t)(((int64_t)Gain*(Measured - m_Current) + (1L << (GainBits - 1))) >> GainBits);
+    m_Variance -= (int32_t)(((int64_t)Gain*m_Variance) >> GainBits);
+  }
+
+  void SetNoise(T ProcessNoise, T MeasurementNoise)
+  {
+    m_ProcessNoise = (int32_t)ProcessNoise << FractionBits;
+    m_MeasurementNoise = (int32_t)MeasurementNoise << FractionBits;
+  }
+
+  T Current() const { return (T)((m_Current + (1L << (FractionBits - 1))) >> FractionBits); }
+
+  // The estimate variance in sample units squared, 0 before the first sample. 
+  T Variance() const { return m_Variance < 0 ? 0 : (T)(m_Variance >> FractionBits); }
+
+  void SetCurrent(T NewValue)
+  {
+    m_Current = (int32_t)NewValue << FractionBits;
+  }
+};
+
+// Specialization for floating point math. 
+template<> class KalmanFilter<float>
+{
+  float m_fProcessNoise;
+  float m_fMeasurementNoise;
+  float m_fVariance;
+  float m_fCurrent;
+
+public:
+  typedef float ValueType;
+
+  KalmanFilter(float fProcessNoise, float fMeasurementNoise, float fInitial, float fInitialVariance = 0)
+    : m_fProcessNoise(fProcessNoise), m_fMeasurementNoise(fMeasurementNoise),
+      m_fVariance(fInitialVariance > 0 ? fInitialVariance : -1), m_fCurrent(fInitial)
+  { }
+
+  void Filter(float fNew)
+  {
+    if (m_fVariance < 0)
+    {
+      m_fCurrent = fNew;
+      m_fVariance = m_fMeasurementNoise;
+      return;
+    }
+
+    m_fVariance += m_fProcessNoise;
+    float fTotal = m_fVariance + m_fMeasurementNoise;
+    float fGain = fTotal > 0 ? m_fVariance/fTotal : 0;
+    m_fCurrent += fGain * (fNew - m_fCurrent);
+    m_fVariance -= fGain * m_fVariance;
+  }
+
+  void SetNoise(float fProcessNoise, float fMeasurementNoise)
+  {
+    m_fProcessNoise = fProcessNoise;
+    m_fMeasurementNoise = fMeasurementNoise;
+  }
+
+  float Current() const { return m_fCurrent; }
+
+  float Variance() const { return m_fVariance < 0 ? 0 : m_fVariance; }
+
+  void SetCurrent(float fNewValue)
+  {
+    m_fCurrent = fNewValue;
+  }
+};
+
+/*
+* Follows the input, but moves by no more than MaxStep per sample. Caps how
+* fast a setpoint or a reading can swing; a one sample spike moves the
+* output by MaxStep at most. Integer and float types alike. */
+template<class T> class SlewRateLimiter
+{
+  T m_MaxStep;
+  T m_Current;
+
+public:
+  typedef T ValueType;
+
+  SlewRateLimiter(T MaxStep, T Initial)
+    : m_MaxStep(MaxStep), m_Current(Initial)
+  { }
+
+  void Filter(T New)
+  {
+    if (New > m_Current && New - m_Current > m_MaxStep)
+      m_Current += m_MaxStep;
+    else if (New < m_Current && m_Current - New > m_MaxStep)
+      m_Current -= m_MaxStep;
+    else
+      m_Current = New;
+  }
+
+  void SetMaxStep(T MaxStep)
+  {
+    m_MaxStep = MaxStep;
+  }
+
+  T GetMaxStep() const { return m_MaxStep; }
+
+  T Current() const { return m_Current; }
+
+  void SetCurrent(T NewValue)
+  {
+    m_Current = NewValue;
+  }
+};
+
+/*
+* Filters applied one after the other, fixed at compile time: each sample
+* goes through the first stage, and the output of each stage feeds the
+* next. Any class with Filter(), Current() and a ValueType typedef is a
+* stage, including another FilterChain. Nothing is virtual, so the calls
+* inline as if written out by hand. 
+*
+*   FilterChain<MedianFilter<int16_t, 3>, KalmanFilter<int16_t> > Chain(
+*     MedianFilter<int16_t, 3>(0), KalmanFilter<int16_t>(4, 100, 0));
+*/
+template<class First, class... Rest> class FilterChain
+{
+  First m_First;
+  FilterChain<Rest...> m_Rest;
+
+public:
+  typedef typename FilterChain<Rest...>::ValueType ValueType;
+
+  FilterChain(const First &Head, const Rest &... Tail)
+    : m_First(Head), m_Rest(Tail...)
+  { }
+
+  void Filter(typename First::ValueType New)
+  {
+    m_First.Filter(New);
+    m_Rest.Filter(m_First.Current());
+  }
+
+  ValueType Current() const { return m_Rest.Current(); }
+
+  // Sets every stage, as if the chain had settled at NewValue. 
+  void SetCurrent(ValueType NewValue)
+  {
+    m_First.SetCurrent(NewValue);
+    m_Rest.SetCurrent(NewValue);
+  }
+
+  First &Head() { return m_First; }
+  FilterChain<Rest...> &Tail() { return m_Rest; }
+};
+
+template<class Last> class FilterChain<Last>
+{
+  Last m_Last;
+
+public:
+  typedef typename Last::ValueType ValueType;
+
+  FilterChain(const Last &Head)
+    : m_Last(Head)
+  { }
+
+  void Filter(typename Last::ValueType New)
+  {
+    m_Last.Filter(New);
+  }
+
+  ValueType Current() const { return m_Last.Current(); }
+
+  void SetCurrent(ValueType NewValue)
+  {
+    m_Last.SetCurrent(NewValue);
+  }
+
+  Last &Head() { return m_Last; }
+};
@@ -0,0 +1,412 @@
+/* *****************************************************************************
+*  Settings kept in flash, with the interface of EEPROMStore, for micros that
+*  have no eeprom, such as the SAMD21.
+*  Usage:
+*     SAMD21_FLASH_AREA(SettingsArea, 8);
+*     SAMD21Flash SettingsFlash(SettingsArea, sizeof(SettingsArea));
+*     FlashStore<MySettings> Settings(SettingsFlash);
+*
+*     // In loop(), after changing Settings.Data
+*     Settings.Save();
+*     Settings.Service();
+*  ***************************************************************************** */
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "utility/CRC.h"
+#include "utility/FlashMemory.h"
+
+namespace MLP
+{
+  // One slot of the log. Erased flash reads as all ones, so a slot whose
+  // chunk is Blank is free. The first slot of each row holds a header
+  // instead: the sequence number of the row and the size of the data.
+  struct FlashRecord
+  {
+    enum { ChunkSize = 12, RowHeader = 0xfe, Blank = 0xff };
+
+    uint8_t m_uChunk;
+    uint8_t m_uCheck; // ~m_uChunk
+    uint16_t m_uCRC;  // of the other 14 bytes
+    uint8_t m_aData[ChunkSize];
+
+    uint16_t CalculateCRC() const
+    {
+      uint16_t uCRC = 0xffff;
+      uCRC = _crc16_update(uCRC, m_uChunk);
+      uCRC = _crc16_update(uCRC, m_uCheck);
+      for (uint8_t i = 0; i < ChunkSize; ++i)
+        uCRC = _crc16_update(uCRC, m_aData[i]);
+      return uCRC;
+    }
+
+    void Seal(uint8_t uChunk)
+    {
+      m_uChunk = uChunk;
+      m_uCheck = ~uChunk;
+      m_uCRC = CalculateCRC();
+    }
+
+    bool IsValid() const
+    {
+      return m_uChunk == (uint8_t)~m_uCheck && m_uChunk != Blank && m_uCRC == CalculateCRC();
+    }
+
+    bool IsBlank() const
+    {
+      const uint8_t *pBytes = (const uint8_t *)this;
+      for (uint8_t i = 0; i < sizeof(FlashRecord); ++i)
+      {
+        if (pBytes[i] != 0xff)
+          return false;
+      }
+      return true;
+    }
+  };
+
+  static_assert(sizeof(FlashRecord) == 16, "FlashRecord: must be 16 bytes");
+}
+
+template <class TData> class FlashStore
+  /* Data is split into 12 byte chunks and Save() appends a record, with a
+  CRC, for each chunk that differs from its last record. Rows are started
+  in turn, each with a header holding the next sequence number, so every
+  row is erased as often as the others. As soon as the log moves into a
+  row, the row after it, the oldest, is compacted: chunks whose latest
+  record is there are copied forward and the row is erased. Service() does
+  that a step at a time in the background; Save() finishes it itself if
+  the space runs out first.
+  After power loss, records with a bad CRC are skipped and an unfinished
+  compaction starts again, so a Save() that was cut short leaves each
+  chunk with its old or its new value, and nothing else is lost.
+  The data must fit in a row with a record to spare: 14 chunks, or 168
+  bytes, in the 256 byte rows of the SAMD21. Give the log several times
+  that so rows are not compacted on every Save(). */
+{
+  typedef MLP::FlashRecord FlashRecord;
+
+  enum { ChunkCount = (sizeof(TData) + FlashRecord::ChunkSize - 1) / FlashRecord::ChunkSize };
+  static_assert((int)ChunkCount < (int)FlashRecord::RowHeader, "FlashStore: data too large");
+
+  static const uint16_t NoSlot = 0xffff;
+
+  MLP::FlashMemory &m_rFlash;
+  const uint16_t m_uRows;
+  const uint16_t m_uSlotsPerRow;
+
+  // Slot holding the latest record of each chunk, counted from the start
+  // of the area, or NoSlot.
+  uint16_t m_auLocation[ChunkCount];
+
+  // Row the log is appended to, or NoSlot before the first Save().
+  uint16_t m_uHeadRow;
+  uint16_t m_uNextSlot; // in m_uHeadRow
+  uint32_t m_uSequence; // of m_uHeadRow
+
+  // Row being compacted, or NoSlot. Always the one after m_uHeadRow.
+  uint16_t m_uCompactRow;
+
+public:
+  TData Data;
+
+  FlashStore(MLP::FlashMemory &rFlash)
+    : m_rFlash(rFlash)
+    , m_uRows(rFlash.RowCount())
+    , m_uSlotsPerRow(rFlash.RowSize() / sizeof(FlashRecord))
+  {
+    Reset();
+    if (!Load())
+      Reset();
+  }
+
+  bool Load()
+    /* Replays the log into Data. Returns false, leaving Data alone, unless
+    every chunk has a record. */
+  {
+    TData WorkingCopy;
+    memcpy(&WorkingCopy, &Data, sizeof(TData));
+    if (Mount(WorkingCopy))
+    {
+      memcpy(&Data, &WorkingCopy, sizeof(TData));
+      return true;
+    }
+
+    return false;
+  }
+
+  bool Save()
+    /* Appends the chunks of Data that have changed. Returns true if
+    anything was written. */
+  {
+    if (!Fits())
+      return false;
+
+    bool bWritten = false;
+    for (uint8_t uChunk = 0; uChunk < ChunkCount; ++uChunk)
+    {
+      if (IsStored(uChunk))
+        continue;
+
+      FlashRecord Record;
+      memset(Record.m_aData, 0xff, sizeof(Record.m_aData));
+      memcpy(Record.m_aData, ChunkData(uChunk), ChunkLength(uChunk));
+      Record.Seal(uChunk);
+      if (!Append(Record))
+        return false;
+      bWritten = true;
+    }
+    return bWritten;
+  }
+
+  bool Service()
+    /* One step of compaction, if one is due: copies a record forward or
+    erases a row. Call it often, e.g. from loop(). Returns true if it
+    touched the flash. */
+  {
+    if (m_uCompactRow == NoSlot)
+      return false;
+
+    for (uint8_t uChunk = 0; uChunk < ChunkCount; ++uChunk)
+    {
+      if (RowOf(m_auLocation[uChunk]) == m_uCompactRow)
+      {
+        // Only failed writes can use up the room kept for this.
+        if (m_uNextSlot == m_uSlotsPerRow)
+          return false;
+
+        FlashRecord Record;
+        ReadSlot(m_auLocation[uChunk], Record);
+        WriteSlot(Record);
+        return true;
+      }
+    }
+
+    // Nothing current is left in the row.
+    m_rFlash.EraseRow(m_uCompactRow);
+    m_uCompactRow = NoSlot;
+    return true;
+  }
+
+  bool IsCompacting() const
+  {
+    return m_uCompactRow != NoSlot;
+  }
+
+  void Reset()
+  {
+    Data.Reset();
+  }
+
+private:
+  bool Fits() const
+  {
+    return m_uRows >= 2 && ChunkCount + 2 <= m_uSlotsPerRow && (uint32_t)m_uRows * m_uSlotsPerRow < NoSlot;
+  }
+
+  bool Mount(TData &rData)
+  {
+    for (uint8_t uChunk = 0; uChunk < ChunkCount; ++uChunk)
+      m_auLocation[uChunk] = NoSlot;
+    m_uHeadRow = NoSlot;
+    m_uNextSlot = 0;
+    m_uSequence = 0;
+    m_uCompactRow = NoSlot;
+    if (!Fits())
+      return false;
+
+    // The newest row is the head.
+    uint32_t uSequence;
+    for (uint16_t uRow = 0; uRow < m_uRows; ++uRow)
+    {
+      if (ReadHeader(uRow, uSequence) && (m_uHeadRow == NoSlot || uSequence > m_uSequence))
+      {
+        m_uHeadRow = uRow;
+        m_uSequence = uSequence;
+      }
+    }
+    if (m_uHeadRow == NoSlot)
+      return false;
+
+    // Rows were started in turn, so going round from the one after the
+    // head visits them oldest first and later records win.
+    uint32_t uPrevious = 0;
+    uint8_t *pData = (uint8_t *)&rData;
+    for (uint16_t uStep = 1; uStep <= m_uRows; ++uStep)
+    {
+      uint16_t uRow = (m_uHeadRow + uStep) % m_uRows;
+      if (!ReadHeader(uRow, uSequence) || uSequence <= uPrevious)
+        continue;
+      uPrevious = uSequence;
+
+      uint16_t uUsed = 1;
+      for (uint16_t uSlot = 1; uSlot < m_uSlotsPerRow; ++uSlot)
+      {
+        FlashRecord Record;
+        uint16_t uLocation = uRow * m_uSlotsPerRow + uSlot;
+        ReadSlot(uLocation, Record);
+        if (!Record.IsBlank())
+          uUsed = uSlot + 1;
+        if (Record.IsValid() && Record.m_uChunk < ChunkCount)
+        {
+          memcpy(pData + Record.m_uChunk * FlashRecord::ChunkSize, Record.m_aData, ChunkLength(Record.m_uChunk));
+          m_auLocation[Record.m_uChunk] = uLocation;
+        }
+      }
+      if (uRow == m_uHeadRow)
+        m_uNextSlot = uUsed;
+    }
+
+    ScheduleCompaction();
+
+    for (uint8_t uChunk = 0; uChunk < ChunkCount; ++uChunk)
+    {
+      if (m_auLocation[uChunk] == NoSlot)
+        return false;
+    }
+    return true;
+  }
+
+  bool Append(const FlashRecord &rRecord)
+  {
+    // A failed write still uses up its slot, so try a few.
+    for (uint8_t uTry = 0; uTry < 3; ++uTry)
+    {
+      if (!MakeRoom())
+        return false;
+      if (WriteSlot(rRecord))
+        return true;
+    }
+    return false;
+  }
+
+  bool MakeRoom()
+    /* Makes sure the head row has a free slot, starting a new row if it
+    is full. Keeps enough free to finish the compaction under way. */
+  {
+    if (m_uHeadRow == NoSlot)
+      return StartRow(0);
+
+    for (;;)
+    {
+      uint16_t uFree = m_uSlotsPerRow - m_uNextSlot;
+      if (m_uCompactRow != NoSlot && uFree <= CountCurrent(m_uCompactRow))
+      {
+        while (Service() && m_uCompactRow != NoSlot)
+          ;
+        if (m_uCompactRow != NoSlot)
+          return false;
+      }
+      else if (uFree > 0)
+      {
+        return true;
+      }
+      else if (!StartRow((m_uHeadRow + 1) % m_uRows))
+      {
+        return false;
+      }
+    }
+  }
+
+  bool StartRow(uint16_t uRow)
+  {
+    if (!IsRowBlank(uRow) && !m_rFlash.EraseRow(uRow))
+      return false;
+
+    FlashRecord Header;
+    uint32_t uSequence = m_uSequence + 1;
+    uint16_t uSize = sizeof(TData);
+    memset(Header.m_aData, 0xff, sizeof(Header.m_aData));
+    memcpy(Header.m_aData, &uSequence, sizeof(uSequence));
+    memcpy(Header.m_aData + sizeof(uSequence), &uSize, sizeof(uSize));
+    Header.Seal(FlashRecord::RowHeader);
+    if (!m_rFlash.Write((uint32_t)uRow * m_uSlotsPerRow * sizeof(FlashRecord), &Header, sizeof(Header)))
+      return false;
+
+    m_uHeadRow = uRow;
+    m_uNextSlot = 1;
+    m_uSequence = uSequence;
+    ScheduleCompaction();
+    return true;
+  }
+
+  void ScheduleCompaction()
+  {
+    uint16_t uNext = (m_uHeadRow + 1) % m_uRows;
+    m_uCompactRow = IsRowBlank(uNext) ? NoSlot : uNext;
+  }
+
+  bool ReadHeader(uint16_t uRow, uint32_t &ruSequence)
+  {
+    FlashRecord Header;
+    uint16_t uSize;
+    ReadSlot(uRow * m_uSlotsPerRow, Header);
+    memcpy(&ruSequence, Header.m_aData, sizeof(ruSequence));
+    memcpy(&uSize, Header.m_aData + sizeof(ruSequence), sizeof(uSize));
+    return Header.IsValid() && Header.m_uChunk == FlashRecord::RowHeader && uSize == sizeof(TData);
+  }
+
+  bool IsRowBlank(uint16_t uRow)
+  {
+    FlashRecord Record;
+    for (uint16_t uSlot = 0; uSlot < m_uSlotsPerRow; ++uSlot)
+    {
+      ReadSlot(uRow * m_uSlotsPerRow + uSlot, Record);
+      if (!Record.IsBlank())
+        return false;
+    }
+    return true;
+  }
+
+  bool IsStored(uint8_t uChunk)
+  {
+    if (m_auLocation[uChunk] == NoSlot)
+      return false;
+
+    FlashRecord Record;
+    ReadSlot(m_auLocation[uChunk], Record);
+    return memcmp(Record.m_aData, ChunkData(uChunk), ChunkLength(uChunk)) == 0;
+  }
+
+  uint8_t CountCurrent(uint16_t uRow) const
+  {
+    uint8_t uCount = 0;
+    for (uint8_t uChunk = 0; uChunk < ChunkCount; ++uChunk)
+    {
+      if (RowOf(m_auLocation[uChunk]) == uRow)
+        ++uCount;
+    }
+    return uCount;
+  }
+
+  uint16_t RowOf(uint16_t uLocation) const
+  {
+    return uLocation == NoSlot ? NoSlot : uLocation / m_uSlotsPerRow;
+  }
+
+  void ReadSlot(uint16_t uLocation, FlashRecord &rRecord)
+  {
+    m_rFlash.Read((uint32_t)uLocation * sizeof(FlashRecord), &rRecord, sizeof(FlashRecord));
+  }
+
+  bool WriteSlot(const FlashRecord &rRecord)
+  {
+    uint16_t uLocation = m_uHeadRow * m_uSlotsPerRow + m_uNextSlot++;
+    if (!m_rFlash.Write((uint32_t)uLocation * sizeof(FlashRecord), &rRecord, sizeof(FlashRecord)))
+      return false;
+
+    m_auLocation[rRecord.m_uChunk] = uLocation;
+    return true;
+  }
+
+  const uint8_t *ChunkData(uint8_t uChunk) const
+  {
+    return (const uint8_t *)&Data + uChunk * FlashRecord::ChunkSize;
+  }
+
+  static uint8_t ChunkLength(uint8_t uChunk)
+  {
+    uint16_t uRemaining = sizeof(TData) - uChunk * FlashRecord::ChunkSize;
+    return uRemaining < FlashRecord::ChunkSize ? uRemaining : (uint16_t)FlashRecord::ChunkSize;
+  }
+};
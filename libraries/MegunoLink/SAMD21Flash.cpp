@@ -0,0 +1,75 @@
+#include "SAMD21Flash.h"
+
+#if defined(ARDUINO_ARCH_SAMD)
+#include <Arduino.h>
+#include <string.h>
+
+static void RunCommand(uint32_t uCommand)
+{
+  NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | uCommand;
+  while (!NVMCTRL->INTFLAG.bit.READY)
+    ;
+}
+
+SAMD21Flash::SAMD21Flash(const uint8_t *pArea, uint32_t uAreaSize)
+  : m_pArea(pArea)
+  , m_uRows(uAreaSize / RowBytes)
+{
+}
+
+void SAMD21Flash::Read(uint32_t uOffset, void *pDestination, uint16_t uLength)
+{
+  memcpy(pDestination, m_pArea + uOffset, uLength);
+}
+
+bool SAMD21Flash::Write(uint32_t uOffset, const void *pSource, uint16_t uLength)
+{
+  if ((uOffset & 3) != 0 || (uLength & 3) != 0 || uOffset + uLength > (uint32_t)m_uRows * RowBytes)
+    return false;
+
+  // Manual page writes, so a partly loaded buffer is not written for us.
+  NVMCTRL->CTRLB.bit.MANW = 1;
+  NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;
+
+  const uint8_t *pSourceBytes = (const uint8_t *)pSource;
+  volatile uint32_t *pWord = (volatile uint32_t *)(m_pArea + uOffset);
+  uint16_t uRemaining = uLength;
+  while (uRemaining > 0)
+  {
+    // Clearing the page buffer sets it to all ones, which programs nothing.
+    RunCommand(NVMCTRL_CTRLA_CMD_PBC);
+    do
+    {
+      uint32_t uValue;
+      memcpy(&uValue, pSourceBytes, sizeof(uValue));
+      *pWord++ = uValue;
+      pSourceBytes += sizeof(uValue);
+      uRemaining -= sizeof(uValue);
+    } while (uRemaining > 0 && ((uint32_t)pWord & (PageSize - 1)) != 0);
+
+    // The page buffer writes set ADDR to this page.
+    RunCommand(NVMCTRL_CTRLA_CMD_WP);
+  }
+
+  return memcmp(m_pArea + uOffset, pSource, uLength) == 0;
+}
+
+bool SAMD21Flash::EraseRow(uint16_t uRow)
+{
+  if (uRow >= m_uRows)
+    return false;
+
+  const uint8_t *pRow = m_pArea + (uint32_t)uRow * RowBytes;
+  NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;
+  NVMCTRL->ADDR.reg = (uint32_t)pRow / 2; // in 16 bit words
+  RunCommand(NVMCTRL_CTRLA_CMD_ER);
+
+  for (uint16_t i = 0; i < RowBytes; ++i)
+  {
+    if (pRow[i] != 0xff)
+      return false;
+  }
+  return true;
+}
+
+#endif
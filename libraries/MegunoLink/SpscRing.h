@@ -0,0 +1,143 @@
+/* *****************************************************************************
+*  A lock-free ring for one producer and one consumer, e.g. an interrupt
+*  handler feeding the main loop.
+*  ***************************************************************************** */
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// Indices are loaded and stored in one instruction on either side, so they
+// must not be wider than the CPU: a byte on 8 bit AVR parts.
+#if defined(__AVR__)
+typedef uint8_t SpscIndex;
+#else
+typedef uint16_t SpscIndex;
+#endif
+
+template <class T, SpscIndex MAX_ENTRIES> class SpscRing
+  /* Unlike CircularBuffer, a full ring keeps its oldest values and drops
+  the new one, counting the loss in Overflows(). The producer owns m_nHead
+  and m_nOverflows, the consumer owns m_nTail; each only reads the index of
+  the other. Indices run freely and wrap; the slot is the index masked by
+  MAX_ENTRIES - 1. The producer stores the value before publishing the new
+  head (release) and the consumer loads the head before reading the value
+  (acquire), and the same the other way round for the tail, so neither
+  side needs interrupts off or a lock. T must be copyable with memcpy. */
+{
+  static_assert(MAX_ENTRIES >= 2 && (MAX_ENTRIES & (MAX_ENTRIES - 1)) == 0,
+    "SpscRing: MAX_ENTRIES must be a power of two");
+  static_assert(MAX_ENTRIES <= (SpscIndex)~(SpscIndex)0 / 2 + 1,
+    "SpscRing: MAX_ENTRIES too large for the index type");
+
+  static const SpscIndex Mask = MAX_ENTRIES - 1;
+
+  T m_aBuffer[MAX_ENTRIES];
+
+  // Next slot to write, as a free running count. Producer only.
+  SpscIndex m_nHead;
+
+  // Next slot to read, as a free running count. Consumer only.
+  SpscIndex m_nTail;
+
+  // Values dropped because the ring was full. Producer only; wraps.
+  SpscIndex m_nOverflows;
+
+  static SpscIndex Acquire(const SpscIndex &rIndex)
+  {
+    return __atomic_load_n(&rIndex, __ATOMIC_ACQUIRE);
+  }
+
+  static void Release(SpscIndex &rIndex, SpscIndex nValue)
+  {
+    __atomic_store_n(&rIndex, nValue, __ATOMIC_RELEASE);
+  }
+
+public:
+  SpscRing()
+    /* Initializes an empty ring. */
+  {
+    m_nHead = 0;
+    m_nTail = 0;
+    m_nOverflows = 0;
+  }
+
+  bool Push(const T &Data)
+    /* Producer side. Adds a value to the ring, or returns false and counts
+    an overflow if the ring is full. Never blocks. */
+  {
+    SpscIndex nHead = m_nHead;
+    if ((SpscIndex)(nHead - Acquire(m_nTail)) == MAX_ENTRIES)
+    {
+      Release(m_nOverflows, m_nOverflows + 1);
+      return false;
+    }
+    m_aBuffer[nHead & Mask] = Data;
+    Release(m_nHead, nHead + 1);
+    return true;
+  }
+
+  bool Pop(T &Data)
+    /* Consumer side. Takes the oldest value, or returns false if the ring
+    is empty. */
+  {
+    SpscIndex nTail = m_nTail;
+    if (nTail == Acquire(m_nHead))
+      return false;
+    Data = m_aBuffer[nTail & Mask];
+    Release(m_nTail, nTail + 1);
+    return true;
+  }
+
+  SpscIndex Pop(T *pDestination, SpscIndex nMaxCount)
+    /* Consumer side. Moves up to nMaxCount of the oldest values into
+    pDestination in order, with at most two copies, and returns how many
+    were moved. The producer can keep pushing meanwhile. */
+  {
+    SpscIndex nTail = m_nTail;
+    SpscIndex nCount = Acquire(m_nHead) - nTail;
+    if (nCount > nMaxCount)
+      nCount = nMaxCount;
+    if (nCount == 0)
+      return 0;
+
+    SpscIndex nStart = nTail & Mask;
+    SpscIndex nFirst = MAX_ENTRIES - nStart;
+    if (nFirst > nCount)
+      nFirst = nCount;
+    memcpy(pDestination, m_aBuffer + nStart, nFirst * sizeof(T));
+    memcpy(pDestination + nFirst, m_aBuffer, (nCount - nFirst) * sizeof(T));
+    Release(m_nTail, nTail + nCount);
+    return nCount;
+  }
+
+  void Clear()
+    /* Consumer side. Drops every value stored so far. */
+  {
+    Release(m_nTail, Acquire(m_nHead));
+  }
+
+  SpscIndex CountStored() const
+    /* Returns the number of values waiting. Exact from the consumer; from
+    the producer it can only be too high. */
+  {
+    return (SpscIndex)(Acquire(m_nHead) - Acquire(m_nTail));
+  }
+
+  bool IsEmpty() const
+  {
+    return CountStored() == 0;
+  }
+
+  SpscIndex MaxSize() const
+  {
+    return MAX_ENTRIES;
+  }
+
+  SpscIndex Overflows() const
+    /* Returns the number of values Push() has dropped, modulo the range
+    of SpscIndex. Either side may read it. */
+  {
+    return Acquire(m_nOverflows);
+  }
+};
@@ -7,7 +7,7 @@
 #include "utility/CommandDispatcherBase.h"
 #include "utility/TCPConnection.h"
 
-template<int MAX_CONNECTIONS = 1, int MAX_COMMANDS = 10, int CP_SERIAL_BUFFER_SIZE = 30, int MAX_VARIABLES = 10>
+template<int MAX_CONNECTIONS = 1, int MAX_COMMANDS = MLP_DEFAULT_MAX_COMMANDS, int CP_SERIAL_BUFFER_SIZE = MLP_DEFAULT_BUFFER_SIZE, int MAX_VARIABLES = MLP_DEFAULT_MAX_VARIABLES>
 class TCPCommandHandler
   : public MLP::CommandDispatcherBase
   , public Print
@@ -0,0 +1,74 @@
+/************************************************************************************************
+Example Description
+Times each filter in Filter.h on the board and prints the average cost of one sample in CPU 
+cycles, for integer and float instantiations. On a part without an FPU (SAMD21, AVR) every float 
+operation is a library call, which is where the integer versions earn their keep. 
+
+Inputs come from a fixed pseudo random sequence around 7000, e.g. 70.00 degrees in hundredths. 
+
+This Example Requires:
+*  The MegunoLink arduino library https://www.megunolink.com/documentation/arduino-integration/
+************************************************************************************************/
+
+#include "Filter.h"
+
+#define ITERATIONS 2000
+
+int32_t Samples[64];
+
+void FillInputs()
+{
+  uint16_t lfsr = 0xACE1;
+  for (int i = 0; i < 64; i++)
+  {
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);
+    Samples[i] = 7000 + (lfsr % 81) - 40;
+  }
+}
+
+template<class F> void Time(const char *Name, F Filter)
+{
+  // Converted up front, so float rows do not time the conversion
+  typedef typename F::ValueType T;
+  volatile T In[64];
+  for (int i = 0; i < 64; i++)
+    In[i] = Samples[i];
+
+  volatile T Sink;
+  uint32_t Before = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    Filter.Filter(In[i & 63]);
+    Sink = Filter.Current();
+  }
+  uint32_t Elapsed = micros() - Before;
+  (void)Sink;
+
+  Serial.print(Name);
+  Serial.print(" avg ");
+  Serial.print(Elapsed * (F_CPU / 1000000) / ITERATIONS);
+  Serial.println(" cycles/sample");
+}
+
+void setup() 
+{
+  Serial.begin(9600);
+  while (!Serial);
+  FillInputs();
+
+  Time("exponential int32:", ExponentialFilter<int32_t>(10, 7000));
+  Time("exponential float:", ExponentialFilter<float>(10, 7000));
+  Time("median 3 int32:   ", MedianFilter<int32_t, 3>(7000));
+  Time("median 5 int32:   ", MedianFilter<int32_t, 5>(7000));
+  Time("median 5 float:   ", MedianFilter<float, 5>(7000));
+  Time("kalman int32:     ", KalmanFilter<int32_t>(4, 400, 7000));
+  Time("kalman float:     ", KalmanFilter<float>(4, 400, 7000));
+  Time("slew int32:       ", SlewRateLimiter<int32_t>(50, 7000));
+  Time("slew float:       ", SlewRateLimiter<float>(50, 7000));
+  Time("median > kalman:  ", FilterChain<MedianFilter<int32_t, 3>, KalmanFilter<int32_t> >(
+    MedianFilter<int32_t, 3>(7000), KalmanFilter<int32_t>(4, 400, 7000)));
+}
+
+void loop() 
+{
+}
@@ -0,0 +1,254 @@
+/*
+  Host tests of the command dispatcher and stream parser. Commands and
+  variables are found through the sorted hash table whatever the order
+  they were added in, names with the same hash are told apart, and the
+  parser reads in bulk: several messages in one read, messages split over
+  reads, long messages and overflow recovery.
+*/
+#include <stdio.h>
+#include <algorithm>
+#include "CommandDispatcher.h"
+#include "CommandProcessor.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                 \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+#define MANY 200
+
+// Delivers its input in chunks of a set size, one chunk per Process()
+class FakeStream : public Stream {
+  std::string input_;
+  size_t pos_ = 0;
+  size_t chunkEnd_ = 0;
+
+public:
+  int reads = 0;
+  int byteReads = 0;
+
+  void feed(const std::string &s) { input_ += s; }
+  // Makes up to n more bytes available; returns false once all are
+  bool next(size_t n) {
+    chunkEnd_ = std::min(input_.size(), chunkEnd_ + n);
+    return pos_ < input_.size();
+  }
+  int available() override { return int(chunkEnd_ - pos_); }
+  int read() override {
+    byteReads++;
+    return pos_ < chunkEnd_ ? input_[pos_++] : -1;
+  }
+  size_t readBytes(char *buffer, size_t length) override {
+    reads++;
+    size_t n = std::min(length, chunkEnd_ - pos_);
+    memcpy(buffer, input_.data() + pos_, n);
+    pos_ += n;
+    return n;
+  }
+};
+
+static FakeStream serial;
+Stream &Serial = serial;
+
+// Exposes the hash to find colliding names
+struct Dispatcher : public CommandDispatcher<5, MANY> {
+  static uint16_t HashOf(const char *name) { return Hash(name); }
+};
+
+static std::string calls;
+static void cmdSet(CommandParameter &p) {
+  calls += "set:";
+  calls += p.RemainingParameters();
+  calls += ";";
+}
+static void cmdSetpoint(CommandParameter &p) {
+  calls += "setpoint:";
+  calls += p.RemainingParameters();
+  calls += ";";
+}
+static void cmdA(CommandParameter &) { calls += "a;"; }
+static void cmdB(CommandParameter &) { calls += "b;"; }
+static void cmdParams(CommandParameter &p) {
+  const char *param;
+  int count = 0;
+  long last = 0;
+  while ((param = p.NextParameter()) != NULL) {
+    count++;
+    last = atol(param);
+  }
+  char ach[32];
+  snprintf(ach, sizeof(ach), "params:%d,%ld;", count, last);
+  calls += ach;
+}
+static int unknown = 0;
+static void onUnknown() { unknown++; }
+
+static char names[MANY][8];
+static int32_t values[MANY];
+static char collision[2][12];
+
+static void build(Dispatcher &d) {
+  // Added in reverse so the table has to sort them
+  for (int i = MANY - 1; i >= 0; i--) {
+    snprintf(names[i], sizeof(names[i]), "v%d", i);
+    values[i] = -1;
+    CHECK(d.AddVariable(F(names[i]), values[i]));
+  }
+  CHECK(d.AddCommand(F("setpoint"), cmdSetpoint));
+  CHECK(d.AddCommand(F("set"), cmdSet));
+  CHECK(d.AddCommand(F("params"), cmdParams));
+
+  // Two short names with the same hash
+  static int32_t first[65536];
+  memset(first, 0xFF, sizeof(first));
+  bool found = false;
+  for (int32_t i = 0; i < 100000 && !found; i++) {
+    char name[8];
+    snprintf(name, sizeof(name), "c%d", int(i));
+    uint16_t h = Dispatcher::HashOf(name);
+    if (first[h] >= 0) {
+      snprintf(collision[0], sizeof(collision[0]), "c%d", int(first[h]));
+      strcpy(collision[1], name);
+      found = true;
+    }
+    first[h] = i;
+  }
+  CHECK(found);
+  CHECK(d.AddCommand(F(collision[0]), cmdA));
+  CHECK(d.AddCommand(F(collision[1]), cmdB));
+  CHECK(!d.AddCommand(F("full"), cmdA));
+  d.SetDefaultHandler(onUnknown);
+}
+
+static void dispatch(Dispatcher &d, const char *message) {
+  char buffer[64];
+  strcpy(buffer, message);
+  d.DispatchCommand(buffer, serial);
+}
+
+static void testLookup(Dispatcher &d) {
+  printf("lookup\n");
+  for (int i = 0; i < MANY; i++) {
+    char message[32];
+    snprintf(message, sizeof(message), "v%d %d", i, i * 3);
+    dispatch(d, message);
+  }
+  bool all = true;
+  for (int i = 0; i < MANY; i++)
+    all = all && values[i] == i * 3;
+  CHECK(all);
+
+  calls.clear();
+  dispatch(d, "set 12");
+  dispatch(d, "setpoint 34");
+  dispatch(d, "set");
+  CHECK(calls == "set:12;setpoint:34;set:;");
+
+  printf("  %s and %s share hash %04x\n", collision[0], collision[1],
+         Dispatcher::HashOf(collision[0]));
+  calls.clear();
+  dispatch(d, collision[1]);
+  dispatch(d, collision[0]);
+  CHECK(calls == "b;a;");
+
+  unknown = 0;
+  dispatch(d, "se 1");
+  dispatch(d, "setpoints 1");
+  dispatch(d, "v200");
+  dispatch(d, "");
+  CHECK(unknown == 4);
+
+  serial.Output.clear();
+  dispatch(d, "v7 ?");
+  CHECK(serial.Output == "v7=21\r\n");
+}
+
+// Runs the whole input through the parser chunk bytes at a time
+template <int SIZE>
+static void run(CommandProcessor<SIZE> &parser, const std::string &input, size_t chunk) {
+  serial.feed(input);
+  while (serial.next(chunk))
+    parser.Process();
+  parser.Process();
+}
+
+static void testParser(Dispatcher &d) {
+  printf("parser\n");
+  std::string input = "noise!set 1\r!setpoint 2\r\r!set 3";
+  input += "\r!set!set 4\r";
+  for (size_t chunk : {1, 2, 3, 7, 100}) {
+    CommandProcessor<32> parser(d, serial);
+    calls.clear();
+    run(parser, input, chunk);
+    if (calls != "set:1;setpoint:2;set:3;set:4;")
+      printf("  chunk %u: %s\n", unsigned(chunk), calls.c_str());
+    CHECK(calls == "set:1;setpoint:2;set:3;set:4;");
+  }
+
+  // Many messages from one read
+  std::string burst;
+  for (int i = 0; i < 100; i++) {
+    char message[32];
+    snprintf(message, sizeof(message), "!v%d %d\r", i, i + 1000);
+    burst += message;
+  }
+  {
+    CommandProcessor<32> parser(d, serial);
+    serial.reads = serial.byteReads = 0;
+    run(parser, burst, burst.size());
+    bool all = true;
+    for (int i = 0; i < 100; i++)
+      all = all && values[i] == i + 1000;
+    CHECK(all);
+    CHECK(serial.byteReads == 0);
+    printf("  %u bytes in %d reads\n", unsigned(burst.size()), serial.reads);
+    CHECK(serial.reads <= int(burst.size() / 16));
+  }
+}
+
+static void testLongMessages(Dispatcher &d) {
+  printf("long messages\n");
+  // Parameters more than 255 bytes in
+  std::string message = "!params";
+  for (int i = 1; i <= 100; i++)
+    message += " " + std::to_string(i);
+  message += "\r";
+  CHECK(message.size() > 280);
+  {
+    CommandProcessor<400> parser(d, serial);
+    calls.clear();
+    run(parser, message, 64);
+    CHECK(calls == "params:100,100;");
+  }
+
+  // Too long for the buffer: dropped, and the next message still works
+  {
+    CommandProcessor<32> parser(d, serial);
+    calls.clear();
+    run(parser, message + "!set 5\r" + message + "!set 6\r", 13);
+    CHECK(calls == "set:5;set:6;");
+
+    // Exactly fills the buffer, terminator included
+    std::string fits = "!set ";
+    fits += std::string(32 - fits.size() - 1, 'x') + "\r";
+    std::string over = "!set " + std::string(32 - 5, 'y') + "\r";
+    calls.clear();
+    run(parser, fits + over + "!set 7\r", 5);
+    CHECK(calls == "set:" + std::string(26, 'x') + ";set:7;");
+  }
+}
+
+int main() {
+  Dispatcher d;
+  build(d);
+  testLookup(d);
+  testParser(d);
+  testLongMessages(d);
+  printf(failures ? "%d FAILED\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+/*
+  Just enough of the Arduino core to build the command parser on a host.
+  Flash strings are ordinary strings and output is collected in a
+  std::string.
+*/
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef const char *PGM_P;
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define pgm_read_byte_near(p) (*(const uint8_t *)(p))
+
+class Print
+{
+public:
+  std::string Output;
+
+  virtual ~Print() {}
+  size_t print(const char *s) { Output += s; return strlen(s); }
+  size_t print(const __FlashStringHelper *s) { return print((const char *)s); }
+  size_t print(char c) { Output += c; return 1; }
+  size_t print(long n) { return Format("%ld", n); }
+  size_t print(unsigned long n) { return Format("%lu", n); }
+  size_t print(int n) { return print((long)n); }
+  size_t print(unsigned int n) { return print((unsigned long)n); }
+  size_t print(unsigned char n) { return print((unsigned long)n); }
+  size_t print(double f) { return Format("%.2f", f); }
+  size_t println() { Output += "\r\n"; return 2; }
+  template<class T> size_t println(T Value) { size_t n = print(Value); return n + println(); }
+
+private:
+  size_t Format(const char *pchFormat, ...) __attribute__((format(printf, 2, 3)))
+  {
+    char ach[32];
+    va_list args;
+    va_start(args, pchFormat);
+    int n = vsnprintf(ach, sizeof(ach), pchFormat, args);
+    va_end(args);
+    Output += ach;
+    return n;
+  }
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual size_t readBytes(char *pchBuffer, size_t uLength) = 0;
+};
+
+extern Stream &Serial;
@@ -0,0 +1,49 @@
+/*
+  Time per sample of each filter in Filter.h on the host, for the integer
+  and float instantiations, and of the chain Brewhob runs on its RTDs. The
+  numbers only rank the filters against each other; FilterBenchmark in
+  examples/ measures cycles on the board itself.
+*/
+#include <chrono>
+#include <stdio.h>
+#include "Filter.h"
+
+#define SAMPLES 2000000
+
+template <class F> static void run(const char *name, F filter) {
+  typedef typename F::ValueType T;
+  T in[64];
+  uint16_t lfsr = 0xACE1;
+  for (int n = 0; n < 64; n++) {
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);
+    in[n] = T(7000 + (lfsr % 81) - 40);
+  }
+
+  volatile T sink;
+  auto start = std::chrono::steady_clock::now();
+  for (long n = 0; n < SAMPLES; n++) {
+    filter.Filter(in[n & 63]);
+    sink = filter.Current();
+  }
+  auto end = std::chrono::steady_clock::now();
+  (void)sink;
+  printf("%-28s %6.2f\n", name,
+         std::chrono::duration<double, std::nano>(end - start).count() / SAMPLES);
+}
+
+int main() {
+  printf("                             ns/sample\n");
+  run("exponential int32", ExponentialFilter<int32_t>(10, 7000));
+  run("exponential float", ExponentialFilter<float>(10, 7000));
+  run("median 3 int32", MedianFilter<int32_t, 3>(7000));
+  run("median 5 int32", MedianFilter<int32_t, 5>(7000));
+  run("median 5 float", MedianFilter<float, 5>(7000));
+  run("kalman int32", KalmanFilter<int32_t>(4, 400, 7000));
+  run("kalman float", KalmanFilter<float>(4, 400, 7000));
+  run("slew int32", SlewRateLimiter<int32_t>(50, 7000));
+  run("slew float", SlewRateLimiter<float>(50, 7000));
+  run("median 3 > kalman int32",
+      FilterChain<MedianFilter<int32_t, 3>, KalmanFilter<int32_t> >(
+          MedianFilter<int32_t, 3>(7000), KalmanFilter<int32_t>(4, 400, 7000)));
+  return 0;
+}
@@ -0,0 +1,202 @@
+/*
+  Host tests of the filters in Filter.h. Fixed-point instantiations are
+  checked against the float ones and against closed forms: the median
+  against a sort of the window, the Kalman gain against the steady state
+  of the Riccati equation.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include "Filter.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                 \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+// The same noise every run, roughly uniform in [-amplitude, amplitude]
+struct Noise {
+  uint32_t state = 12345;
+  int32_t next(int32_t amplitude) {
+    state = state * 1103515245 + 12345;
+    return int32_t((state >> 8) % (2 * amplitude + 1)) - amplitude;
+  }
+};
+
+static void testMedian(void) {
+  printf("median\n");
+  MedianFilter<int16_t, 3> m(72);
+  CHECK(m.Current() == 72);
+
+  // a lone glitch never gets through
+  const int16_t in[] = {100, 100, 900, 100, 100, -500, 100};
+  for (int16_t v : in) {
+    m.Filter(v);
+    CHECK(m.Current() == 100);
+  }
+
+  // a step gets through after (N + 1)/2 samples
+  m.Filter(200);
+  CHECK(m.Current() == 100);
+  m.Filter(200);
+  CHECK(m.Current() == 200);
+
+  m.SetCurrent(5);
+  CHECK(m.Current() == 5);
+  m.Filter(7);
+  CHECK(m.Current() == 7);
+
+  // against a sort of the window, duplicates included
+  MedianFilter<int32_t, 7> wide(0);
+  Noise noise;
+  int32_t window[7];
+  for (int n = 0; n < 2000; n++) {
+    int32_t v = noise.next(20);
+    window[n % 7] = v;
+    wide.Filter(v);
+    int count = n < 7 ? n + 1 : 7;
+    int32_t sorted[7];
+    std::copy(window, window + count, sorted);
+    std::sort(sorted, sorted + count);
+    CHECK(wide.Current() == sorted[(count - 1) / 2]);
+  }
+
+  MedianFilter<float, 5> f(0);
+  const float fin[] = {1.5f, 2.5f, 100, 0.5f, 2};
+  for (float v : fin)
+    f.Filter(v);
+  CHECK(f.Current() == 2);
+}
+
+static void testKalman(void) {
+  printf("kalman\n");
+  const float q = 4, r = 400;
+
+  // the first sample replaces a guess, an initial variance weighs it
+  KalmanFilter<int32_t> k(4, 400, 72);
+  CHECK(k.Current() == 72);
+  k.Filter(2000);
+  CHECK(k.Current() == 2000);
+  KalmanFilter<float> trusted(q, r, 0, r);
+  trusted.Filter(100);
+  CHECK(fabs(trusted.Current() - 50.2f) < 0.1f);
+
+  // the gain settles at the steady state of P- = P + Q, P = P- R/(P- + R)
+  KalmanFilter<float> f(q, r, 0);
+  KalmanFilter<int32_t> i(4, 400, 0);
+  f.Filter(0);
+  i.Filter(0);
+  for (int n = 0; n < 500; n++) {
+    f.Filter(0);
+    i.Filter(0);
+  }
+  float prior = (q + sqrtf(q * q + 4 * q * r)) / 2;
+  float posterior = prior * r / (prior + r);
+  CHECK(fabs(f.Variance() - posterior) < 0.01f * posterior);
+  CHECK(abs(i.Variance() - int32_t(posterior)) <= 1);
+
+  // fixed point follows float on noisy data to within a count once the
+  // step from 0 has settled. Until then the rounding of the Q15 gain acts
+  // on an error of up to 20000 counts, a few counts at most
+  Noise noise;
+  int worst = 0;
+  for (int n = 0; n < 5000; n++) {
+    int32_t v = 20000 + n + noise.next(60);
+    f.Filter(v);
+    i.Filter(v);
+    int diff = abs(i.Current() - int32_t(lroundf(f.Current())));
+    if (n >= 100)
+      worst = std::max(worst, diff);
+    else
+      CHECK(diff <= 4);
+  }
+  CHECK(worst <= 1);
+
+  // white noise comes out with K/(2 - K) of its variance
+  KalmanFilter<int16_t> s(4, 400, 0);
+  double in = 0, out = 0;
+  for (int n = 0; n < 20000; n++) {
+    int16_t v = noise.next(34); // variance about 400
+    s.Filter(v);
+    if (n > 100) {
+      in += double(v) * v;
+      out += double(s.Current()) * s.Current();
+    }
+  }
+  float gain = prior / (prior + r);
+  double ratio = out / in;
+  CHECK(ratio > 0.8 * gain / (2 - gain) && ratio < 1.25 * gain / (2 - gain));
+}
+
+static void testSlew(void) {
+  printf("slew\n");
+  SlewRateLimiter<int16_t> s(10, 0);
+  s.Filter(35);
+  CHECK(s.Current() == 10);
+  s.Filter(35);
+  s.Filter(35);
+  CHECK(s.Current() == 30);
+  s.Filter(35);
+  CHECK(s.Current() == 35);
+  s.Filter(-100);
+  CHECK(s.Current() == 25);
+  s.Filter(20);
+  CHECK(s.Current() == 20);
+
+  SlewRateLimiter<float> f(0.5f, 1);
+  f.Filter(-1);
+  CHECK(f.Current() == 0.5f);
+  f.SetMaxStep(5);
+  f.Filter(-1);
+  CHECK(f.Current() == -1);
+}
+
+static void testChain(void) {
+  printf("chain\n");
+  typedef MedianFilter<int32_t, 3> Median;
+  typedef KalmanFilter<int32_t> Kalman;
+  typedef SlewRateLimiter<int32_t> Slew;
+
+  // a chain does exactly what the stages do by hand
+  FilterChain<Median, Kalman, Slew> chain(Median(0), Kalman(4, 400, 0), Slew(50, 0));
+  Median m(0);
+  Kalman k(4, 400, 0);
+  Slew s(50, 0);
+  Noise noise;
+  for (int n = 0; n < 1000; n++) {
+    int32_t v = 7000 + (n % 97 == 0 ? 5000 : noise.next(40));
+    chain.Filter(v);
+    m.Filter(v);
+    k.Filter(m.Current());
+    s.Filter(k.Current());
+    CHECK(chain.Current() == s.Current());
+  }
+  CHECK(chain.Head().Current() == m.Current());
+  CHECK(chain.Tail().Head().Current() == k.Current());
+
+  // chains nest, and mixed types convert between stages
+  FilterChain<FilterChain<Median>, ExponentialFilter<float> > nested(
+      FilterChain<Median>(Median(0)), ExponentialFilter<float>(50, 0));
+  nested.Filter(10);
+  nested.Filter(10);
+  CHECK(fabs(nested.Current() - 7.5f) < 1e-6f);
+  nested.SetCurrent(3);
+  CHECK(nested.Current() == 3);
+  CHECK(nested.Head().Current() == 3);
+}
+
+int main() {
+  testMedian();
+  testKalman();
+  testSlew();
+  testChain();
+
+  printf(failures ? "%d FAILED\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,260 @@
+/*
+  Host tests of FlashStore on a simulated flash: rows of four 64 byte pages
+  that erase to all ones, where a write can only clear bits. Checks that
+  only changed chunks are written, that erases spread evenly over the rows
+  and stay out of Save() while Service() is called, and that the store
+  recovers from power cut at any flash operation, mid write or mid erase.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "FlashStore.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                 \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+#define ROW_SIZE  256
+#define PAGE_SIZE 64
+
+class SimulatedFlash : public MLP::FlashMemory {
+  std::vector<uint8_t> bytes_;
+  uint16_t rows_;
+  long cutAt_ = -1; // operation the power fails in, -1 for never
+  bool dead_ = false;
+
+  // Returns false once the power is gone; true for the operation it fails in
+  bool step(bool &torn) {
+    torn = false;
+    if (dead_)
+      return false;
+    operations++;
+    if (cutAt_ >= 0 && operations > cutAt_) {
+      torn = dead_ = true;
+    }
+    return true;
+  }
+
+public:
+  long operations = 0;
+  long writes = 0;
+  long violations = 0; // writes to words that were not erased
+  std::vector<long> erases;
+
+  SimulatedFlash(uint16_t rows) : bytes_(rows * ROW_SIZE, 0), rows_(rows), erases(rows, 0) {}
+
+  void cutPowerAfter(long count) { cutAt_ = operations + count; }
+  bool dead() const { return dead_; }
+  void powerOn() { dead_ = false; cutAt_ = -1; }
+
+  uint16_t RowCount() const override { return rows_; }
+  uint16_t RowSize() const override { return ROW_SIZE; }
+
+  void Read(uint32_t offset, void *destination, uint16_t length) override {
+    memcpy(destination, &bytes_[offset], length);
+  }
+
+  bool Write(uint32_t offset, const void *source, uint16_t length) override {
+    bool torn;
+    if (!step(torn))
+      return false;
+    if (offset % 4 || length % 4 || offset / PAGE_SIZE != (offset + length - 1) / PAGE_SIZE)
+      violations++;
+    writes++;
+    const uint8_t *s = (const uint8_t *)source;
+    // A torn write programs some words, and part of the bits of one more
+    uint16_t done = torn ? (rand() % (length / 4 + 1)) * 4 : length;
+    for (uint16_t i = 0; i < length; i += 4) {
+      if (memcmp(&bytes_[offset + i], "\xff\xff\xff\xff", 4) != 0)
+        violations++;
+      for (uint16_t b = i; b < i + 4; b++) {
+        uint8_t value = s[b];
+        if (i >= done)
+          value |= i == done ? rand() : 0xff;
+        bytes_[offset + b] &= value;
+      }
+    }
+    return !torn && memcmp(&bytes_[offset], source, length) == 0;
+  }
+
+  bool EraseRow(uint16_t row) override {
+    bool torn;
+    if (!step(torn))
+      return false;
+    erases[row]++;
+    for (uint16_t i = 0; i < ROW_SIZE; i++) {
+      if (!torn || rand() % 2)
+        bytes_[row * ROW_SIZE + i] = 0xff;
+    }
+    return !torn;
+  }
+};
+
+// 80 bytes: seven chunks, the last one partly used
+struct TestSettings {
+  int32_t values[20];
+  void Reset() {
+    for (int i = 0; i < 20; i++)
+      values[i] = i;
+  }
+};
+
+typedef FlashStore<TestSettings> Store;
+#define CHUNKS 7
+
+static bool same(const TestSettings &a, const TestSettings &b) {
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static void change(TestSettings &s, int count) {
+  for (int i = 0; i < count; i++)
+    s.values[rand() % 20] = rand();
+}
+
+static void testBasic(void) {
+  printf("basic\n");
+  SimulatedFlash flash(4);
+  Store store(flash);
+  CHECK(!store.Load());
+  CHECK(store.Data.values[5] == 5);
+  CHECK(store.Save());
+  CHECK(!store.Save());
+
+  store.Data.values[4] = 44;
+  long before = flash.writes;
+  CHECK(store.Save());
+  CHECK(flash.writes - before == 1); // chunk 1 only
+  store.Data.values[19] = 1919;
+  store.Data.values[0] = 100;
+  before = flash.writes;
+  CHECK(store.Save());
+  CHECK(flash.writes - before == 2);
+
+  Store reboot(flash);
+  CHECK(same(reboot.Data, store.Data));
+  CHECK(reboot.Data.values[19] == 1919);
+  CHECK(!reboot.Save());
+
+  // A different layout does not load
+  struct Other {
+    int32_t values[21];
+    void Reset() {}
+  };
+  FlashStore<Other> other(flash);
+  CHECK(!other.Load());
+  CHECK(flash.violations == 0);
+}
+
+static void wear(bool service, long saves) {
+  SimulatedFlash flash(6);
+  Store store(flash);
+  store.Save(); // erases the first row of the zeroed area
+  TestSettings expected = store.Data;
+  long erasesInSave = 0;
+  for (long n = 0; n < saves; n++) {
+    change(store.Data, 1 + rand() % 2);
+    long erasesBefore = 0;
+    for (long e : flash.erases)
+      erasesBefore += e;
+    store.Save();
+    long erasesAfter = 0;
+    for (long e : flash.erases)
+      erasesAfter += e;
+    erasesInSave += erasesAfter - erasesBefore;
+    expected = store.Data;
+    if (service)
+      while (store.Service())
+        if (rand() % 2)
+          break;
+  }
+  Store reboot(flash);
+  CHECK(same(reboot.Data, expected));
+  CHECK(flash.violations == 0);
+
+  long lo = flash.erases[0], hi = lo;
+  for (long e : flash.erases) {
+    lo = e < lo ? e : lo;
+    hi = e > hi ? e : hi;
+  }
+  printf("  %s Service(): %ld saves, %ld to %ld erases a row, %ld erases in Save()\n",
+         service ? "with" : "without", saves, lo, hi, erasesInSave);
+  CHECK(hi - lo <= 1);
+  if (service)
+    CHECK(erasesInSave == 0);
+}
+
+static void testWear(void) {
+  printf("wear leveling\n");
+  wear(true, 20000);
+  wear(false, 20000);
+}
+
+// Cuts the power at every point of a run of saves and compactions, and
+// checks each chunk comes back with its value from before or after the
+// Save() that was interrupted
+static void testPowerLoss(void) {
+  printf("power loss\n");
+  long cuts = 0, torn = 0;
+  for (int trial = 0; trial < 400; trial++) {
+    SimulatedFlash flash(2 + trial % 3);
+    TestSettings committed;
+    {
+      Store store(flash);
+      store.Save();
+      committed = store.Data;
+    }
+    for (int round = 0; round < 20; round++) {
+      Store store(flash);
+      if (!store.Load() || !same(store.Data, committed)) {
+        CHECK(same(store.Data, committed));
+        return;
+      }
+      flash.cutPowerAfter(rand() % 40);
+      TestSettings pending = committed;
+      while (!flash.dead()) {
+        change(store.Data, 1 + rand() % 4);
+        TestSettings attempt = store.Data;
+        store.Save();
+        if (flash.dead()) {
+          pending = attempt;
+          break;
+        }
+        pending = committed = store.Data;
+        while (!flash.dead() && store.Service() && rand() % 3)
+          ;
+      }
+      cuts++;
+      flash.powerOn();
+
+      Store reboot(flash);
+      CHECK(reboot.Load());
+      bool mixed = false;
+      for (int c = 0; c < CHUNKS; c++) {
+        int first = c * 3, last = first + 3 < 20 ? first + 3 : 20;
+        bool old = memcmp(&reboot.Data.values[first], &committed.values[first], (last - first) * 4) == 0;
+        bool young = memcmp(&reboot.Data.values[first], &pending.values[first], (last - first) * 4) == 0;
+        CHECK(old || young);
+        mixed |= !old;
+      }
+      torn += mixed;
+      committed = reboot.Data;
+      CHECK(flash.violations == 0);
+    }
+  }
+  printf("  %ld power cuts, %ld kept some of the Save() they cut short\n", cuts, torn);
+}
+
+int main() {
+  srand(1);
+  testBasic();
+  testWear();
+  testPowerLoss();
+  printf(failures ? "%d FAILED\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+/*
+  Host tests of SpscRing. The single threaded part checks wrap-around,
+  bulk pops across the end of the buffer and the overflow count. The
+  stress part runs a producer and a consumer thread flat out against a
+  small ring: every value must arrive once, in order and intact, and what
+  did not arrive must show up in Overflows().
+*/
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include "SpscRing.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                 \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+#define STRESS_VALUES 1000000
+
+// Big enough that a torn copy would show
+struct Sample {
+  uint32_t seq;
+  uint32_t check;
+  uint32_t pad[2];
+};
+
+static Sample make(uint32_t seq) {
+  Sample s = {seq, ~seq * 2654435761u, {seq, ~seq}};
+  return s;
+}
+
+static bool intact(const Sample &s) {
+  return s.check == ~s.seq * 2654435761u && s.pad[0] == s.seq && s.pad[1] == ~s.seq;
+}
+
+static void testBasic(void) {
+  printf("basic\n");
+  SpscRing<int, 4> ring;
+  int v;
+  CHECK(ring.IsEmpty());
+  CHECK(!ring.Pop(v));
+
+  // fill, overflow, and wrap the free running indices many times
+  for (int round = 0; round < 40000; round++) {
+    for (int i = 0; i < 4; i++)
+      CHECK(ring.Push(round * 4 + i));
+    CHECK(!ring.Push(-1));
+    CHECK(ring.CountStored() == 4);
+    for (int i = 0; i < 4; i++) {
+      CHECK(ring.Pop(v));
+      CHECK(v == round * 4 + i);
+    }
+    CHECK(ring.IsEmpty());
+  }
+  CHECK(ring.Overflows() == SpscIndex(40000));
+
+  ring.Push(1);
+  ring.Push(2);
+  ring.Clear();
+  CHECK(ring.IsEmpty());
+}
+
+static void testBulk(void) {
+  printf("bulk pop\n");
+  SpscRing<int, 8> ring;
+  int out[8];
+
+  // start near the end of the buffer so the copy wraps
+  for (int i = 0; i < 6; i++)
+    ring.Push(i);
+  CHECK(ring.Pop(out, 8) == 6);
+  for (int i = 0; i < 7; i++)
+    ring.Push(100 + i);
+  CHECK(ring.Pop(out, 3) == 3);
+  CHECK(out[0] == 100 && out[2] == 102);
+  CHECK(ring.Pop(out, 8) == 4);
+  CHECK(out[0] == 103 && out[3] == 106);
+  CHECK(ring.Pop(out, 8) == 0);
+}
+
+// The consumer alternates single and bulk pops. Both sides yield when
+// they cannot make progress, so the test also runs on a single core.
+static void stress(bool retry) {
+  SpscRing<Sample, 16> ring;
+  std::atomic<bool> done(false);
+  uint32_t delivered = 0, expected = 0, gaps = 0;
+  bool ok = true;
+
+  std::thread producer([&ring, &done, retry]() {
+    for (uint32_t i = 0; i < STRESS_VALUES; i++) {
+      while (!ring.Push(make(i)) && retry)
+        std::this_thread::yield();
+      if (!retry && (i & 63) == 0)
+        std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  Sample batch[8];
+  for (uint32_t n = 0;; n++) {
+    bool finished = done;
+    SpscIndex count = 0;
+    if (n & 1)
+      count = ring.Pop(batch, 1 + n % 8);
+    else if (ring.Pop(batch[0]))
+      count = 1;
+    for (SpscIndex i = 0; i < count; i++) {
+      if (!intact(batch[i]) || batch[i].seq < expected)
+        ok = false;
+      gaps += batch[i].seq - expected;
+      expected = batch[i].seq + 1;
+      delivered++;
+    }
+    if (count == 0) {
+      if (finished && ring.IsEmpty())
+        break;
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  CHECK(ok);
+  if (retry) {
+    // refused pushes still count as overflows
+    CHECK(delivered == STRESS_VALUES);
+  } else {
+    // every dropped value is a gap in the sequence or missing at the end
+    uint32_t lost = STRESS_VALUES - delivered;
+    CHECK(gaps + (STRESS_VALUES - expected) == lost);
+    CHECK(SpscIndex(lost) == ring.Overflows());
+  }
+  printf("  %u delivered, %u dropped\n", delivered, STRESS_VALUES - delivered);
+}
+
+static void testStress(void) {
+  printf("two threads, producer retries\n");
+  stress(true);
+  printf("two threads, producer drops\n");
+  stress(false);
+}
+
+int main() {
+  testBasic();
+  testBulk();
+  testStress();
+
+  printf(failures ? "%d FAILED\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -3,8 +3,37 @@
 
 using namespace MLP;
 
+// Opens a gap for an entry with hash uHash, after any entries with the same
+// hash, and returns it. The table must have room for one more. 
+template<class T> static T *InsertSorted(T *pTable, uint16_t &ruCount, uint16_t uHash)
+{
+  uint16_t uPosition = ruCount;
+  while (uPosition > 0 && pTable[uPosition - 1].m_uHash > uHash)
+  {
+    pTable[uPosition] = pTable[uPosition - 1];
+    --uPosition;
+  }
+  ++ruCount;
+  pTable[uPosition].m_uHash = uHash;
+  return pTable + uPosition;
+}
+
+// First entry whose hash is not below uHash. 
+template<class T> static T *FindFirst(T *pTable, uint16_t uCount, uint16_t uHash)
+{
+  uint16_t uLow = 0, uHigh = uCount;
+  while (uLow < uHigh)
+  {
+    uint16_t uMiddle = (uLow + uHigh) / 2;
+    if (pTable[uMiddle].m_uHash < uHash)
+      uLow = uMiddle + 1;
+    else
+      uHigh = uMiddle;
+  }
+  return pTable + uLow;
+}
 
-CommandDispatcherBase::CommandDispatcherBase( CommandCallback *pCallbackBuffer, uint8_t uCallbackBufferLength, VariableMap *pVariableMapBuffer, uint8_t uVariableMapLength)
+CommandDispatcherBase::CommandDispatcherBase( CommandCallback *pCallbackBuffer, uint16_t uCallbackBufferLength, VariableMap *pVariableMapBuffer, uint16_t uVariableMapLength)
   : m_uMaxCommands(uCallbackBufferLength), m_pCommands(pCallbackBuffer)
   , m_uMaxVariables(uVariableMapLength), m_pVariableMap(pVariableMapBuffer)
 {
@@ -17,9 +46,9 @@ bool CommandDispatcherBase::AddCommand( const __FlashStringHelper *pCommand, voi
 {
   if (m_uLastCommand < m_uMaxCommands)
   {
-    m_pCommands[m_uLastCommand].m_Callback = CallbackFunction;
-    m_pCommands[m_uLastCommand].m_strCommand = (PGM_P )pCommand;
-    ++m_uLastCommand;
+    CommandCallback *pEntry = InsertSorted(m_pCommands, m_uLastCommand, Hash((PGM_P )pCommand));
+    pEntry->m_Callback = CallbackFunction;
+    pEntry->m_strCommand = (PGM_P )pCommand;
     return true;
   }
 
@@ -87,66 +116,67 @@ bool CommandDispatcherBase::AddVariable(const __FlashStringHelper *pName, double
 
 bool CommandDispatcherBase::AddVariable(const __FlashStringHelper *pName, char *pchBuffer, uint8_t uMaxBufferSize)
 {
-  if (m_uLastVariable < m_uMaxVariables)
-  {
-    m_pVariableMap[m_uLastVariable].m_strName = (PGM_P )pName;
-    m_pVariableMap[m_uLastVariable].m_pVariable = pchBuffer;
-    m_pVariableMap[m_uLastVariable].m_uMaxBufferSize = uMaxBufferSize;
-    m_pVariableMap[m_uLastVariable].m_Callback = ProcessVariable_string;
-    ++m_uLastVariable;
-    return true;
-  }
+  VariableMap *pEntry = InsertVariable(pName);
+  if (pEntry == NULL)
+    return false; // too many variables stored already. 
 
-  return false; // too many variables stored already. 
+  pEntry->m_pVariable = pchBuffer;
+  pEntry->m_uMaxBufferSize = uMaxBufferSize;
+  pEntry->m_Callback = ProcessVariable_string;
+  return true;
 }
 
 bool CommandDispatcherBase::AddVariable(const __FlashStringHelper *pName, void *pVariable, bool(*ProcessFunction)(VariableMap &rVariableInfo, CommandParameter &rParameters, bool bPrintOnSet))
 {
-  if (m_uLastVariable < m_uMaxVariables)
-  {
-    m_pVariableMap[m_uLastVariable].m_strName = (PGM_P )pName;
-    m_pVariableMap[m_uLastVariable].m_pVariable = pVariable;
-    m_pVariableMap[m_uLastVariable].m_Callback = ProcessFunction;
-    ++m_uLastVariable;
-    return true;
-  }
+  VariableMap *pEntry = InsertVariable(pName);
+  if (pEntry == NULL)
+    return false; // too many variables stored already. 
+
+  pEntry->m_pVariable = pVariable;
+  pEntry->m_Callback = ProcessFunction;
+  return true;
+}
 
-  return false; // too many variables stored already. 
+VariableMap *CommandDispatcherBase::InsertVariable(const __FlashStringHelper *pName)
+{
+  if (m_uLastVariable >= m_uMaxVariables)
+    return NULL;
+
+  VariableMap *pEntry = InsertSorted(m_pVariableMap, m_uLastVariable, Hash((PGM_P )pName));
+  pEntry->m_strName = (PGM_P )pName;
+  return pEntry;
 }
 
 void CommandDispatcherBase::DispatchCommand( char *pchMessage, Print &rSource ) const
 {
-  uint8_t uCommand, uParameterStart;
-  CommandCallback *pCommand;
-  uCommand = m_uLastCommand;
-  pCommand = m_pCommands;
-  while(uCommand--)
+  // The command name runs up to the first space. Parameters follow it and
+  // are tokenized in place by CommandParameter. 
+  uint16_t uLength;
+  uint16_t uHash = Hash(pchMessage, uLength);
+  uint16_t uParameterStart = pchMessage[uLength] == ' ' ? uLength + 1 : uLength;
+
+  const CommandCallback *pCommandEnd = m_pCommands + m_uLastCommand;
+  for (const CommandCallback *pCommand = FindFirst(m_pCommands, m_uLastCommand, uHash);
+    pCommand != pCommandEnd && pCommand->m_uHash == uHash; ++pCommand)
   {
-    uParameterStart = MatchCommand(pCommand->m_strCommand, pchMessage);
-
-    if (uParameterStart != NO_MATCH)
+    if (MatchName(pCommand->m_strCommand, pchMessage, uLength))
     {
       CommandParameter Parameters(rSource, pchMessage, uParameterStart);
       pCommand->m_Callback(Parameters);
       return;
     }
-
-    ++pCommand;
   }
 
-  uCommand = m_uLastVariable;
-  VariableMap *pVariableMap = m_pVariableMap;
-  while (uCommand--)
+  VariableMap *pVariableEnd = m_pVariableMap + m_uLastVariable;
+  for (VariableMap *pVariableMap = FindFirst(m_pVariableMap, m_uLastVariable, uHash);
+    pVariableMap != pVariableEnd && pVariableMap->m_uHash == uHash; ++pVariableMap)
   {
-    uParameterStart = MatchCommand(pVariableMap->m_strName, pchMessage);
-    if (uParameterStart != NO_MATCH)
+    if (MatchName(pVariableMap->m_strName, pchMessage, uLength))
     {
       CommandParameter Parameters(rSource, pchMessage, uParameterStart);
       pVariableMap->m_Callback(*pVariableMap, Parameters, true);
       return;
     }
-
-    ++pVariableMap;
   }
 
   // No command matched. 
@@ -160,21 +190,43 @@ void CommandDispatcherBase::DispatchCommand( char *pchMessage, Print &rSource )
   }
 }
 
-uint8_t CommandDispatcherBase::MatchCommand( PGM_P pchCommand, const char *pchTest ) const
+// Bernstein's xor hash, cut to 16 bits: a shift and two adds a character,
+// cheap on 8 bit parts. Collisions only cost an extra name compare. 
+#define HASH_SEED 5381
+#define HASH_STEP(uHash, ch) ((uint16_t)(((uHash) << 5) + (uHash)) ^ (uint8_t)(ch))
+
+uint16_t CommandDispatcherBase::Hash(PGM_P pchName)
 {
-  char chCommand, chTest;
-  uint8_t uParameterStart = 0;
-  do 
-  {
-    chCommand = pgm_read_byte_near(pchCommand++);
-    chTest = *pchTest++;
-    ++uParameterStart;
-  } while (chCommand == chTest && chCommand != '\0' && (chTest != ' ' || chTest != '\0'));
+  uint16_t uHash = HASH_SEED;
+  char ch;
+  while ((ch = pgm_read_byte_near(pchName++)) != '\0')
+    uHash = HASH_STEP(uHash, ch);
+  return uHash;
+}
 
-  if (chCommand == '\0' && (chTest == ' ' || chTest == '\0'))
-    return uParameterStart;
+uint16_t CommandDispatcherBase::Hash(const char *pchMessage, uint16_t &ruLength)
+  /* Hashes the command name at the start of a message, which ends at a
+  space or the end of the message, and returns its length in ruLength. */
+{
+  uint16_t uHash = HASH_SEED;
+  const char *pchEnd = pchMessage;
+  while (*pchEnd != ' ' && *pchEnd != '\0')
+  {
+    uHash = HASH_STEP(uHash, *pchEnd);
+    ++pchEnd;
+  }
+  ruLength = pchEnd - pchMessage;
+  return uHash;
+}
 
-  return NO_MATCH; // No match. 
+bool CommandDispatcherBase::MatchName( PGM_P pchName, const char *pchMessage, uint16_t uLength )
+{
+  while (uLength--)
+  {
+    if ((char)pgm_read_byte_near(pchName++) != *pchMessage++)
+      return false;
+  }
+  return pgm_read_byte_near(pchName) == '\0';
 }
 
 Print & PrintVariableName(VariableMap &rVariableInfo, CommandParameter &rParameters)
@@ -3,17 +3,33 @@
 #include <Arduino.h>
 #include "CommandParameter.h"
 
+// Defaults for the template sizes of CommandHandler, CommandDispatcher,
+// CommandProcessor and TCPCommandHandler. Define before including to change
+// them for a whole sketch. Lookup cost grows with log2 of the count, so
+// long command lists are fine. 
+#ifndef MLP_DEFAULT_MAX_COMMANDS
+#define MLP_DEFAULT_MAX_COMMANDS 10
+#endif
+#ifndef MLP_DEFAULT_MAX_VARIABLES
+#define MLP_DEFAULT_MAX_VARIABLES 10
+#endif
+#ifndef MLP_DEFAULT_BUFFER_SIZE
+#define MLP_DEFAULT_BUFFER_SIZE 30
+#endif
+
 namespace MLP
 {
   struct CommandCallback 
   {
     PGM_P m_strCommand;
+    uint16_t m_uHash; // of m_strCommand, see CommandDispatcherBase::Hash()
     void (*m_Callback)(CommandParameter &rParameters);
   };
 
   struct VariableMap
   {
     PGM_P m_strName;
+    uint16_t m_uHash;
     void *m_pVariable;
     uint8_t m_uMaxBufferSize; // for strings. 
     bool(*m_Callback)(VariableMap &rVariableInfo, CommandParameter &rParameters, bool bPrintOnSet);
@@ -21,20 +37,23 @@ namespace MLP
 
   class CommandDispatcherBase
   {
-    // Array of up to m_uMaxCommands we can match & dispatch. 
+    // Array of up to m_uMaxCommands we can match & dispatch. Kept sorted
+    // by name hash so a message is matched with a binary search; commands
+    // with the same hash stay in the order they were added. 
     CommandCallback *const m_pCommands;
-    const uint8_t m_uMaxCommands;
-    uint8_t m_uLastCommand;
+    const uint16_t m_uMaxCommands;
+    uint16_t m_uLastCommand;
 
+    // Sorted the same way. 
     VariableMap *const m_pVariableMap;
-    const uint8_t m_uMaxVariables;
-    uint8_t m_uLastVariable;
+    const uint16_t m_uMaxVariables;
+    uint16_t m_uLastVariable;
 
     // Handler called (if not null) when no command matches. 
     void (*m_fnDefaultHandler)();
 
   protected:
-    CommandDispatcherBase(CommandCallback *pCallbackBuffer, uint8_t uCallbackBufferLength, VariableMap *pVariableMapBuffer, uint8_t uVariableMapLength);
+    CommandDispatcherBase(CommandCallback *pCallbackBuffer, uint16_t uCallbackBufferLength, VariableMap *pVariableMapBuffer, uint16_t uVariableMapLength);
 
   public:
     bool AddCommand(const __FlashStringHelper *pCommand, void(*CallbackFunction)(CommandParameter &rParameters));
@@ -57,8 +76,9 @@ namespace MLP
     void DispatchCommand(char *pchMessage, Print& rSource) const;
 
   protected:
-    enum EConstants { NO_MATCH = 0 };
-    uint8_t MatchCommand(PGM_P pchCommand, const char *pchTest) const;
+    static uint16_t Hash(PGM_P pchName);
+    static uint16_t Hash(const char *pchMessage, uint16_t &ruLength);
+    static bool MatchName(PGM_P pchName, const char *pchMessage, uint16_t uLength);
 
     static bool ProcessVariable_uint8(VariableMap &rVariableInfo, CommandParameter &rParameters, bool bPrintOnSet);
     static bool ProcessVariable_uint16(VariableMap &rVariableInfo, CommandParameter &rParameters, bool bPrintOnSet);
@@ -71,5 +91,6 @@ namespace MLP
     static bool ProcessVariable_string(VariableMap &rVariableInfo, CommandParameter &rParameters, bool bPrintOnSet);
 
     bool AddVariable(const __FlashStringHelper *pName, void *pVariable, bool(*ProcessFunction)(VariableMap &rVariableInfo, CommandParameter &rParameters, bool bPrintOnSet));
+    VariableMap *InsertVariable(const __FlashStringHelper *pName);
   };
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "CommandParameter.h"
 
-CommandParameter::CommandParameter(Print &rSourceStream, char *pchBuffer, uint8_t uFirstParameter)
+CommandParameter::CommandParameter(Print &rSourceStream, char *pchBuffer, uint16_t uFirstParameter)
   : m_rSourceStream(rSourceStream)
 {
   m_pchBuffer = pchBuffer;
@@ -8,13 +8,13 @@ class CommandParameter
   char *m_pchBuffer;
 
   // Offset to next parameter in buffer. 
-  uint8_t m_uNextParameter; 
+  uint16_t m_uNextParameter; 
 
   // The stream that the parameter came from (for replies, for example)
   Print &m_rSourceStream;
 
 public:
-  CommandParameter(Print &rSourceStream, char *pchBuffer, uint8_t nFirstParameter);
+  CommandParameter(Print &rSourceStream, char *pchBuffer, uint16_t nFirstParameter);
 
   Print &GetSource() { return m_rSourceStream; }
 
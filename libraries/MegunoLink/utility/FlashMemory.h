@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+
+namespace MLP
+{
+  class FlashMemory
+    /* A run of flash rows that FlashStore keeps its log in. A row is the
+    unit of erase, and erased flash reads as all ones. Offsets are from the
+    start of the area. */
+  {
+  public:
+    virtual ~FlashMemory() {}
+
+    virtual uint16_t RowCount() const = 0;
+    virtual uint16_t RowSize() const = 0;
+
+    virtual void Read(uint32_t uOffset, void *pDestination, uint16_t uLength) = 0;
+
+    // Programs uLength bytes, a multiple of 4 at a 4 byte aligned offset,
+    // into erased flash. The rest of the page must be left as it is.
+    // Returns false if the bytes do not read back.
+    virtual bool Write(uint32_t uOffset, const void *pSource, uint16_t uLength) = 0;
+
+    // Sets every byte of the row to 0xff.
+    virtual bool EraseRow(uint16_t uRow) = 0;
+  };
+}
@@ -1,4 +1,5 @@
 #include "StreamParser.h"
+#include <string.h>
 
 using namespace MLP;
 
@@ -28,34 +29,56 @@ StreamParser::StreamParser(char *pchReceiveBuffer, unsigned uBufferSize)
 
 void StreamParser::Process()
 {
-  while (m_pSource != NULL && m_pSource->available() > 0)
+  // Bytes are read in bulk straight into the message buffer, behind the
+  // part of the message already received, and scanned there. Outside a
+  // message they land at the start of the buffer and are only searched for
+  // a start character. While in a message, the scan position is always
+  // m_uNextCharacter, so the message is never copied; a start character
+  // part way through a read moves the rest of that read to the front. 
+  int nAvailable;
+  while (m_pSource != NULL && (nAvailable = m_pSource->available()) > 0)
   {
-    char chNext = m_pSource->read();
+    unsigned uNext = m_uNextCharacter;
+    unsigned uSpace = m_uMaxBufferSize - uNext;
+    if ((unsigned)nAvailable < uSpace)
+      uSpace = nAvailable;
+    unsigned uEnd = uNext + m_pSource->readBytes(m_pchBuffer + uNext, uSpace);
+    if (uEnd == uNext)
+      return;
 
-    if (chNext == m_chStartOfMessage)
+    for (unsigned i = uNext; i < uEnd; ++i)
     {
-      Reset();
-      m_pchBuffer[0] = chNext; // the start character serves as a flag that this message is valid. 
-      ++m_uNextCharacter;
-    }
-    else if (chNext == m_chEndOfMessage)
-    {
-      if (m_uNextCharacter > 0 && m_pchBuffer[0] == m_chStartOfMessage && !m_bOverflow)
+      char chNext = m_pchBuffer[i];
+      if (chNext == m_chStartOfMessage)
+      {
+        // The start character stays at m_pchBuffer[0], flagging a valid message. 
+        memmove(m_pchBuffer, m_pchBuffer + i, uEnd - i);
+        uEnd -= i;
+        i = 0;
+        m_uNextCharacter = 1;
+        m_bOverflow = false;
+      }
+      else if (m_uNextCharacter == 0)
+      {
+        // Not in a message, or the message overflowed: drop it. 
+      }
+      else if (chNext == m_chEndOfMessage)
       {
-        // We have a valid message. Dispatch it. 
-        m_pchBuffer[m_uNextCharacter] = '\0';
+        // We have a valid message. Terminate it in place and dispatch it. 
+        m_pchBuffer[i] = '\0';
         DispatchMessage();
-        Reset();
+        m_uNextCharacter = 0;
       }
-    }
-    else
-    {
-      // Store the character and advance the buffer. If there isn't enough
-      // room for the message to be terminated by a null, flag overflow. 
-      if (!m_bOverflow)
+      else if (i + 1 < m_uMaxBufferSize)
+      {
+        ++m_uNextCharacter;
+      }
+      else
       {
-        m_pchBuffer[m_uNextCharacter++] = chNext;
-        m_bOverflow = m_uNextCharacter >= (m_uMaxBufferSize - 1);
+        // No room left to terminate the message with a null. Commands
+        // are not dispatched from buffers that overflow. 
+        m_uNextCharacter = 0;
+        m_bOverflow = true;
       }
     }
   }
@@ -26,11 +26,13 @@ namespace MLP
     char * const m_pchBuffer;
     const unsigned m_uMaxBufferSize;
 
-    // Index where next character will be placed in the buffer. 
+    // Index where next character will be placed in the buffer. Zero when
+    // we are not inside a message. 
     unsigned m_uNextCharacter;
 
-    // True iff an overflow has occured. Commands will not
-    // be dispatched from buffers that overflow. 
+    // True iff the last message overflowed the buffer. Commands will not
+    // be dispatched from buffers that overflow; characters are dropped
+    // until the next start character. 
     bool m_bOverflow;
 
   protected:
@@ -41,6 +43,8 @@ namespace MLP
     void DispatchMessage();
 
   public:
+    // Reads everything the source has available and dispatches each
+    // complete message. 
     void Process();
     void Reset(); 
   };
@@ -18,7 +18,7 @@
 
 namespace MLP
 {
-  template<int CP_SERIAL_BUFFER_SIZE = 30>
+  template<int CP_SERIAL_BUFFER_SIZE = MLP_DEFAULT_BUFFER_SIZE>
   class TCPConnection
     : public MLP::StreamParser
   {